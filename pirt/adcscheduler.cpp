@@ -0,0 +1,165 @@
+#include <algorithm>
+
+#include "adcscheduler.h"
+#include "ads1115.h"
+#include "timebase.h"
+
+namespace PiRaTe {
+
+AdcScheduler::AdcScheduler(std::chrono::microseconds slot_period)
+    : fCycleTimer { slot_period }
+{
+    fActiveLoop = true;
+    fThread = std::make_unique<std::thread>([this]() { this->threadLoop(); });
+}
+
+AdcScheduler::~AdcScheduler()
+{
+    fActiveLoop = false;
+    if (fThread != nullptr)
+        fThread->join();
+}
+
+auto AdcScheduler::addGroup(unsigned int weight) -> std::size_t
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fGroups.push_back(Group { weight, {}, 0 });
+    buildPlan();
+    return fGroups.size() - 1;
+}
+
+auto AdcScheduler::addChannel(std::size_t group, std::shared_ptr<ADS1115> adc, std::uint8_t channel, callback_t callback) -> bool
+{
+    if (adc == nullptr)
+        return false;
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (group >= fGroups.size())
+        return false;
+    fGroups[group].channels.push_back(std::make_unique<Channel>(Channel { std::move(adc), channel, true, std::move(callback) }));
+    buildPlan();
+    return true;
+}
+
+void AdcScheduler::setWeight(std::size_t group, unsigned int weight)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (group >= fGroups.size())
+        return;
+    fGroups[group].weight = weight;
+    buildPlan();
+}
+
+void AdcScheduler::setEnabled(const std::shared_ptr<ADS1115>& adc, std::uint8_t channel, bool enabled)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    for (auto& group : fGroups) {
+        for (auto& ch : group.channels) {
+            if (ch->adc == adc && ch->channel == channel)
+                ch->enabled = enabled;
+        }
+    }
+    buildPlan();
+}
+
+void AdcScheduler::setSlotPeriod(std::chrono::microseconds period)
+{
+    fCycleTimer.setPeriod(period);
+}
+
+auto AdcScheduler::slotPeriod() const -> std::chrono::microseconds
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(fCycleTimer.period());
+}
+
+auto AdcScheduler::sampleRate(const std::shared_ptr<ADS1115>& adc, std::uint8_t channel) -> double
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (fPlan.empty())
+        return 0.;
+    const double cycle_time { 1e-9 * fCycleTimer.period().count() * fPlan.size() };
+    for (const auto& group : fGroups) {
+        if (!hasEnabledChannel(group))
+            continue;
+        const auto nr_enabled { std::count_if(group.channels.cbegin(), group.channels.cend(), [](const auto& ch) { return ch->enabled; }) };
+        for (const auto& ch : group.channels) {
+            if (ch->adc == adc && ch->channel == channel && ch->enabled)
+                return group.weight / (nr_enabled * cycle_time);
+        }
+    }
+    return 0.;
+}
+
+auto AdcScheduler::jitterStatistics() -> CycleTimer::Statistics
+{
+    return fCycleTimer.statistics();
+}
+
+auto AdcScheduler::hasEnabledChannel(const Group& group) const -> bool
+{
+    return std::any_of(group.channels.cbegin(), group.channels.cend(), [](const auto& ch) { return ch->enabled; });
+}
+
+// must be called with the mutex locked
+void AdcScheduler::buildPlan()
+{
+    // smooth weighted round-robin: in each step, every group gains its weight in credit,
+    // the group with the highest credit gets the slot and pays the total weight
+    fPlan.clear();
+    fSlot = 0;
+    std::vector<long> credit(fGroups.size(), 0);
+    long total { 0 };
+    for (const auto& group : fGroups) {
+        if (hasEnabledChannel(group))
+            total += group.weight;
+    }
+    for (long slot { 0 }; slot < total; ++slot) {
+        std::size_t best { 0 };
+        bool found { false };
+        for (std::size_t i { 0 }; i < fGroups.size(); ++i) {
+            if (!hasEnabledChannel(fGroups[i]))
+                continue;
+            credit[i] += fGroups[i].weight;
+            if (!found || credit[i] > credit[best]) {
+                best = i;
+                found = true;
+            }
+        }
+        credit[best] -= total;
+        fPlan.push_back(best);
+    }
+}
+
+// this is the background thread loop
+void AdcScheduler::threadLoop()
+{
+    fCycleTimer.start();
+    while (fActiveLoop) {
+        fCycleTimer.wait();
+        // the adc, channel and callback of a channel do not change after it was added, only the enabled flag
+        const Channel* channel { nullptr };
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            if (fPlan.empty())
+                continue;
+            if (fSlot >= fPlan.size())
+                fSlot = 0;
+            auto& group { fGroups[fPlan[fSlot++]] };
+            // serve the next enabled channel of the group
+            for (std::size_t i { 0 }; i < group.channels.size(); ++i) {
+                const std::size_t index { (group.next + i) % group.channels.size() };
+                if (group.channels[index]->enabled) {
+                    channel = group.channels[index].get();
+                    group.next = index + 1;
+                    break;
+                }
+            }
+        }
+        if (channel == nullptr)
+            continue;
+        const double voltage { channel->adc->readVoltage(channel->channel) };
+        if (channel->callback)
+            channel->callback(TimeBase::now(), voltage);
+    }
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cycletimer.h"
+
+namespace PiRaTe {
+
+class ADS1115;
+
+constexpr std::chrono::microseconds DEFAULT_ADC_SLOT_PERIOD { 3000 }; //< default duration of one conversion slot, sufficient for one conversion at 860 SPS incl. I2C transfers
+
+/**
+ * @brief Conversion scheduler for the ADS1115 ADCs on one I2C bus
+ * The scheduler is the only instance which triggers conversions on the ADCs of the bus. Instead of several threads
+ * competing for the bus, one thread loop runs a fixed conversion plan, one conversion per time slot of constant length.
+ * The ADC channels are organized in groups, each with a weight which is the number of slots per plan cycle assigned
+ * to the group. The slots of a group are interleaved evenly into the plan (smooth weighted round-robin), within a group
+ * the channels are served in turn. Thus every channel is sampled at a fixed rate with a jitter given only by the
+ * wake-up jitter of the thread.
+ * The results are published to the subscriber callback of each channel, which is called from the scheduler thread.
+ */
+class AdcScheduler {
+public:
+    /// subscriber callback: time stamp of the end of the conversion and the converted voltage in V
+    typedef std::function<void(std::chrono::time_point<std::chrono::system_clock>, double)> callback_t;
+
+    AdcScheduler() = delete;
+    /**
+    * @brief The main constructor.
+    * Launches the scheduler thread loop. The conversion plan is initially empty.
+    * @param slot_period duration of one conversion slot
+    */
+    explicit AdcScheduler(std::chrono::microseconds slot_period = DEFAULT_ADC_SLOT_PERIOD);
+    ~AdcScheduler();
+
+    /**
+    * @brief add a group of channels to the plan
+    * @param weight nr. of slots per plan cycle assigned to the group
+    * @return the index of the new group
+    */
+    auto addGroup(unsigned int weight) -> std::size_t;
+    /**
+    * @brief add a channel to a group
+    * @param group index of the group as returned by {@link AdcScheduler::addGroup}
+    * @param adc the ADC, which must not be accessed by other threads while the scheduler runs
+    * @param channel the ADC channel
+    * @param callback the subscriber of the conversion results
+    */
+    auto addChannel(std::size_t group, std::shared_ptr<ADS1115> adc, std::uint8_t channel, callback_t callback) -> bool;
+    void setWeight(std::size_t group, unsigned int weight);
+    /**
+    * @brief exclude a channel from the plan or include it again, e.g. while the channel is converted continuously
+    */
+    void setEnabled(const std::shared_ptr<ADS1115>& adc, std::uint8_t channel, bool enabled);
+    void setSlotPeriod(std::chrono::microseconds period);
+    [[nodiscard]] auto slotPeriod() const -> std::chrono::microseconds;
+    /**
+    * @brief nominal sample rate of a channel according to the current plan
+    * @return the sample rate in Hz, 0 if the channel is not in the plan
+    */
+    [[nodiscard]] auto sampleRate(const std::shared_ptr<ADS1115>& adc, std::uint8_t channel) -> double;
+    /**
+    * @brief wake-up jitter of the conversion slots
+    * @return the statistics accumulated since the last call
+    */
+    [[nodiscard]] auto jitterStatistics() -> CycleTimer::Statistics;
+
+private:
+    struct Channel {
+        std::shared_ptr<ADS1115> adc { nullptr };
+        std::uint8_t channel { 0 };
+        bool enabled { true };
+        callback_t callback {};
+    };
+    struct Group {
+        unsigned int weight { 0 };
+        std::vector<std::unique_ptr<Channel>> channels {}; ///<! channels are never removed, so the scheduler thread may use them outside the lock
+        std::size_t next { 0 }; ///<! index of the channel to be served in the next slot of this group
+    };
+
+    void threadLoop();
+    void buildPlan();
+    [[nodiscard]] auto hasEnabledChannel(const Group& group) const -> bool;
+
+    std::vector<Group> fGroups {};
+    std::vector<std::size_t> fPlan {}; ///<! group indices of the slots of one plan cycle
+    std::size_t fSlot { 0 };
+    CycleTimer fCycleTimer;
+    std::atomic<bool> fActiveLoop { false };
+    std::unique_ptr<std::thread> fThread { nullptr };
+    std::mutex fMutex;
+};
+
+} // namespace PiRaTe
@@ -22,9 +22,10 @@ int16_t ADS1115::readADC(unsigned int channel)
     int16_t val; // Stores the 16 bit value of our ADC conversion
         //  uint8_t fDataRate = 0x07; // 860 SPS
         //  uint8_t fDataRate = 0x01; // 16 SPS
-    uint8_t fDataRate = fRate & 0x07;
 
     std::lock_guard<std::mutex> lock(fMutex);
+    // the continuous mode switches the rate under the same lock
+    uint8_t fDataRate = fRate & 0x07;
     startTimer();
 
     // These three bytes are written to the ADS1115 to set the config register and start a conversion
@@ -37,8 +38,10 @@ int16_t ADS1115::readADC(unsigned int channel)
     writeBuf[1] |= ((uint8_t)fPga[channel]) << 1; // PGA gain select
 
     // This sets the 8 LSBs of the config register (bits 7-0)
-    //	writeBuf[2] = 0x03;  // disable ALERT/RDY pin
-    writeBuf[2] = 0x00; // enable ALERT/RDY pin
+    if (fContinuous)
+        writeBuf[2] = 0x03; // disable ALERT/RDY pin, so that the single shot is not taken for a continuous conversion result
+    else
+        writeBuf[2] = 0x00; // enable ALERT/RDY pin
     writeBuf[2] |= ((uint8_t)fDataRate) << 5;
 
     // Initialize the buffer used to read data from the ADS1115 to 0
@@ -60,6 +63,10 @@ int16_t ADS1115::readADC(unsigned int channel)
     if (nloops * fReadWaitDelay / 1000 >= 1000) {
         if (fDebugLevel > 1)
             printf("timeout!\n");
+        if (fContinuous) {
+            writeConfig(fContinuousChannel, true);
+            fResumeTime = std::chrono::steady_clock::now();
+        }
         return INT16_MIN;
     }
     if (fDebugLevel > 2)
@@ -81,6 +88,12 @@ int16_t ADS1115::readADC(unsigned int channel)
     val = readBuf[0] << 8 | readBuf[1]; // Combine the two bytes of readBuf into a single 16 bit result
     fLastADCValue = val;
 
+    // resume the continuous conversions which were interrupted by this single shot
+    if (fContinuous) {
+        writeConfig(fContinuousChannel, true);
+        fResumeTime = std::chrono::steady_clock::now();
+    }
+
     stopTimer();
     fLastConvTime = fLastTimeInterval;
 
@@ -96,7 +109,7 @@ bool ADS1115::setLowThreshold(int16_t thr)
     // These three bytes are written to the ADS1115 to set the Lo_thresh register
     writeBuf[0] = 0x02; // This sets the pointer register to Lo_thresh register
     writeBuf[1] = (thr & 0xff00) >> 8;
-    writeBuf[2] |= (thr & 0x00ff);
+    writeBuf[2] = (thr & 0x00ff);
 
     // Initialize the buffer used to read data from the ADS1115 to 0
     readBuf[0] = 0;
@@ -126,7 +139,7 @@ bool ADS1115::setHighThreshold(int16_t thr)
     // These three bytes are written to the ADS1115 to set the Hi_thresh register
     writeBuf[0] = 0x03; // This sets the pointer register to Hi_thresh register
     writeBuf[1] = (thr & 0xff00) >> 8;
-    writeBuf[2] |= (thr & 0x00ff);
+    writeBuf[2] = (thr & 0x00ff);
 
     // Initialize the buffer used to read data from the ADS1115 to 0
     readBuf[0] = 0;
@@ -154,11 +167,71 @@ bool ADS1115::setDataReadyPinMode()
     // set MSB of Lo_thresh reg to 0
     // set MSB of Hi_thresh reg to 1
     // set COMP_QUE[1:0] to any value other than '11' (default value)
-    bool ok = setLowThreshold(0b00000000);
-    ok = ok && setHighThreshold(0b11111111);
+    bool ok = setLowThreshold(0x0000);
+    ok = ok && setHighThreshold(INT16_MIN); // 0x8000
     return ok;
 }
 
+bool ADS1115::writeConfig(unsigned int channel, bool continuous)
+{
+    uint8_t writeBuf[3];
+    writeBuf[0] = 0x01; // pointer to config register
+    writeBuf[1] = 0x00; // no single shot
+    if (!fDiffMode)
+        writeBuf[1] |= 0x40; // single ended mode channels
+    writeBuf[1] |= (channel & 0x03) << 4; // channel select
+    if (!continuous)
+        writeBuf[1] |= 0x01; // single shot mode, i.e. power-down
+    writeBuf[1] |= ((uint8_t)fPga[channel & 0x03]) << 1; // PGA gain select
+    // ALERT/RDY pin asserted after each conversion in continuous mode, disabled otherwise
+    writeBuf[2] = (continuous) ? 0x00 : 0x03;
+    writeBuf[2] |= ((uint8_t)(fRate & 0x07)) << 5;
+    return (write(writeBuf, 3) == 3);
+}
+
+bool ADS1115::startContinuousMode(unsigned int channel, CFG_RATE rate)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (!fContinuous)
+        fSingleShotRate = fRate;
+    fRate = rate & 0x07;
+    if (!setDataReadyPinMode() || !writeConfig(channel, true)) {
+        fRate = fSingleShotRate;
+        fContinuous = false;
+        return false;
+    }
+    fContinuousChannel = channel & 0x03;
+    fResumeTime = std::chrono::steady_clock::now();
+    fContinuous = true;
+    return true;
+}
+
+void ADS1115::stopContinuousMode()
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (!fContinuous)
+        return;
+    fContinuous = false;
+    writeConfig(fContinuousChannel, false);
+    fRate = fSingleShotRate;
+}
+
+bool ADS1115::readConversion(std::chrono::steady_clock::time_point ready_time, int16_t& adc, double& voltage)
+{
+    uint8_t readBuf[2] { 0, 0 };
+    std::lock_guard<std::mutex> lock(fMutex);
+    // an edge from before the last resume may belong to an interrupted conversion
+    if (!fContinuous || ready_time < fResumeTime)
+        return false;
+    if (readReg(0x00, readBuf, 2) != 2)
+        return false;
+    adc = readBuf[0] << 8 | readBuf[1];
+    voltage = PGAGAINS[fPga[fContinuousChannel]] * adc / 32767.0;
+    fLastADCValue = adc;
+    fLastVoltage = voltage;
+    return true;
+}
+
 bool ADS1115::devicePresent()
 {
     uint8_t buf[2];
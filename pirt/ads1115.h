@@ -1,6 +1,7 @@
 #pragma once
 
 #include "i2cdevice.h"
+#include <chrono>
 #include <mutex>
 
 namespace PiRaTe {
@@ -74,7 +75,11 @@ public:
     CFG_PGA getPga(int ch) const { return fPga[ch]; }
     void setAGC(bool state) { fAGC = state; }
     bool getAGC() const { return fAGC; }
-    void setRate(uint8_t rate) { fRate = rate & 0x07; }
+    void setRate(uint8_t rate)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fRate = rate & 0x07;
+    }
     unsigned int getRate() const { return fRate; }
     bool setLowThreshold(int16_t thr);
     bool setHighThreshold(int16_t thr);
@@ -88,6 +93,28 @@ public:
     unsigned int getReadWaitDelay() const { return fReadWaitDelay; }
     double getLastConvTime() const { return fLastConvTime; }
 
+    /** @brief Start continuous conversions of one channel with the ALERT/RDY pin in data-ready mode.
+     * The pin pulses after each completed conversion, the result is then fetched with {@link ADS1115::readConversion}.
+     * Single-shot read-outs of other channels (e.g. with {@link ADS1115::readADC}) remain possible, they suspend
+     * the continuous conversions for their duration.
+     * @param channel the channel to convert continuously
+     * @param rate the conversion rate, which applies to all conversions of the device while the mode is active
+     * @return true on success
+     */
+    bool startContinuousMode(unsigned int channel, CFG_RATE rate = RATE860);
+    /** @brief Stop continuous conversions and restore the previous conversion rate.
+     */
+    void stopContinuousMode();
+    bool isContinuousMode() const { return fContinuous; }
+    /** @brief Fetch the latest result of the continuous conversions with a single register read.
+     * @param ready_time monotonic time of the data-ready edge, results of edges which occurred before the
+     * last suspension of the continuous conversions are discarded
+     * @param adc the raw conversion result
+     * @param voltage the conversion result in V
+     * @return true if a valid result was read
+     */
+    bool readConversion(std::chrono::steady_clock::time_point ready_time, int16_t& adc, double& voltage);
+
 protected:
     CFG_PGA fPga[4];
     unsigned int fRate;
@@ -98,8 +125,13 @@ protected:
     bool fAGC { false }; ///< software agc which switches over to a better pga setting if voltage too low/high
     bool fDiffMode { false }; ///< measure differential input signals (true) or single ended (false=default)
     std::mutex fMutex {};
+    bool fContinuous { false }; ///< continuous conversion mode active
+    unsigned int fContinuousChannel { 0 }; ///< channel of the continuous conversions
+    unsigned int fSingleShotRate { 0 }; ///< conversion rate to restore after continuous mode
+    std::chrono::steady_clock::time_point fResumeTime {}; ///< time of the last (re-)start of the continuous conversions
 
     virtual void init();
+    bool writeConfig(unsigned int channel, bool continuous);
 //     {
 //         fPga[0] = fPga[1] = fPga[2] = fPga[3] = PGA4V;
 //         fReadWaitDelay = READ_WAIT_DELAY_INIT;
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <iostream>
 #include <memory>
 #include <stdio.h>
@@ -8,6 +10,7 @@
 
 #include "ads1115.h"
 #include "ads1115_measurement.h"
+#include "timebase.h"
 #include "utility.h"
 
 #define DEFAULT_VERBOSITY 1
@@ -15,6 +18,10 @@
 namespace PiRaTe {
 
 constexpr std::chrono::microseconds loop_delay { 10'000L };
+constexpr double CONTINUOUS_SAMPLE_RATE { 860. }; //< sample rate in continuous mode in Hz
+constexpr double SAMPLE_CAPACITY_MARGIN { 1.25 }; //< headroom of the sample buffers for fluctuations of the sample rate
+constexpr std::size_t MIN_SAMPLE_CAPACITY { 16 };
+constexpr std::size_t FILTER_OUTPUT_CAPACITY { 4096 }; //< nr. of filter output samples kept
 
 Ads1115Measurement::Ads1115Measurement(std::string name,
     std::shared_ptr<ADS1115> adc,
@@ -26,7 +33,9 @@ Ads1115Measurement::Ads1115Measurement(std::string name,
     , fAdcChannel { adc_channel }
     , fFactor { factor }
     , fIntTime { integration_time }
+    , fFilteredBuffer { FILTER_OUTPUT_CAPACITY }
 {
+    resizeBuffers();
     // initialize ADC if one was supplied in the argument list
     if (fAdc != nullptr && fAdc->devicePresent()) {
         //fAdc->setPga(ADS1115::PGA4V);
@@ -57,20 +66,18 @@ void Ads1115Measurement::threadLoop()
 {
     auto lastReadOutTime = std::chrono::system_clock::now();
     while (fActiveLoop) {
+        if (fContinuous || fExternalReadout) {
+            // the samples are fetched on the data-ready edges or supplied externally
+            std::this_thread::sleep_for(loop_delay);
+            continue;
+        }
         if (hasAdc()) {
             double conv_time { 0. };
             if ([[maybe_unused]] bool readout_guard = true) {
                 // read current voltage from adc
-                fMutex.lock();
-                fValue = fAdc->readVoltage(fAdcChannel) * fFactor;
-                auto currentTime = std::chrono::system_clock::now();
+                const double value { fAdc->readVoltage(fAdcChannel) * fFactor };
                 conv_time = fAdc->getLastConvTime();
-                while (!fIntegrationBuffer.empty() && fIntegrationBuffer.front().time < (currentTime - fIntTime)) {
-                    fIntegrationBuffer.pop_front();
-                }
-                fIntegrationBuffer.push_back({ std::move(currentTime), fValue });
-                fUpdated = true;
-                fMutex.unlock();
+                addSample(TimeBase::now(), value);
             }
             if (fVoltageReadyFn)
                 fVoltageReadyFn(fValue);
@@ -82,6 +89,194 @@ void Ads1115Measurement::threadLoop()
     }
 }
 
+void Ads1115Measurement::addSample(std::chrono::time_point<std::chrono::system_clock> time, double value)
+{
+    bool excluded { false };
+    {
+        std::lock_guard<std::mutex> fn_lock(fSampleFnMutex);
+        if (fExclusionFn)
+            excluded = fExclusionFn(time);
+    }
+    std::unique_lock<std::mutex> lock(fMutex);
+    fValue = value;
+    evictSamples(time - fIntTime);
+    // the buffers are sized for the nominal sample rate, if it is exceeded the window gets shorter
+    if (fIntegrationBuffer.full())
+        popOldestSample();
+    // excluded samples are kept out of the window of the outlier detection
+    const bool flagged { !excluded && fOutlierDetector.process(value) };
+    if (flagged)
+        fNrFlagged++;
+    const Sample sample { time, value, flagged, excluded };
+    pushSample(sample);
+    if (fSampleQueue.capacity() > 0) {
+        if (fSampleQueue.full()) {
+            fSampleQueue.pop_front();
+            fNrQueueLost++;
+        }
+        fSampleQueue.push_back(sample);
+    }
+    if (fFilter != nullptr) {
+        FilterChain::Sample output {};
+        if (fFilter->process({ time, (flagged || excluded) ? fOutlierDetector.median() : value }, output)) {
+            if (fFilteredBuffer.full())
+                fFilteredBuffer.pop_front();
+            fFilteredBuffer.push_back({ output.time, output.value });
+            fFilteredValue = output.value;
+        }
+    }
+    fUpdated = true;
+    lock.unlock();
+    std::lock_guard<std::mutex> fn_lock(fSampleFnMutex);
+    if (fSampleFn)
+        fSampleFn(sample);
+}
+
+// must be called with the mutex locked
+void Ads1115Measurement::pushSample(const Sample& sample)
+{
+    fIntegrationBuffer.push_back(sample);
+    if (sample.excluded)
+        fNrExcluded++;
+    if (sample.flagged || sample.excluded)
+        return;
+    if (fNrValid == 0) {
+        fShift = sample.value;
+        fSum.reset();
+        fSumSq.reset();
+    }
+    fNrValid++;
+    const double delta { sample.value - fShift };
+    fSum.add(delta);
+    fSumSq.add(delta * delta);
+    while (!fMinQueue.empty() && fMinQueue.back().value > sample.value)
+        fMinQueue.pop_back();
+    fMinQueue.push_back(sample);
+    while (!fMaxQueue.empty() && fMaxQueue.back().value < sample.value)
+        fMaxQueue.pop_back();
+    fMaxQueue.push_back(sample);
+}
+
+// must be called with the mutex locked
+void Ads1115Measurement::popOldestSample()
+{
+    const Sample& sample { fIntegrationBuffer.front() };
+    if (sample.excluded)
+        fNrExcluded--;
+    if (!sample.flagged && !sample.excluded) {
+        const double delta { sample.value - fShift };
+        fSum.subtract(delta);
+        fSumSq.subtract(delta * delta);
+        fNrValid--;
+        if (!fMinQueue.empty() && fMinQueue.front().time == sample.time && fMinQueue.front().value == sample.value)
+            fMinQueue.pop_front();
+        if (!fMaxQueue.empty() && fMaxQueue.front().time == sample.time && fMaxQueue.front().value == sample.value)
+            fMaxQueue.pop_front();
+    }
+    fIntegrationBuffer.pop_front();
+}
+
+// must be called with the mutex locked
+void Ads1115Measurement::evictSamples(std::chrono::time_point<std::chrono::system_clock> time)
+{
+    while (!fIntegrationBuffer.empty() && fIntegrationBuffer.front().time < time)
+        popOldestSample();
+    if (fIntegrationBuffer.empty()) {
+        // start from scratch, so that no residual rounding errors are carried over
+        fNrValid = 0;
+        fNrExcluded = 0;
+        fSum.reset();
+        fSumSq.reset();
+        fMinQueue.clear();
+        fMaxQueue.clear();
+    }
+}
+
+auto Ads1115Measurement::nominalSampleRate() const -> double
+{
+    return (fContinuous) ? CONTINUOUS_SAMPLE_RATE : fSampleRate;
+}
+
+// must be called with the mutex locked
+void Ads1115Measurement::configureFilter()
+{
+    fFilteredBuffer.clear();
+    if (!fFilterEnabled) {
+        fFilter.reset();
+        return;
+    }
+    fFilter = std::make_unique<FilterChain>(nominalSampleRate(), fFilterSettings);
+}
+
+// must be called with the mutex locked
+void Ads1115Measurement::resizeBuffers()
+{
+    const double rate { nominalSampleRate() };
+    const std::size_t capacity { std::max(MIN_SAMPLE_CAPACITY,
+        static_cast<std::size_t>(std::ceil(std::chrono::duration<double>(fIntTime).count() * rate * SAMPLE_CAPACITY_MARGIN))) };
+    if (capacity == fIntegrationBuffer.capacity())
+        return;
+    // keep the newest samples and rebuild the running statistics from them
+    const CircularQueue<Sample> samples { std::move(fIntegrationBuffer) };
+    fIntegrationBuffer = CircularQueue<Sample>(capacity);
+    fMinQueue = CircularQueue<Sample>(capacity);
+    fMaxQueue = CircularQueue<Sample>(capacity);
+    fNrValid = 0;
+    fNrExcluded = 0;
+    const std::size_t first { (samples.size() > capacity) ? samples.size() - capacity : 0 };
+    for (std::size_t i { first }; i < samples.size(); ++i)
+        pushSample(samples[i]);
+}
+
+void Ads1115Measurement::processReadout(std::chrono::time_point<std::chrono::system_clock> time, double voltage)
+{
+    if (fContinuous)
+        return;
+    addSample(time, voltage * fFactor);
+    if (fVoltageReadyFn)
+        fVoltageReadyFn(voltage * fFactor);
+}
+
+auto Ads1115Measurement::startContinuousMode() -> bool
+{
+    if (!hasAdc() || !fActiveLoop)
+        return false;
+    if (!fAdc->startContinuousMode(fAdcChannel))
+        return false;
+    std::lock_guard<std::mutex> lock(fMutex);
+    fContinuous = true;
+    resizeBuffers();
+    configureFilter();
+    return true;
+}
+
+void Ads1115Measurement::stopContinuousMode()
+{
+    if (!fContinuous)
+        return;
+    fContinuous = false;
+    fAdc->stopContinuousMode();
+    std::lock_guard<std::mutex> lock(fMutex);
+    resizeBuffers();
+    configureFilter();
+}
+
+void Ads1115Measurement::dataReady(std::chrono::nanoseconds timestamp)
+{
+    if (!fContinuous)
+        return;
+    const std::chrono::steady_clock::time_point ready_time { std::chrono::duration_cast<std::chrono::steady_clock::duration>(timestamp) };
+    std::int16_t adc { 0 };
+    double voltage { 0. };
+    if (!fAdc->readConversion(ready_time, adc, voltage))
+        return;
+    // the sample is time stamped with the data-ready edge, i.e. the end of the conversion
+    const auto sample_time { TimeBase::now() - std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::steady_clock::now() - ready_time) };
+    addSample(sample_time, voltage * fFactor);
+    if (fVoltageReadyFn)
+        fVoltageReadyFn(voltage * fFactor);
+}
+
 auto Ads1115Measurement::currentValue() -> double
 {
     std::lock_guard<std::mutex> lock(fMutex);
@@ -93,20 +288,128 @@ auto Ads1115Measurement::meanValue() -> double
 {
     std::lock_guard<std::mutex> lock(fMutex);
     fUpdated = false;
-    if (fIntegrationBuffer.empty())
+    if (fNrValid == 0)
         return 0.;
-    if (fIntegrationBuffer.size() == 1)
-        return fValue;
-    double mean = std::accumulate(fIntegrationBuffer.begin(), fIntegrationBuffer.end(), 0.0, [](double sum, Sample s) {
-        return sum + s.value;
-    }) / fIntegrationBuffer.size();
-    return mean;
+    return fShift + fSum.value() / fNrValid;
+}
+
+auto Ads1115Measurement::statistics() -> Statistics
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fUpdated = false;
+    Statistics stats {};
+    stats.count = fNrValid;
+    stats.excluded = fNrExcluded;
+    stats.flagged = fIntegrationBuffer.size() - fNrValid - fNrExcluded;
+    if (stats.count == 0)
+        return stats;
+    const double n { static_cast<double>(stats.count) };
+    const double mean_delta { fSum.value() / n };
+    stats.mean = fShift + mean_delta;
+    if (stats.count > 1) {
+        const double variance { (fSumSq.value() - n * mean_delta * mean_delta) / (n - 1.) };
+        stats.stddev = std::sqrt(std::max(variance, 0.));
+    }
+    stats.min = fMinQueue.front().value;
+    stats.max = fMaxQueue.front().value;
+    return stats;
+}
+
+auto Ads1115Measurement::samplesSince(std::chrono::time_point<std::chrono::system_clock> time) -> std::vector<Sample>
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    std::vector<Sample> samples {};
+    for (std::size_t i { 0 }; i < fIntegrationBuffer.size(); ++i) {
+        if (fIntegrationBuffer[i].time > time)
+            samples.push_back(fIntegrationBuffer[i]);
+    }
+    return samples;
+}
+
+void Ads1115Measurement::setSampleQueue(std::size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fSampleQueue = CircularQueue<Sample>(capacity);
+    fNrQueueLost = 0;
+}
+
+auto Ads1115Measurement::takeQueuedSamples(std::vector<Sample>& samples) -> std::size_t
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    samples.reserve(samples.size() + fSampleQueue.size());
+    while (!fSampleQueue.empty()) {
+        samples.push_back(fSampleQueue.front());
+        fSampleQueue.pop_front();
+    }
+    const std::size_t lost { fNrQueueLost };
+    fNrQueueLost = 0;
+    return lost;
 }
 
 void Ads1115Measurement::setIntTime(std::chrono::milliseconds ms)
 {
     std::lock_guard<std::mutex> lock(fMutex);
+    if (ms == fIntTime)
+        return;
     fIntTime = ms;
+    resizeBuffers();
+}
+
+void Ads1115Measurement::setSampleRate(double rate_hz)
+{
+    if (rate_hz <= 0.)
+        return;
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (rate_hz == fSampleRate)
+        return;
+    fSampleRate = rate_hz;
+    resizeBuffers();
+    configureFilter();
+}
+
+void Ads1115Measurement::setFilter(const FilterChain::Settings& settings)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fFilterSettings = settings;
+    fFilterEnabled = true;
+    configureFilter();
+}
+
+void Ads1115Measurement::setOutlierRejection(std::size_t window, double threshold)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fOutlierDetector = OutlierDetector(window, threshold);
+    fNrFlagged = 0;
+}
+
+void Ads1115Measurement::disableFilter()
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fFilterEnabled = false;
+    configureFilter();
+}
+
+auto Ads1115Measurement::filterOutputRate() -> double
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    return (fFilter != nullptr) ? fFilter->outputRate() : 0.;
+}
+
+auto Ads1115Measurement::filteredValue() -> double
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fFilteredValue;
+}
+
+auto Ads1115Measurement::filteredSamplesSince(std::chrono::time_point<std::chrono::system_clock> time) -> std::vector<Sample>
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    std::vector<Sample> samples {};
+    for (std::size_t i { 0 }; i < fFilteredBuffer.size(); ++i) {
+        if (fFilteredBuffer[i].time > time)
+            samples.push_back(fFilteredBuffer[i]);
+    }
+    return samples;
 }
 
 void Ads1115Measurement::setFactor(double factor)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <inttypes.h> // uint8_t, etc
@@ -14,7 +15,9 @@
 #include <utility>
 #include <vector>
 
+#include "filterchain.h"
 #include "gpioif.h"
+#include "outlierdetector.h"
 #include "utility.h"
 
 namespace PiRaTe {
@@ -26,6 +29,19 @@ public:
     struct Sample {
         std::chrono::time_point<std::chrono::system_clock> time;
         double value;
+        bool flagged { false }; ///<! sample was flagged as outlier and is excluded from the statistics
+        bool excluded { false }; ///<! sample was rejected by the exclusion function, e.g. taken with the calibration source on
+    };
+
+    /// statistics of the samples within the integration window
+    struct Statistics {
+        std::size_t count { 0 }; ///<! nr. of valid samples
+        std::size_t flagged { 0 }; ///<! nr. of samples flagged as outliers
+        std::size_t excluded { 0 }; ///<! nr. of samples rejected by the exclusion function
+        double mean { 0. };
+        double stddev { 0. }; ///<! sample standard deviation
+        double min { 0. };
+        double max { 0. };
     };
 
     Ads1115Measurement() = delete;
@@ -43,32 +59,169 @@ public:
     [[nodiscard]] auto hasAdc() const -> bool { return (fAdc != nullptr); }
     [[nodiscard]] auto currentValue() -> double;
     [[nodiscard]] auto meanValue() -> double;
+    /**
+    * @brief statistics of the integration window
+    * The statistics are maintained incrementally with each new sample, so the call is cheap
+    * regardless of the length of the integration time.
+    */
+    [[nodiscard]] auto statistics() -> Statistics;
+    [[nodiscard]] auto samplesSince(std::chrono::time_point<std::chrono::system_clock> time) -> std::vector<Sample>;
     [[nodiscard]] auto factor() const -> double { return fFactor; }
     [[nodiscard]] auto name() const -> std::string { return fName; }
+    /**
+    * @brief set the length of the integration window
+    * The sample buffers are reallocated to hold the samples of the window at the nominal sample rate.
+    * This is the only place, besides {@link Ads1115Measurement::setSampleRate} and the switching of the
+    * continuous mode, where the buffers are allocated, so that the sampling never touches the heap.
+    */
     void setIntTime(std::chrono::milliseconds ms);
+    /**
+    * @brief set the nominal rate of the polled or externally supplied samples in Hz
+    */
+    void setSampleRate(double rate_hz);
+
+    /**
+    * @brief pass the samples through a decimating {@link FilterChain}
+    * The filter is set up for the nominal sample rate and set up again whenever the sample rate changes.
+    * The output samples are kept in a separate buffer.
+    */
+    void setFilter(const FilterChain::Settings& settings);
+    /**
+    * @brief flag outliers with a running median/MAD over the preceding samples
+    * Flagged samples are excluded from the statistics of the integration window and replaced by the running median
+    * at the input of the filter chain. They remain in the sample buffer with the flag set.
+    * @param window length of the sliding window in samples
+    * @param threshold flag threshold in units of the robust standard deviation, 0 disables the flagging
+    */
+    void setOutlierRejection(std::size_t window, double threshold);
+    /**
+    * @brief total nr. of samples flagged as outliers since the start or the last change of the outlier rejection
+    */
+    [[nodiscard]] auto nrFlagged() const -> unsigned long { return fNrFlagged; }
+    /**
+    * @brief exclude the samples, for which the given function returns true, from the statistics of the integration window
+    * Used to leave out the samples taken with the calibration source on. Excluded samples bypass the outlier detection
+    * and are replaced by the running median at the input of the filter chain, like the outliers. They remain in the
+    * sample buffer and are passed to the sample queue and the sample callback with the exclusion flag set.
+    * The function is called from the thread which supplied the sample, without the internal lock held.
+    */
+    void setSampleExclusion(std::function<bool(std::chrono::time_point<std::chrono::system_clock>)> fn)
+    {
+        std::lock_guard<std::mutex> lock(fSampleFnMutex);
+        fExclusionFn = std::move(fn);
+    }
+    void disableFilter();
+    [[nodiscard]] auto isFilterEnabled() const -> bool { return fFilterEnabled; }
+    /**
+    * @brief actual output rate of the filter in Hz, 0 if the filter is disabled
+    */
+    [[nodiscard]] auto filterOutputRate() -> double;
+    [[nodiscard]] auto filteredValue() -> double;
+    [[nodiscard]] auto filteredSamplesSince(std::chrono::time_point<std::chrono::system_clock> time) -> std::vector<Sample>;
     void setFactor(double factor);
 
+    [[nodiscard]] auto adc() -> std::shared_ptr<ADS1115>& { return fAdc; }
+    [[nodiscard]] auto adcChannel() const -> std::uint8_t { return fAdcChannel; }
+
+    /**
+    * @brief keep each new sample in a queue for a consumer which must not miss any sample, e.g. the data recorder
+    * When the queue is full, the oldest sample is dropped and counted as lost.
+    * @param capacity max. nr. of queued samples, 0 disables the queue
+    */
+    void setSampleQueue(std::size_t capacity);
+    /**
+    * @brief move all queued samples to the end of the given vector
+    * @return nr. of samples which were lost since the last call because the queue was full
+    */
+    auto takeQueuedSamples(std::vector<Sample>& samples) -> std::size_t;
+
     void registerVoltageReadyCallback(std::function<void(double)> fn) { fVoltageReadyFn = fn; }
+    /**
+    * @brief register a function which is called with each new time stamped sample
+    * The function is called from the thread which supplied the sample, without the internal lock held.
+    * It may be replaced while the sampling is running, the call returns after a running invocation of the old function.
+    */
+    void registerSampleCallback(std::function<void(const Sample&)> fn)
+    {
+        std::lock_guard<std::mutex> lock(fSampleFnMutex);
+        fSampleFn = std::move(fn);
+    }
+    /**
+    * @brief hand over the polled adc readout to an external instance, e.g. {@link AdcScheduler}
+    * When set, the polling loop is idle and the external instance must supply the raw adc voltages
+    * with {@link Ads1115Measurement::processReadout}. The continuous mode is not affected.
+    */
+    void setExternalReadout(bool external) { fExternalReadout = external; }
+    void processReadout(std::chrono::time_point<std::chrono::system_clock> time, double voltage);
+
+    /**
+    * @brief switch the ADC to continuous conversions of the measurement channel
+    * In this mode the polling loop is idle and the samples are fetched with {@link Ads1115Measurement::dataReady},
+    * which has to be called on each data-ready edge of the ADC's ALERT/RDY pin.
+    * @return true on success
+    */
+    auto startContinuousMode() -> bool;
+    void stopContinuousMode();
+    [[nodiscard]] auto isContinuousMode() const -> bool { return fContinuous; }
+    /**
+    * @brief fetch the result of a completed conversion in continuous mode
+    * @param timestamp monotonic time of the data-ready edge as delivered by the gpio event
+    */
+    void dataReady(std::chrono::nanoseconds timestamp);
 
 private:
     void threadLoop();
+    void addSample(std::chrono::time_point<std::chrono::system_clock> time, double value);
+    void evictSamples(std::chrono::time_point<std::chrono::system_clock> time);
+    void pushSample(const Sample& sample);
+    void popOldestSample();
+    void resizeBuffers();
+    void configureFilter();
+    [[nodiscard]] auto nominalSampleRate() const -> double;
 
     std::string fName { "GND" };
     std::shared_ptr<ADS1115> fAdc { nullptr };
     bool fUpdated { false };
     bool fActiveLoop { false };
+    std::atomic<bool> fContinuous { false };
+    std::atomic<bool> fExternalReadout { false };
     std::uint8_t fAdcChannel { 0 };
 
     std::unique_ptr<std::thread> fThread { nullptr };
 
     std::mutex fMutex;
     std::function<void(double)> fVoltageReadyFn {};
+    std::function<void(const Sample&)> fSampleFn {};
+    std::function<bool(std::chrono::time_point<std::chrono::system_clock>)> fExclusionFn {};
+    // serializes the invocation of fSampleFn and fExclusionFn with their replacement
+    std::mutex fSampleFnMutex;
 
     double fValue { 0. };
-    std::deque<Sample> fIntegrationBuffer {};
+    CircularQueue<Sample> fIntegrationBuffer {};
+    CircularQueue<Sample> fSampleQueue {};
+    std::size_t fNrQueueLost { 0 };
+    // running statistics of the integration buffer, the sums are taken relative to the shift value
+    // in order to avoid the cancellation in the variance for large mean values
+    double fShift { 0. };
+    std::size_t fNrValid { 0 }; ///<! nr. of unflagged samples in the integration buffer
+    std::size_t fNrExcluded { 0 }; ///<! nr. of excluded samples in the integration buffer
+    KahanSum<double> fSum {};
+    KahanSum<double> fSumSq {};
+    CircularQueue<Sample> fMinQueue {}; ///<! ascending values, the front is the minimum of the window
+    CircularQueue<Sample> fMaxQueue {}; ///<! descending values, the front is the maximum of the window
 
     double fFactor { 1. };
     std::chrono::milliseconds fIntTime { 1000 };
+    double fSampleRate { 100. }; ///<! nominal sample rate in Hz
+
+    std::atomic<bool> fFilterEnabled { false };
+    FilterChain::Settings fFilterSettings {};
+    std::unique_ptr<FilterChain> fFilter { nullptr };
+    CircularQueue<Sample> fFilteredBuffer;
+    double fFilteredValue { 0. };
+
+    OutlierDetector fOutlierDetector { DEFAULT_OUTLIER_WINDOW, 0. };
+    std::atomic<unsigned long> fNrFlagged { 0 };
 };
 
 } // namespace PiRaTe
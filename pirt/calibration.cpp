@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cmath>
+
+#include "calibration.h"
+#include "gpioif.h"
+#include "timebase.h"
+
+namespace PiRaTe {
+
+CalibrationScheduler::CalibrationScheduler(std::shared_ptr<Gpio> gpio, unsigned int pin, bool inverted)
+    : fGpio { std::move(gpio) }
+    , fPin { pin }
+    , fInverted { inverted }
+{
+}
+
+CalibrationScheduler::~CalibrationScheduler()
+{
+    stop();
+}
+
+auto CalibrationScheduler::start(const Settings& settings) -> bool
+{
+    stop();
+    if (fGpio == nullptr || !fGpio->is_initialised() || settings.tcal <= 0.)
+        return false;
+    std::unique_lock<std::mutex> lock(fMutex);
+    fSettings = settings;
+    fSettings.duration = std::max(fSettings.duration, fSettings.settle + std::chrono::milliseconds(100));
+    // the three segments must fit into one interval
+    const auto min_interval { std::chrono::ceil<std::chrono::seconds>(3 * fSettings.duration + 2 * fSettings.settle) };
+    fSettings.interval = std::max(fSettings.interval, min_interval);
+    fDefined.fill(false);
+    fActiveLoop = true;
+    lock.unlock();
+    fThread = std::make_unique<std::thread>([this]() { this->threadLoop(); });
+    return true;
+}
+
+void CalibrationScheduler::stop()
+{
+    if (fThread == nullptr)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fActiveLoop = false;
+    }
+    fWakeUp.notify_all();
+    fThread->join();
+    fThread.reset();
+    setSource(false);
+    std::lock_guard<std::mutex> lock(fMutex);
+    fDefined.fill(false);
+}
+
+// this is the background thread loop
+void CalibrationScheduler::threadLoop()
+{
+    auto next { TimeBase::now() };
+    while (fActiveLoop) {
+        calibrate();
+        next += fSettings.interval;
+        if (!waitUntil(next))
+            break;
+    }
+}
+
+// one calibration cycle: OFF - ON - OFF
+void CalibrationScheduler::calibrate()
+{
+    const auto duration { std::chrono::duration_cast<std::chrono::system_clock::duration>(fSettings.duration) };
+    const auto settle { std::chrono::duration_cast<std::chrono::system_clock::duration>(fSettings.settle) };
+    const auto start_time { TimeBase::now() };
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fDefined.fill(false);
+        fSums.fill(0.);
+        fCurrent[PRE_OFF] = { start_time, start_time + duration, false, 0., 0 };
+        fDefined[PRE_OFF] = true;
+    }
+    if (!waitUntil(start_time + duration))
+        return;
+
+    setSource(true);
+    const auto on_time { TimeBase::now() };
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fCurrent[ON] = { on_time + settle, on_time + duration, true, 0., 0 };
+        fDefined[ON] = true;
+    }
+    if (!waitUntil(on_time + duration))
+        return;
+
+    setSource(false);
+    const auto off_time { TimeBase::now() };
+    std::lock_guard<std::mutex> lock(fMutex);
+    fCurrent[ON].end = off_time;
+    fCurrent[POST_OFF] = { off_time + settle, off_time + settle + duration, false, 0., 0 };
+    fDefined[POST_OFF] = true;
+    // the calibration is evaluated as soon as the samples of the trailing OFF segment are complete
+}
+
+auto CalibrationScheduler::waitUntil(std::chrono::time_point<std::chrono::system_clock> time) -> bool
+{
+    std::unique_lock<std::mutex> lock(fMutex);
+    fWakeUp.wait_for(lock, time - TimeBase::now(), [this]() { return !fActiveLoop; });
+    return fActiveLoop;
+}
+
+void CalibrationScheduler::setSource(bool on)
+{
+    fGpio->set_gpio_state(fPin, on != fInverted);
+    fCalOn = on;
+}
+
+void CalibrationScheduler::process(std::chrono::time_point<std::chrono::system_clock> time, double value)
+{
+    if (!fActiveLoop)
+        return;
+    std::lock_guard<std::mutex> lock(fMutex);
+    for (std::size_t i { 0 }; i < NR_SEGMENTS; ++i) {
+        if (fDefined[i] && time >= fCurrent[i].start && time < fCurrent[i].end) {
+            fSums[i] += value;
+            fCurrent[i].count++;
+        }
+    }
+    if (fDefined[POST_OFF] && time >= fCurrent[POST_OFF].end)
+        evaluate();
+}
+
+// must be called with the mutex locked
+void CalibrationScheduler::evaluate()
+{
+    fDefined.fill(false);
+    bool complete { true };
+    for (std::size_t i { 0 }; i < NR_SEGMENTS; ++i) {
+        Segment& segment { fCurrent[i] };
+        if (segment.count > 0)
+            segment.mean = fSums[i] / segment.count;
+        else
+            complete = false;
+        if (fHistory.full())
+            fHistory.pop_front();
+        fHistory.push_back(segment);
+    }
+    if (!complete)
+        return;
+    // Y-factor method with the mean of the OFF levels before and after the calibration
+    const double p_on { power(fCurrent[ON].mean) };
+    const double p_off { 0.5 * (power(fCurrent[PRE_OFF].mean) + power(fCurrent[POST_OFF].mean)) };
+    if (p_off <= 0. || p_on <= p_off)
+        return;
+    const double tsys { fSettings.tcal / (p_on / p_off - 1.) };
+    const double gain { p_off / tsys };
+    if (!fEstimate.valid) {
+        fEstimate.gain = gain;
+        fEstimate.tsys = tsys;
+        fEstimate.valid = true;
+    } else {
+        fEstimate.gain += CAL_SMOOTHING * (gain - fEstimate.gain);
+        fEstimate.tsys += CAL_SMOOTHING * (tsys - fEstimate.tsys);
+    }
+    fEstimate.count++;
+    fEstimate.time = fCurrent[POST_OFF].end;
+}
+
+auto CalibrationScheduler::power(double value) const -> double
+{
+    return (fSettings.logarithmic) ? std::pow(10., value / 10.) : value;
+}
+
+auto CalibrationScheduler::isCalibrationSample(std::chrono::time_point<std::chrono::system_clock> time) -> bool
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    const auto settle { std::chrono::duration_cast<std::chrono::system_clock::duration>(fSettings.settle) };
+    // from switch-on until the end of the settling after switch-off
+    auto affected = [&settle, &time](const Segment& segment) {
+        return (time >= segment.start - settle && time < segment.end + settle);
+    };
+    if (fDefined[ON] && affected(fCurrent[ON]))
+        return true;
+    for (std::size_t i { 0 }; i < fHistory.size(); ++i) {
+        if (fHistory[i].on && affected(fHistory[i]))
+            return true;
+    }
+    return false;
+}
+
+auto CalibrationScheduler::estimate() -> Estimate
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fEstimate;
+}
+
+auto CalibrationScheduler::temperature(double value) -> double
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (!fEstimate.valid || fEstimate.gain <= 0.)
+        return 0.;
+    return power(value) / fEstimate.gain;
+}
+
+auto CalibrationScheduler::segments() -> std::vector<Segment>
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    std::vector<Segment> segments {};
+    segments.reserve(fHistory.size());
+    for (std::size_t i { 0 }; i < fHistory.size(); ++i)
+        segments.push_back(fHistory[i]);
+    return segments;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utility.h"
+
+namespace PiRaTe {
+
+class Gpio;
+
+constexpr std::chrono::seconds DEFAULT_CAL_INTERVAL { 600 }; //< default time between two calibrations
+constexpr std::chrono::milliseconds DEFAULT_CAL_DURATION { 5000 }; //< default length of each cal-ON and cal-OFF segment
+constexpr std::chrono::milliseconds DEFAULT_CAL_SETTLE_TIME { 200 }; //< default time after switching, during which the samples are discarded
+constexpr double DEFAULT_CAL_TEMPERATURE { 300. }; //< default equivalent noise temperature of the calibration source in K
+constexpr double CAL_SMOOTHING { 0.3 }; //< weight of a new calibration in the running gain/Tsys estimate
+
+/**
+ * @brief Periodic gain and system temperature calibration with a switched calibration source
+ * A separate thread switches a gpio output (e.g. the relay of a noise diode or of a hot load) on a fixed cadence.
+ * Each calibration consists of three segments: a cal-OFF segment preceding the switch-on, the cal-ON segment and a
+ * cal-OFF segment following the switch-off. The segment boundaries are time stamped at the moment of switching, and
+ * the first part of the ON and the trailing OFF segment is discarded to allow for the settling of the relay and the
+ * receiver. The measurement samples are supplied with {@link CalibrationScheduler::process} and sorted into the
+ * segments by their sample time, so that the result does not depend on the latency of the sample delivery.
+ * When the trailing OFF segment is complete, the system temperature is derived with the Y-factor method from the
+ * ON level and the mean of both OFF levels (which cancels a linear drift), using the known noise temperature of
+ * the calibration source. The gain (detector reading per K system temperature) and Tsys are maintained as
+ * exponentially smoothed running estimates. Readings of a logarithmic detector (in dB) are converted to linear
+ * power first.
+ */
+class CalibrationScheduler {
+public:
+    struct Settings {
+        std::chrono::seconds interval { DEFAULT_CAL_INTERVAL }; ///<! time between the start of two calibrations
+        std::chrono::milliseconds duration { DEFAULT_CAL_DURATION }; ///<! length of each segment
+        std::chrono::milliseconds settle { DEFAULT_CAL_SETTLE_TIME }; ///<! discarded time after each switching
+        double tcal { DEFAULT_CAL_TEMPERATURE }; ///<! noise temperature of the calibration source in K
+        bool logarithmic { false }; ///<! the detector readings are in dB
+    };
+
+    /// one time stamped cal-ON or cal-OFF segment
+    struct Segment {
+        std::chrono::time_point<std::chrono::system_clock> start {}; ///<! begin of the evaluated part of the segment
+        std::chrono::time_point<std::chrono::system_clock> end {}; ///<! end of the segment
+        bool on { false }; ///<! calibration source active
+        double mean { 0. }; ///<! mean detector reading
+        std::size_t count { 0 }; ///<! nr. of samples
+    };
+
+    /// running estimate
+    struct Estimate {
+        bool valid { false }; ///<! at least one calibration succeeded
+        double gain { 0. }; ///<! linear detector power per K system temperature
+        double tsys { 0. }; ///<! system temperature in K
+        std::size_t count { 0 }; ///<! nr. of successful calibrations
+        std::chrono::time_point<std::chrono::system_clock> time {}; ///<! time of the last calibration
+    };
+
+    CalibrationScheduler() = delete;
+    /**
+    * @brief The main constructor.
+    * @param gpio the gpio interface
+    * @param pin gpio pin of the calibration source output
+    * @param inverted the output is active low
+    */
+    CalibrationScheduler(std::shared_ptr<Gpio> gpio, unsigned int pin, bool inverted = false);
+    ~CalibrationScheduler();
+
+    /**
+    * @brief start the periodic calibration, the first one is made immediately
+    */
+    auto start(const Settings& settings) -> bool;
+    /**
+    * @brief stop the calibration and switch the source off, an unfinished calibration is discarded
+    */
+    void stop();
+    [[nodiscard]] auto isActive() const -> bool { return fActiveLoop.load(); }
+    /**
+    * @brief the calibration source is currently switched on or settling
+    */
+    [[nodiscard]] auto isCalibrating() const -> bool { return fCalOn.load(); }
+    [[nodiscard]] auto pin() const -> unsigned int { return fPin; }
+
+    /**
+    * @brief sort one measurement sample into the current calibration
+    * Samples are expected in the order of their sample times.
+    */
+    void process(std::chrono::time_point<std::chrono::system_clock> time, double value);
+    /**
+    * @brief the sample at the given time is affected by the calibration source
+    * Covers the cal-ON segments of the recent calibrations including the settling after switch-off.
+    */
+    [[nodiscard]] auto isCalibrationSample(std::chrono::time_point<std::chrono::system_clock> time) -> bool;
+    [[nodiscard]] auto estimate() -> Estimate;
+    /**
+    * @brief convert a detector reading into a temperature in K with the current gain estimate
+    * @return the temperature or 0 if no valid calibration exists
+    */
+    [[nodiscard]] auto temperature(double value) -> double;
+    /**
+    * @brief the segments of the recent calibrations, oldest first
+    */
+    [[nodiscard]] auto segments() -> std::vector<Segment>;
+
+private:
+    static constexpr std::size_t SEGMENT_HISTORY { 64 };
+
+    enum SegmentIndex {
+        PRE_OFF,
+        ON,
+        POST_OFF,
+        NR_SEGMENTS
+    };
+
+    void threadLoop();
+    void calibrate();
+    auto waitUntil(std::chrono::time_point<std::chrono::system_clock> time) -> bool;
+    void setSource(bool on);
+    void evaluate();
+    [[nodiscard]] auto power(double value) const -> double;
+
+    std::shared_ptr<Gpio> fGpio { nullptr };
+    unsigned int fPin { 0 };
+    bool fInverted { false };
+    Settings fSettings {};
+
+    // segments of the calibration in progress, a segment is defined when its end time is set
+    std::array<Segment, NR_SEGMENTS> fCurrent {};
+    std::array<bool, NR_SEGMENTS> fDefined {};
+    std::array<double, NR_SEGMENTS> fSums {};
+    CircularQueue<Segment> fHistory { SEGMENT_HISTORY };
+    Estimate fEstimate {};
+
+    std::atomic<bool> fCalOn { false };
+    std::atomic<bool> fActiveLoop { false };
+    std::unique_ptr<std::thread> fThread { nullptr };
+    std::mutex fMutex;
+    std::condition_variable fWakeUp;
+};
+
+} // namespace PiRaTe
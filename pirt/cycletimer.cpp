@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "cycletimer.h"
+
+namespace PiRaTe {
+
+constexpr long long NSEC_PER_SEC { 1'000'000'000LL };
+
+namespace {
+    auto nsBetween(const struct timespec& from, const struct timespec& to) -> long long
+    {
+        return (to.tv_sec - from.tv_sec) * NSEC_PER_SEC + (to.tv_nsec - from.tv_nsec);
+    }
+}
+
+CycleTimer::CycleTimer(std::chrono::nanoseconds period)
+    : fPeriod { period }
+{
+    start();
+}
+
+void CycleTimer::start()
+{
+    clock_gettime(CLOCK_MONOTONIC, &fDeadline);
+}
+
+void CycleTimer::wait()
+{
+    const long long period_ns { fPeriod.load().count() };
+    fDeadline.tv_nsec += period_ns;
+    while (fDeadline.tv_nsec >= NSEC_PER_SEC) {
+        fDeadline.tv_nsec -= NSEC_PER_SEC;
+        fDeadline.tv_sec++;
+    }
+    struct timespec now { };
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (nsBetween(fDeadline, now) > period_ns) {
+        // we are more than one cycle behind schedule, so skip the missed cycles instead of catching up with a burst
+        fDeadline = now;
+        std::lock_guard<std::mutex> lock(fMutex);
+        fOverruns++;
+        return;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &fDeadline, nullptr) == EINTR) { }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const double lag_us { 1e-3 * nsBetween(fDeadline, now) };
+    std::lock_guard<std::mutex> lock(fMutex);
+    fCycles++;
+    fSum += lag_us;
+    fSumSq += lag_us * lag_us;
+    fMax = std::max(fMax, lag_us);
+}
+
+auto CycleTimer::statistics() -> Statistics
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    Statistics stats {};
+    stats.cycles = fCycles;
+    stats.overruns = fOverruns;
+    if (fCycles > 0) {
+        stats.mean = fSum / fCycles;
+        stats.rms = std::sqrt(fSumSq / fCycles);
+        stats.max = fMax;
+    }
+    fCycles = fOverruns = 0;
+    fSum = fSumSq = fMax = 0.;
+    return stats;
+}
+
+auto setRealtimePriority(std::thread& thread, int priority) -> bool
+{
+    struct sched_param param { };
+    int policy { SCHED_OTHER };
+    if (priority > 0) {
+        policy = SCHED_FIFO;
+        param.sched_priority = std::clamp(priority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+    }
+    const int rc { pthread_setschedparam(thread.native_handle(), policy, &param) };
+    if (rc != 0) {
+        std::cerr << "setRealtimePriority: error setting scheduling policy: " << std::strerror(rc) << "\n";
+        return false;
+    }
+    return true;
+}
+
+auto setCpuAffinity(std::thread& thread, int cpu) -> bool
+{
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    const int nr_cpus { static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U)) };
+    if (cpu >= nr_cpus) {
+        std::cerr << "setCpuAffinity: cpu " << cpu << " not available\n";
+        return false;
+    }
+    if (cpu < 0) {
+        // no pinning, allow all cpus
+        for (int i = 0; i < nr_cpus; i++)
+            CPU_SET(i, &cpuset);
+    } else {
+        CPU_SET(cpu, &cpuset);
+    }
+    const int rc { pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset) };
+    if (rc != 0) {
+        std::cerr << "setCpuAffinity: error setting cpu affinity: " << std::strerror(rc) << "\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+namespace PiRaTe {
+
+/**
+ * @brief Periodic timer with absolute deadlines for cyclic thread loops
+ * The timer waits with clock_nanosleep on CLOCK_MONOTONIC for the absolute deadline of the next cycle,
+ * so the cycle rate does not drift with the execution time of the loop body. The wake-up lag behind each
+ * deadline is accumulated as jitter statistics. Cycles which are missed by more than one period are skipped
+ * and counted as overruns.
+ */
+class CycleTimer {
+public:
+    struct Statistics {
+        unsigned long cycles { 0 }; ///<! nr. of cycles
+        unsigned long overruns { 0 }; ///<! nr. of cycles skipped because of missed deadlines
+        double mean { 0. }; ///<! mean wake-up lag behind deadline in us
+        double rms { 0. }; ///<! rms wake-up lag behind deadline in us
+        double max { 0. }; ///<! maximum wake-up lag behind deadline in us
+    };
+
+    explicit CycleTimer(std::chrono::nanoseconds period);
+
+    void setPeriod(std::chrono::nanoseconds period) { fPeriod = period; }
+    [[nodiscard]] auto period() const -> std::chrono::nanoseconds { return fPeriod.load(); }
+    /**
+    * @brief set the reference for the deadlines to the current time
+    */
+    void start();
+    /**
+    * @brief wait until the deadline of the next cycle
+    */
+    void wait();
+    /**
+    * @brief jitter statistics
+    * @return the statistics accumulated since the last call
+    */
+    [[nodiscard]] auto statistics() -> Statistics;
+
+private:
+    std::atomic<std::chrono::nanoseconds> fPeriod;
+    struct timespec fDeadline { };
+    std::mutex fMutex;
+    unsigned long fCycles { 0 };
+    unsigned long fOverruns { 0 };
+    double fSum { 0. };
+    double fSumSq { 0. };
+    double fMax { 0. };
+};
+
+/**
+ * @brief set the scheduling policy of a thread
+ * @param thread the thread to be modified
+ * @param priority SCHED_FIFO priority (1..99), values <= 0 select the default policy SCHED_OTHER
+ * @return true if the policy was applied, false otherwise (e.g. missing privileges)
+ */
+auto setRealtimePriority(std::thread& thread, int priority) -> bool;
+
+/**
+ * @brief pin a thread to a cpu
+ * @param thread the thread to be modified
+ * @param cpu index of the cpu, negative values allow all cpus
+ * @return true if the affinity was applied
+ */
+auto setCpuAffinity(std::thread& thread, int cpu) -> bool;
+
+} // namespace PiRaTe
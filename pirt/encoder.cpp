@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <stdio.h>
@@ -14,8 +17,8 @@
 namespace PiRaTe {
 
 unsigned int SsiPosEncoder::fNrInstances = 0;
-constexpr std::chrono::milliseconds loop_delay { 50 };
 constexpr double MAX_TURNS_PER_SECOND { 10. };
+constexpr std::chrono::milliseconds SPEED_TIME_BASE { 20 }; //< minimum time base for the speed evaluation
 
 auto SsiPosEncoder::intToBinaryString(unsigned long number) -> std::string
 {
@@ -35,7 +38,7 @@ auto SsiPosEncoder::gray_decode(std::uint32_t g) -> std::uint32_t
     return g;
 }
 
-SsiPosEncoder::SsiPosEncoder(const std::string& spidev_path, unsigned int baudrate, spi_device::mode_t spi_mode)
+SsiPosEncoder::SsiPosEncoder(const std::string& spidev_path, unsigned int baudrate, spi_device::mode_t spi_mode, bool start_thread)
     : fSpi { std::make_unique<spi_device>(spidev_path) }
 {
     if (fSpi == nullptr) {
@@ -48,15 +51,19 @@ SsiPosEncoder::SsiPosEncoder(const std::string& spidev_path, unsigned int baudra
         std::cerr << "Error: no valid SPI configuration.\n";
         throw std::exception();
     }
+    // the transfer descriptor is set up once, so that a read-out cycle costs a single ioctl only
+    fSpi->prepare_read_transfer(fTransfer, fRxBuffer.data(), fRxBuffer.size());
 
     fActiveLoop = true;
-    // since C++14 using std::make_unique
-    fThread = std::make_unique<std::thread>( [this]() { this->readLoop(); } );
-    // C++11 is unfortunately more unconvenient with move from a locally generated pointer
-//     std::unique_ptr<std::thread> thread( new std::thread( [this]() { this->readLoop(); } ));
-//     fThread = std::move(thread);
-    // or with the reset method of smart pointers
-//     fThread.reset(new std::thread([this]() { this->readLoop(); }));
+    if (start_thread) {
+        // since C++14 using std::make_unique
+        fThread = std::make_unique<std::thread>( [this]() { this->readLoop(); } );
+        // C++11 is unfortunately more unconvenient with move from a locally generated pointer
+    //     std::unique_ptr<std::thread> thread( new std::thread( [this]() { this->readLoop(); } ));
+    //     fThread = std::move(thread);
+        // or with the reset method of smart pointers
+    //     fThread.reset(new std::thread([this]() { this->readLoop(); }));
+    }
     fNrInstances++;
 }
 
@@ -74,129 +81,224 @@ SsiPosEncoder::~SsiPosEncoder()
 // this is the background thread loop
 void SsiPosEncoder::readLoop()
 {
-    bool errorFlag { true };
-    auto lastReadOutTime = std::chrono::system_clock::now();
+    fCycleTimer.start();
     while (fActiveLoop) {
-        std::uint32_t data { 0 };
-        auto currentReadOutTime = std::chrono::system_clock::now();
-        bool ok = readDataWord(data);
-        if (!ok) {
-            errorFlag = true;
-            if (fConErrorCountdown)
-                fConErrorCountdown--;
-        } else {
-            auto readOutDuration { std::chrono::system_clock::now() - std::chrono::system_clock::time_point { currentReadOutTime } };
-            fConErrorCountdown++;
-            // check if MSB is 1
-            // this should always be the case
-            // comment out, if your encoder behaves differently
-            if (!(data & (1 << 31))) {
-                fBitErrors++;
-                errorFlag = true;
-                lastReadOutTime = currentReadOutTime;
-                std::this_thread::sleep_for(loop_delay);
-                continue;
-            }
-            //			std::cout<<" raw: "<<intToBinaryString(data)<<"\n";
-            std::uint32_t temp = data >> (32 - fStBits - fMtBits - 1);
-            temp &= (1 << (fStBits + fMtBits - 1)) - 1;
-            temp = gray_decode(temp);
-            std::uint32_t st = temp & ((1 << (fStBits)) - 1);
-            //			std::cout<<" st: "<<intToBinaryString(st)<<"\n";
-
-            std::int32_t mt = (temp >> fStBits) & ((1 << (fMtBits)) - 1);
-            //			std::cout<<" mt: "<<intToBinaryString(mt)<<"\n";
-
-            // add sign bit to MT value
-            // negative counts have to be offset by -1. Otherwise one had to
-            // distinguish between -0 and +0 rotations
-            if (data & (1 << 30))
-                mt = -mt - 1;
-            //std::cout<<" MT="<<mt;
-
-            if (errorFlag) {
-                fLastPos = st;
-                fLastTurns = mt;
-                lastReadOutTime = currentReadOutTime;
-                std::this_thread::sleep_for(loop_delay);
-                errorFlag = false;
-                continue;
-            }
-
-            int turnDiff = mt - fLastTurns;
-            if (std::abs(turnDiff) > 1) {
-                //std::cout<<" st diff: "<<posDiff<<"\n";
-                fBitErrors++;
-                errorFlag = true;
-                lastReadOutTime = currentReadOutTime;
-                std::this_thread::sleep_for(loop_delay);
-                continue;
-            }
-
-            int posDiff = st - fLastPos;
-
-            if (std::abs(posDiff) > (1 << (fStBits - 1))) {
-                posDiff -= sgn(posDiff) * (1 << (fStBits));
-            }
-            double speed = static_cast<double>(posDiff) / (1 << fStBits);
-            auto diffTime { currentReadOutTime - lastReadOutTime };
-
-            speed *= 1000. / std::chrono::duration_cast<std::chrono::milliseconds>(diffTime).count();
-            if (std::abs(speed) > MAX_TURNS_PER_SECOND) {
-                fBitErrors++;
-                errorFlag = true;
-                lastReadOutTime = currentReadOutTime;
-                std::this_thread::sleep_for(loop_delay);
-                continue;
-            }
-
-            speed *= 360.;
-
-            fLastPos = st;
-            fLastTurns = mt;
-
-            fMutex.lock();
-            fPos = st;
-            fTurns = mt;
-            fCurrentSpeed = speed;
-            fUpdated = true;
-            fReadOutDuration = std::chrono::duration_cast<std::chrono::microseconds>(readOutDuration);
-            fMutex.unlock();
-            lastReadOutTime = currentReadOutTime;
-        }
-        if (fConErrorCountdown > MAX_CONN_ERRORS)
-            fConErrorCountdown = MAX_CONN_ERRORS;
-        std::this_thread::sleep_for(loop_delay);
+        fCycleTimer.wait();
+        const auto currentReadOutTime = std::chrono::steady_clock::now();
+        const bool ok = transferDataWord();
+        processReadout(ok, currentReadOutTime, std::chrono::steady_clock::now() - currentReadOutTime);
     }
 }
 
-auto SsiPosEncoder::readDataWord(std::uint32_t& data) -> bool
+auto SsiPosEncoder::transferDataWord() -> bool
 {
-    if (fSpi == nullptr)
+    if (fSpi == nullptr || !fSpi->is_open())
         return false;
-    constexpr unsigned int nBytes = 4;
-    std::array<std::uint8_t, nBytes> buffer { 0, 0, 0, 0 };
-    if (fSpi->is_open()) {
-        [[maybe_unused]] auto opresult = fSpi->read(buffer.data(), nBytes);
-    } else return false;
-    data = static_cast<std::uint32_t>(buffer[3]) 
-        | (static_cast<std::uint32_t>(buffer[2]) << 8) 
-        | (static_cast<std::uint32_t>(buffer[1]) << 16) 
-        | (static_cast<std::uint32_t>(buffer[0]) << 24);
-    return true;
+    return fSpi->transfer(&fTransfer, 1);
 }
 
-auto SsiPosEncoder::absolutePosition() -> double
+void SsiPosEncoder::processReadout(bool ok, std::chrono::steady_clock::time_point currentReadOutTime, std::chrono::steady_clock::duration readOutDuration)
 {
-    fUpdated = false;
-    double pos = static_cast<double>(fPos) / (1 << fStBits);
-    if (fTurns < 0) {
+    if (!ok) {
+        fErrorFlag = true;
+        if (fConErrorCountdown)
+            fConErrorCountdown--;
+        return;
+    }
+    const std::uint32_t data = static_cast<std::uint32_t>(fRxBuffer[3])
+        | (static_cast<std::uint32_t>(fRxBuffer[2]) << 8)
+        | (static_cast<std::uint32_t>(fRxBuffer[1]) << 16)
+        | (static_cast<std::uint32_t>(fRxBuffer[0]) << 24);
+    fConErrorCountdown++;
+    if (fConErrorCountdown > MAX_CONN_ERRORS)
+        fConErrorCountdown = MAX_CONN_ERRORS;
+    // check if MSB is 1
+    // this should always be the case
+    // comment out, if your encoder behaves differently
+    if (!(data & (1 << 31))) {
+        fBitErrors++;
+        fErrorFlag = true;
+        fLastReadOutTime = currentReadOutTime;
+        return;
+    }
+    //			std::cout<<" raw: "<<intToBinaryString(data)<<"\n";
+    std::uint32_t temp = data >> (32 - fStBits - fMtBits - 1);
+    temp &= (1 << (fStBits + fMtBits - 1)) - 1;
+    temp = gray_decode(temp);
+    std::uint32_t st = temp & ((1 << (fStBits)) - 1);
+    //			std::cout<<" st: "<<intToBinaryString(st)<<"\n";
+
+    std::int32_t mt = (temp >> fStBits) & ((1 << (fMtBits)) - 1);
+    //			std::cout<<" mt: "<<intToBinaryString(mt)<<"\n";
+
+    // add sign bit to MT value
+    // negative counts have to be offset by -1. Otherwise one had to
+    // distinguish between -0 and +0 rotations
+    if (data & (1 << 30))
+        mt = -mt - 1;
+    //std::cout<<" MT="<<mt;
+
+    if (fErrorFlag) {
+        fLastPos = st;
+        fLastTurns = mt;
+        fLastReadOutTime = currentReadOutTime;
+        fSpeedRefTime = currentReadOutTime;
+        fSpeedRefPosition = toRevolutions(st, mt);
+        fErrorFlag = false;
+        return;
+    }
+
+    int turnDiff = mt - fLastTurns;
+    if (std::abs(turnDiff) > 1) {
+        //std::cout<<" st diff: "<<posDiff<<"\n";
+        fBitErrors++;
+        fErrorFlag = true;
+        fLastReadOutTime = currentReadOutTime;
+        return;
+    }
+
+    int posDiff = st - fLastPos;
+
+    if (std::abs(posDiff) > (1 << (fStBits - 1))) {
+        posDiff -= sgn(posDiff) * (1 << (fStBits));
+    }
+    const double diffTime { std::chrono::duration<double>(currentReadOutTime - fLastReadOutTime).count() };
+    if (diffTime > 0. && std::abs(static_cast<double>(posDiff) / (1 << fStBits) / diffTime) > MAX_TURNS_PER_SECOND) {
+        fBitErrors++;
+        fErrorFlag = true;
+        fLastReadOutTime = currentReadOutTime;
+        return;
+    }
+
+    fLastPos = st;
+    fLastTurns = mt;
+    fLastReadOutTime = currentReadOutTime;
+
+    // at high read-out rates a single count difference would dominate the speed,
+    // so the speed is evaluated over a minimum time base
+    const double position { toRevolutions(st, mt) };
+    const double speedTimeBase { std::chrono::duration<double>(currentReadOutTime - fSpeedRefTime).count() };
+    double speed { fCurrentSpeed };
+    if (speedTimeBase >= std::chrono::duration<double>(SPEED_TIME_BASE).count()) {
+        speed = 360. * (position - fSpeedRefPosition) / speedTimeBase;
+        fSpeedRefTime = currentReadOutTime;
+        fSpeedRefPosition = position;
+    }
+
+    fMutex.lock();
+    fPos = st;
+    fTurns = mt;
+    fCurrentSpeed = speed;
+    fUpdated = true;
+    fReadOutDuration = std::chrono::duration_cast<std::chrono::microseconds>(readOutDuration);
+    fMutex.unlock();
+    // the data word is latched somewhere within the read-out, so tag the sample with the mid-time
+    const auto sampleTime { currentReadOutTime + readOutDuration / 2 };
+    if (!fSampleRing.push({ sampleTime, st, mt, speed }))
+        fSampleOverruns++;
+}
+
+void SsiPosEncoder::setReadRate(double rate_hz)
+{
+    rate_hz = std::clamp(rate_hz, MIN_READ_RATE, MAX_READ_RATE);
+    fCycleTimer.setPeriod(std::chrono::nanoseconds(static_cast<long>(1e9 / rate_hz)));
+}
+
+auto SsiPosEncoder::readRate() const -> double
+{
+    return 1e9 / fCycleTimer.period().count();
+}
+
+auto SsiPosEncoder::setRealtimePriority(int priority) -> bool
+{
+    if (fThread == nullptr)
+        return false;
+    return PiRaTe::setRealtimePriority(*fThread, priority);
+}
+
+auto SsiPosEncoder::setCpuAffinity(int cpu) -> bool
+{
+    if (fThread == nullptr)
+        return false;
+    return PiRaTe::setCpuAffinity(*fThread, cpu);
+}
+
+auto SsiPosEncoder::jitterStatistics() -> JitterStatistics
+{
+    return fCycleTimer.statistics();
+}
+
+auto SsiPosEncoder::toRevolutions(std::uint32_t st, std::int32_t mt) const -> double
+{
+    double pos = static_cast<double>(st) / (1 << fStBits);
+    if (mt < 0) {
         pos = 1. - pos;
     }
-    pos += static_cast<double>(fTurns);
+    pos += static_cast<double>(mt);
     return pos;
 }
 
+auto SsiPosEncoder::position() -> unsigned int
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fUpdated = false;
+    return fPos;
+}
+
+auto SsiPosEncoder::nrTurns() -> int
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fUpdated = false;
+    return fTurns;
+}
+
+auto SsiPosEncoder::absolutePosition() -> double
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fUpdated = false;
+    return toRevolutions(fPos, fTurns);
+}
+
+auto SsiPosEncoder::currentSpeed() -> double
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fCurrentSpeed;
+}
+
+auto SsiPosEncoder::readSamples(std::vector<Sample>& samples) -> std::size_t
+{
+    std::size_t count { 0 };
+    Sample sample {};
+    while (fSampleRing.pop(sample)) {
+        samples.push_back(sample);
+        count++;
+    }
+    return count;
+}
+
+auto SsiPosEncoder::interpolate(const std::deque<PositionSample>& history, std::chrono::steady_clock::time_point time) -> double
+{
+    if (history.empty())
+        return 0.;
+    if (history.size() == 1)
+        return history.front().position;
+    // find the first entry later than the requested time
+    auto it = std::find_if(history.begin(), history.end(), [&time](const PositionSample& sample) {
+        return sample.time > time;
+    });
+    if (it == history.begin())
+        ++it;
+    else if (it == history.end())
+        --it;
+    const auto& next = *it;
+    const auto& prev = *std::prev(it);
+    const double dt { std::chrono::duration<double>(next.time - prev.time).count() };
+    if (dt <= 0.)
+        return next.position;
+    const double frac { std::chrono::duration<double>(time - prev.time).count() / dt };
+    return prev.position + frac * (next.position - prev.position);
+}
+
 auto SsiPosEncoder::statusOk() const -> bool
 {
     if (!fActiveLoop)
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
 #include <inttypes.h> // uint8_t, etc
 #include <iomanip>
+#include <linux/spi/spidev.h>
 #include <iostream>
 #include <list>
 #include <mutex>
@@ -12,12 +18,18 @@
 #include <utility>
 #include <vector>
 
+#include "cycletimer.h"
 #include "spidevice.h"
+#include "utility.h"
 
 namespace PiRaTe {
 
 constexpr unsigned int SPI_BAUD_DEFAULT { 500'000U };
 constexpr unsigned int MAX_CONN_ERRORS { 10U };
+constexpr std::size_t SAMPLE_RING_SIZE { 4096U }; //< capacity of the lock-free read-out sample ring
+constexpr double DEFAULT_READ_RATE { 20. }; //< default encoder read-out rate in Hz
+constexpr double MIN_READ_RATE { 1. }; //< minimum encoder read-out rate in Hz
+constexpr double MAX_READ_RATE { 5000. }; //< maximum encoder read-out rate in Hz
 
 /**
  * @brief Interface class for reading out SSI-interface based positional encoders.
@@ -33,11 +45,32 @@ constexpr unsigned int MAX_CONN_ERRORS { 10U };
 * * Instantiate the two encoders with the spidev paths /dev/spidev0.0 and /dev/spidev6.0
 * * The encoders i tested work in SPI mode 3 only (CPHA=1 and CPOL=1), 
 *   so make sure the spi_mode param is set accordingly
- * @note The class launches a separate thread loop upon successfull construction which reads the encoder's data word every 10 ms.
+ * @note The class launches a separate thread loop upon successfull construction which reads the encoder's data word
+ * at a configurable rate (default 20 Hz). The read-out cycles are scheduled with absolute deadlines (clock_nanosleep on
+ * CLOCK_MONOTONIC), the thread may optionally run with SCHED_FIFO priority and pinned to a cpu.
+ * @note Alternatively the encoder may be constructed without own thread loop and read out cyclically from outside, e.g. by an
+ * {@link SsiEncoderGroup} which samples several encoders within the same cycle. In this case the SPI transfer is executed with
+ * {@link SsiPosEncoder::transferDataWord} and the result is handed over with {@link SsiPosEncoder::processReadout}.
+ * @note Every valid read-out is pushed as timestamped {@link SsiPosEncoder::Sample} into a lock-free single-producer/single-consumer
+ * ring, which is drained by exactly one consumer through {@link SsiPosEncoder::readSamples}.
  * @author HG Zaunick
  */
 class SsiPosEncoder {
 public:
+    struct Sample {
+        std::chrono::steady_clock::time_point time; ///<! monotonic time stamp of the read-out
+        std::uint32_t st; ///<! single-turn value
+        std::int32_t mt; ///<! multi-turn value
+        double speed; ///<! angular speed in deg/s
+    };
+
+    using JitterStatistics = CycleTimer::Statistics;
+
+    struct PositionSample {
+        std::chrono::steady_clock::time_point time;
+        double position; ///<! absolute position in revolutions
+    };
+
     SsiPosEncoder() = delete;
     /**
     * @brief The main constructor.
@@ -45,38 +78,82 @@ public:
     * @param spidev_path path to spidev device, e.g. "/dev/spidev0.0
     * @param baudrate the bitrate which the SPI interface should be initialized for
     * @param spi_mode the SPI mode to use (spi_device::MODE::MODE0 etc.)
+    * @param start_thread launch the own read-out thread loop, set to false if the encoder is read out externally
     * @throws std::exception if the initialization of the SPI channel fails
     */
     SsiPosEncoder(const std::string& spidev_path,
         unsigned int baudrate = SPI_BAUD_DEFAULT,
-        spi_device::mode_t spi_mode = spi_device::MODE::MODE3);
+        spi_device::mode_t spi_mode = spi_device::MODE::MODE3,
+        bool start_thread = true);
     ~SsiPosEncoder();
 
     [[nodiscard]] auto isInitialized() const -> bool { return (fSpi && fSpi->is_open()); }
 
-    [[nodiscard]] auto position() -> unsigned int
-    {
-        fUpdated = false;
-        return fPos;
-    }
-    [[nodiscard]] auto nrTurns() -> int
-    {
-        fUpdated = false;
-        return fTurns;
-    }
+    [[nodiscard]] auto position() -> unsigned int;
+    [[nodiscard]] auto nrTurns() -> int;
     [[nodiscard]] auto absolutePosition() -> double;
+    [[nodiscard]] auto toRevolutions(std::uint32_t st, std::int32_t mt) const -> double;
+    /**
+    * @brief fetch all read-out samples acquired since the last call
+    * @param samples vector to which the samples are appended in chronological order
+    * @return number of samples appended
+    * @note the underlying ring supports one consumer only, so only one thread may call this method
+    */
+    auto readSamples(std::vector<Sample>& samples) -> std::size_t;
+    [[nodiscard]] auto sampleOverruns() const -> unsigned long { return fSampleOverruns; }
 
-    [[nodiscard]] auto isUpdated() const -> bool { return fUpdated; }
+    /**
+    * @brief absolute position at an arbitrary point in time
+    * The position is linearly interpolated between the two entries of the history enclosing the given time.
+    * Times outside the range of the history are extrapolated from the nearest entries.
+    * @param history chronologically ordered positions
+    * @param time the point in time for which the position is requested
+    * @return the absolute position in revolutions
+    */
+    [[nodiscard]] static auto interpolate(const std::deque<PositionSample>& history, std::chrono::steady_clock::time_point time) -> double;
+
+    [[nodiscard]] auto isUpdated() const -> bool { return fUpdated.load(); }
     void setStBitWidth(std::uint8_t st_bits) { fStBits = st_bits; }
     void setMtBitWidth(std::uint8_t mt_bits) { fMtBits = mt_bits; }
     [[nodiscard]] auto bitErrorCount() const -> unsigned long { return fBitErrors; }
-    [[nodiscard]] auto currentSpeed() const -> double { return fCurrentSpeed; }
+    [[nodiscard]] auto currentSpeed() -> double;
     [[nodiscard]] auto lastReadOutDuration() const -> std::chrono::duration<int, std::micro> { return fReadOutDuration; }
     [[nodiscard]] auto statusOk() const -> bool;
 
+    void setReadRate(double rate_hz);
+    [[nodiscard]] auto readRate() const -> double;
+    /**
+    * @brief set the scheduling policy of the read-out thread
+    * @param priority SCHED_FIFO priority (1..99), values <= 0 select the default policy SCHED_OTHER
+    * @return true if the policy was applied, false otherwise (e.g. missing privileges)
+    */
+    auto setRealtimePriority(int priority) -> bool;
+    /**
+    * @brief pin the read-out thread to a cpu
+    * @param cpu index of the cpu, negative values allow all cpus
+    */
+    auto setCpuAffinity(int cpu) -> bool;
+    /**
+    * @brief wake-up jitter of the read-out cycles
+    * @return the statistics accumulated since the last call
+    */
+    [[nodiscard]] auto jitterStatistics() -> JitterStatistics;
+
+    /**
+    * @brief execute the SPI transfer of the encoder data word with the pre-built transfer descriptor
+    * @return true if the transfer was successfull
+    */
+    auto transferDataWord() -> bool;
+    /**
+    * @brief decode and validate the data word of the last transfer and publish the result
+    * @param ok result of the preceding {@link SsiPosEncoder::transferDataWord} call
+    * @param readOutTime time stamp of the start of the read-out
+    * @param readOutDuration duration of the read-out, the sample is tagged with the mid-time of the read-out
+    */
+    void processReadout(bool ok, std::chrono::steady_clock::time_point readOutTime, std::chrono::steady_clock::duration readOutDuration);
+
 private:
     void readLoop();
-    auto readDataWord(std::uint32_t& data) -> bool;
     [[nodiscard]] auto gray_decode(std::uint32_t g) -> std::uint32_t;
     [[nodiscard]] auto intToBinaryString(unsigned long number) -> std::string;
 
@@ -89,8 +166,17 @@ private:
     unsigned long fBitErrors { 0 };
     double fCurrentSpeed { 0. };
     std::chrono::duration<int, std::micro> fReadOutDuration {};
+    CycleTimer fCycleTimer { std::chrono::nanoseconds(static_cast<long>(1e9 / DEFAULT_READ_RATE)) };
+    std::array<std::uint8_t, 4> fRxBuffer {};
+    struct spi_ioc_transfer fTransfer { };
+    bool fErrorFlag { true };
+    std::chrono::steady_clock::time_point fLastReadOutTime {};
+    std::chrono::steady_clock::time_point fSpeedRefTime {};
+    double fSpeedRefPosition { 0. };
+    SpscRing<Sample, SAMPLE_RING_SIZE> fSampleRing {};
+    std::atomic<unsigned long> fSampleOverruns { 0 };
 
-    bool fUpdated { false };
+    std::atomic<bool> fUpdated { false };
     bool fActiveLoop { false };
     unsigned int fConErrorCountdown { MAX_CONN_ERRORS };
 
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <chrono>
+
+#include "encodergroup.h"
+
+namespace PiRaTe {
+
+SsiEncoderGroup::SsiEncoderGroup(std::vector<SsiPosEncoder*> encoders, double rate_hz)
+    : fCycleTimer { std::chrono::nanoseconds(static_cast<long>(1e9 / std::clamp(rate_hz, MIN_READ_RATE, MAX_READ_RATE))) }
+{
+    for (auto* encoder : encoders) {
+        if (encoder != nullptr)
+            fEncoders.push_back(encoder);
+    }
+    fResults.resize(fEncoders.size(), false);
+    fActiveLoop = true;
+    fThread = std::make_unique<std::thread>([this]() { this->readLoop(); });
+}
+
+SsiEncoderGroup::~SsiEncoderGroup()
+{
+    fActiveLoop = false;
+    if (fThread != nullptr)
+        fThread->join();
+}
+
+// this is the background thread loop
+void SsiEncoderGroup::readLoop()
+{
+    fCycleTimer.start();
+    while (fActiveLoop) {
+        fCycleTimer.wait();
+        const auto readOutStart = std::chrono::steady_clock::now();
+        // the transfers are issued back to back, decoding is postponed until all encoders are latched
+        for (std::size_t i = 0; i < fEncoders.size(); i++)
+            fResults[i] = fEncoders[i]->transferDataWord();
+        const auto readOutDuration { std::chrono::steady_clock::now() - readOutStart };
+        fSkew = std::chrono::duration_cast<std::chrono::nanoseconds>(readOutDuration);
+        for (std::size_t i = 0; i < fEncoders.size(); i++)
+            fEncoders[i]->processReadout(fResults[i], readOutStart, readOutDuration);
+    }
+}
+
+void SsiEncoderGroup::setReadRate(double rate_hz)
+{
+    rate_hz = std::clamp(rate_hz, MIN_READ_RATE, MAX_READ_RATE);
+    fCycleTimer.setPeriod(std::chrono::nanoseconds(static_cast<long>(1e9 / rate_hz)));
+}
+
+auto SsiEncoderGroup::readRate() const -> double
+{
+    return 1e9 / fCycleTimer.period().count();
+}
+
+auto SsiEncoderGroup::setRealtimePriority(int priority) -> bool
+{
+    if (fThread == nullptr)
+        return false;
+    return PiRaTe::setRealtimePriority(*fThread, priority);
+}
+
+auto SsiEncoderGroup::setCpuAffinity(int cpu) -> bool
+{
+    if (fThread == nullptr)
+        return false;
+    return PiRaTe::setCpuAffinity(*fThread, cpu);
+}
+
+auto SsiEncoderGroup::jitterStatistics() -> CycleTimer::Statistics
+{
+    return fCycleTimer.statistics();
+}
+
+} // namespace PiRaTe
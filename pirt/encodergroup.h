@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "cycletimer.h"
+#include "encoder.h"
+
+namespace PiRaTe {
+
+/**
+ * @brief Synchronous read-out of a group of SSI position encoders
+ * The group runs one thread loop which reads out all member encoders within the same cycle. The SPI transfers of the
+ * encoders are executed back to back with pre-built transfer descriptors, so that the axes are sampled with minimal
+ * skew and all samples of a cycle carry the same time stamp (the mid-time of the whole read-out).
+ * The member encoders have to be constructed without own thread loop (start_thread = false) and must outlive the group.
+ */
+class SsiEncoderGroup {
+public:
+    SsiEncoderGroup() = delete;
+    /**
+    * @brief The main constructor.
+    * Launches the read-out thread loop for the given encoders.
+    * @param encoders pointers to the encoders to be read out
+    * @param rate_hz read-out rate in Hz
+    */
+    SsiEncoderGroup(std::vector<SsiPosEncoder*> encoders, double rate_hz = DEFAULT_READ_RATE);
+    ~SsiEncoderGroup();
+
+    void setReadRate(double rate_hz);
+    [[nodiscard]] auto readRate() const -> double;
+    /**
+    * @brief set the scheduling policy of the read-out thread
+    * @param priority SCHED_FIFO priority (1..99), values <= 0 select the default policy SCHED_OTHER
+    */
+    auto setRealtimePriority(int priority) -> bool;
+    /**
+    * @brief pin the read-out thread to a cpu
+    * @param cpu index of the cpu, negative values allow all cpus
+    */
+    auto setCpuAffinity(int cpu) -> bool;
+    /**
+    * @brief wake-up jitter of the read-out cycles
+    * @return the statistics accumulated since the last call
+    */
+    [[nodiscard]] auto jitterStatistics() -> CycleTimer::Statistics;
+    /**
+    * @brief time between the first and the last transfer of the last read-out cycle
+    */
+    [[nodiscard]] auto lastSkew() const -> std::chrono::nanoseconds { return fSkew.load(); }
+
+private:
+    void readLoop();
+
+    std::vector<SsiPosEncoder*> fEncoders {};
+    std::vector<bool> fResults {};
+    CycleTimer fCycleTimer;
+    std::atomic<std::chrono::nanoseconds> fSkew { std::chrono::nanoseconds(0) };
+    std::atomic<bool> fActiveLoop { false };
+    std::unique_ptr<std::thread> fThread { nullptr };
+};
+
+} // namespace PiRaTe
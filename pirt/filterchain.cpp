@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "filterchain.h"
+
+namespace PiRaTe {
+
+constexpr double COMPENSATION_CUTOFF { 0.4 }; //< pass-band edge of the compensation filter relative to the output rate
+constexpr unsigned int DESIGN_GRID_POINTS { 1024 }; //< nr. of frequency points for the design of the compensation filter
+
+namespace {
+
+// dot product of two double arrays, vectorized with the generic vector extensions of gcc and clang
+auto dotProduct(const double* a, const double* b, std::size_t n) -> double
+{
+    std::size_t i { 0 };
+    double sum { 0. };
+#if defined(__GNUC__)
+    typedef double v2df __attribute__((vector_size(16)));
+    v2df acc0 { 0., 0. };
+    v2df acc1 { 0., 0. };
+    for (; i + 4 <= n; i += 4) {
+        v2df a0, a1, b0, b1;
+        // unaligned loads
+        std::memcpy(&a0, a + i, sizeof(v2df));
+        std::memcpy(&a1, a + i + 2, sizeof(v2df));
+        std::memcpy(&b0, b + i, sizeof(v2df));
+        std::memcpy(&b1, b + i + 2, sizeof(v2df));
+        acc0 += a0 * b0;
+        acc1 += a1 * b1;
+    }
+    acc0 += acc1;
+    sum = acc0[0] + acc0[1];
+#endif
+    for (; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+// low-pass filter with the inverse response of the CIC in the pass-band
+// f is the frequency in units of the CIC output rate
+auto compensationCoefficients(unsigned int taps, unsigned int cic_order, unsigned int cic_decimation, unsigned int decimation) -> std::vector<double>
+{
+    const double cutoff { COMPENSATION_CUTOFF / decimation };
+    const double center { 0.5 * (taps - 1) };
+    std::vector<double> coefficients(taps, 0.);
+    const double df { cutoff / DESIGN_GRID_POINTS };
+    for (unsigned int k { 0 }; k < DESIGN_GRID_POINTS; ++k) {
+        const double f { (k + 0.5) * df };
+        double cic_response { 1. };
+        if (cic_decimation > 1)
+            cic_response = std::pow(std::sin(M_PI * f) / (cic_decimation * std::sin(M_PI * f / cic_decimation)), cic_order);
+        const double gain { 2. * df / std::abs(cic_response) };
+        for (unsigned int n { 0 }; n < taps; ++n)
+            coefficients[n] += gain * std::cos(2. * M_PI * f * (n - center));
+    }
+    // Hamming window and normalization to unity DC gain
+    double sum { 0. };
+    for (unsigned int n { 0 }; n < taps; ++n) {
+        if (taps > 1)
+            coefficients[n] *= 0.54 - 0.46 * std::cos(2. * M_PI * n / (taps - 1));
+        sum += coefficients[n];
+    }
+    for (auto& c : coefficients)
+        c /= sum;
+    return coefficients;
+}
+
+} // namespace
+
+FilterChain::DecimatingFir::DecimatingFir(std::vector<double> coefficients, unsigned int decimation)
+    : fCoefficients { std::move(coefficients) }
+    , fDecimation { std::max(decimation, 1U) }
+{
+    if (fCoefficients.empty())
+        fCoefficients = { 1. };
+    fHistory.assign(2 * fCoefficients.size(), 0.);
+    fTimes.assign(fCoefficients.size(), {});
+}
+
+auto FilterChain::DecimatingFir::process(const Sample& sample, Sample& output) -> bool
+{
+    const std::size_t n { fCoefficients.size() };
+    // the newest sample is at fPos, the window of the last n samples is contiguous from there
+    fPos = (fPos == 0) ? n - 1 : fPos - 1;
+    fHistory[fPos] = fHistory[fPos + n] = sample.value;
+    fTimes[fPos] = sample.time;
+    if (fCount < n)
+        fCount++;
+    if (++fPhase < fDecimation)
+        return false;
+    fPhase = 0;
+    if (fCount < n)
+        return false;
+    output.value = dotProduct(fCoefficients.data(), fHistory.data() + fPos, n);
+    output.time = fTimes[(fPos + n / 2) % n];
+    return true;
+}
+
+void FilterChain::DecimatingFir::reset()
+{
+    std::fill(fHistory.begin(), fHistory.end(), 0.);
+    fPos = fCount = 0;
+    fPhase = 0;
+}
+
+FilterChain::CicDecimator::CicDecimator(unsigned int order, unsigned int decimation, double input_rate)
+    : fOrder { std::max(order, 1U) }
+    , fDecimation { std::max(decimation, 1U) }
+{
+    fHistory.assign(static_cast<std::size_t>(fOrder) * fDecimation, 0.);
+    fSums.assign(fOrder, 0.);
+    fLength = static_cast<std::size_t>(fOrder) * (fDecimation - 1) + 1;
+    const double delay { 0.5 * (fLength - 1) / ((input_rate > 0.) ? input_rate : 1.) };
+    fDelay = std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(delay));
+}
+
+auto FilterChain::CicDecimator::process(const Sample& sample, Sample& output) -> bool
+{
+    const std::size_t n { fDecimation };
+    double value { sample.value };
+    for (std::size_t stage { 0 }; stage < fOrder; ++stage) {
+        double& oldest { fHistory[stage * n + fPos] };
+        fSums[stage] += value - oldest;
+        oldest = value;
+        value = fSums[stage] / n;
+    }
+    if (++fPos == n) {
+        fPos = 0;
+        // refresh the running sums, so that the rounding errors do not accumulate
+        for (std::size_t stage { 0 }; stage < fOrder; ++stage)
+            fSums[stage] = std::accumulate(fHistory.cbegin() + stage * n, fHistory.cbegin() + (stage + 1) * n, 0.);
+    }
+    if (fCount < fLength)
+        fCount++;
+    if (++fPhase < fDecimation)
+        return false;
+    fPhase = 0;
+    if (fCount < fLength)
+        return false;
+    output.value = value;
+    output.time = sample.time - fDelay;
+    return true;
+}
+
+void FilterChain::CicDecimator::reset()
+{
+    std::fill(fHistory.begin(), fHistory.end(), 0.);
+    std::fill(fSums.begin(), fSums.end(), 0.);
+    fPos = fCount = 0;
+    fPhase = 0;
+}
+
+FilterChain::FilterChain(double input_rate, const Settings& settings)
+    : fInputRate { (input_rate > 0.) ? input_rate : 1. }
+    , fSettings { settings }
+{
+    fSettings.cicOrder = std::clamp(fSettings.cicOrder, 1U, MAX_CIC_ORDER);
+    if (fSettings.firTaps > 0 && fSettings.firTaps % 2 == 0)
+        fSettings.firTaps++;
+    if (fSettings.medianWidth % 2 == 0)
+        fSettings.medianWidth++;
+    fSettings.medianWidth = std::min(fSettings.medianWidth, MAX_MEDIAN_WIDTH);
+
+    const unsigned int total_decimation { (fSettings.outputRate > 0.)
+            ? std::max(static_cast<unsigned int>(std::lround(fInputRate / fSettings.outputRate)), 1U)
+            : 1U };
+    // the compensation filter takes the last decimation by 2, if the total decimation is large enough
+    const unsigned int fir_decimation { (fSettings.firTaps > 0 && total_decimation >= 4) ? 2U : 1U };
+    const unsigned int cic_decimation { std::max(static_cast<unsigned int>(std::lround(static_cast<double>(total_decimation) / fir_decimation)), 1U) };
+    fCic = CicDecimator(fSettings.cicOrder, cic_decimation, fInputRate);
+    if (fSettings.firTaps > 0)
+        fCompensation = DecimatingFir(compensationCoefficients(fSettings.firTaps, fSettings.cicOrder, cic_decimation, fir_decimation), fir_decimation);
+    fSettings.outputRate = outputRate();
+}
+
+auto FilterChain::process(const Sample& sample, Sample& output) -> bool
+{
+    Sample intermediate {};
+    if (!fCic.process(sample, intermediate))
+        return false;
+    Sample filtered {};
+    if (!fCompensation.process(intermediate, filtered))
+        return false;
+    if (fSettings.medianWidth < 3) {
+        output = filtered;
+        return true;
+    }
+    return medianFilter(filtered, output);
+}
+
+auto FilterChain::medianFilter(const Sample& sample, Sample& output) -> bool
+{
+    const std::size_t width { fSettings.medianWidth };
+    fMedianWindow[fMedianPos] = sample;
+    fMedianPos = (fMedianPos + 1) % width;
+    if (fMedianCount < width)
+        fMedianCount++;
+    if (fMedianCount < width)
+        return false;
+    std::array<double, MAX_MEDIAN_WIDTH> values {};
+    for (std::size_t i { 0 }; i < width; ++i)
+        values[i] = fMedianWindow[i].value;
+    std::nth_element(values.begin(), values.begin() + width / 2, values.begin() + width);
+    output.value = values[width / 2];
+    // the center of the window, i.e. the sample entered width/2 samples before the newest one
+    output.time = fMedianWindow[(fMedianPos + width / 2) % width].time;
+    return true;
+}
+
+void FilterChain::reset()
+{
+    fCic.reset();
+    fCompensation.reset();
+    fMedianPos = fMedianCount = 0;
+}
+
+} // namespace PiRaTe
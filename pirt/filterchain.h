@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace PiRaTe {
+
+constexpr unsigned int MAX_CIC_ORDER { 6 }; //< maximum nr. of cascaded stages of the CIC decimator
+constexpr unsigned int MAX_MEDIAN_WIDTH { 15 }; //< maximum window length of the median spike filter
+
+/**
+ * @brief Decimating filter chain for detector samples
+ * The input samples pass three stages:
+ * 1. a CIC decimator of configurable order, which averages and decimates the samples by the larger part of the total
+ * decimation. The CIC is evaluated as cascade of running box-car sums, which costs O(order) per sample and
+ * O(order * decimation) memory. The sums are recomputed from their buffers once per box-car length, so no rounding
+ * errors accumulate with floating point values.
+ * 2. a FIR filter, which compensates the pass-band droop of the CIC and decimates by a further factor of 2 with a
+ * steep low-pass response. The coefficients are designed for the actual CIC parameters by frequency sampling
+ * with a Hamming window.
+ * 3. an optional running median of the output samples, which removes isolated spikes (e.g. RFI bursts).
+ * The total decimation is chosen such that the output rate is closest to the requested rate. The filters are linear-phase,
+ * each output sample is tagged with the time of the input sample at the center of the filter. For the CIC stage, this
+ * time is derived from the newest sample and the group delay at the nominal input rate.
+ * All buffers are allocated in the constructor, processing a sample doesn't touch the heap. The dot products of the FIR
+ * stages use the portable vector extensions of the compiler, which map to NEON or SSE instructions respectively.
+ * @note The class is not thread-safe.
+ */
+class FilterChain {
+public:
+    struct Settings {
+        double outputRate { 1. }; ///<! requested output rate in Hz
+        unsigned int cicOrder { 3 }; ///<! nr. of cascaded box-car stages of the CIC decimator
+        unsigned int firTaps { 31 }; ///<! nr. of taps of the compensation FIR filter (odd), 0 disables the stage
+        unsigned int medianWidth { 0 }; ///<! window length of the median spike filter (odd), 0 or 1 disables the stage
+    };
+
+    struct Sample {
+        std::chrono::time_point<std::chrono::system_clock> time {};
+        double value { 0. };
+    };
+
+    FilterChain() = delete;
+    /**
+    * @brief The main constructor.
+    * @param input_rate nominal rate of the input samples in Hz
+    * @param settings the filter configuration
+    */
+    FilterChain(double input_rate, const Settings& settings);
+
+    /**
+    * @brief feed one input sample into the chain
+    * @param sample the input sample
+    * @param output receives the output sample, if one is ready
+    * @return true, if an output sample was produced
+    */
+    auto process(const Sample& sample, Sample& output) -> bool;
+    void reset();
+
+    [[nodiscard]] auto inputRate() const -> double { return fInputRate; }
+    [[nodiscard]] auto outputRate() const -> double { return fInputRate / decimation(); }
+    [[nodiscard]] auto decimation() const -> unsigned int { return fCic.decimation() * fCompensation.decimation(); }
+    [[nodiscard]] auto settings() const -> Settings { return fSettings; }
+
+private:
+    /**
+    * @brief FIR filter with symmetric coefficients and integrated decimation
+    * The history is kept twice in a linear buffer, so that the newest samples are always contiguous in memory.
+    */
+    class DecimatingFir {
+    public:
+        DecimatingFir() = default;
+        DecimatingFir(std::vector<double> coefficients, unsigned int decimation);
+        auto process(const Sample& sample, Sample& output) -> bool;
+        void reset();
+        [[nodiscard]] auto decimation() const -> unsigned int { return fDecimation; }
+
+    private:
+        std::vector<double> fCoefficients { 1. };
+        unsigned int fDecimation { 1 };
+        std::vector<double> fHistory { 0., 0. };
+        std::vector<std::chrono::time_point<std::chrono::system_clock>> fTimes { {} };
+        std::size_t fPos { 0 };
+        std::size_t fCount { 0 }; ///<! nr. of samples since the last reset, saturating at the nr. of coefficients
+        unsigned int fPhase { 0 };
+    };
+
+    /**
+    * @brief CIC decimator as cascade of running box-car averages
+    * The box-cars of all stages share the position in their ring buffers, each stage averages the output of the preceding one.
+    */
+    class CicDecimator {
+    public:
+        CicDecimator() = default;
+        CicDecimator(unsigned int order, unsigned int decimation, double input_rate);
+        auto process(const Sample& sample, Sample& output) -> bool;
+        void reset();
+        [[nodiscard]] auto decimation() const -> unsigned int { return fDecimation; }
+
+    private:
+        unsigned int fOrder { 1 };
+        unsigned int fDecimation { 1 };
+        std::vector<double> fHistory { 0. }; ///<! the ring buffers of the stages one after another
+        std::vector<double> fSums { 0. }; ///<! running sums of the ring buffers
+        std::size_t fPos { 0 };
+        std::size_t fCount { 0 }; ///<! nr. of samples since the last reset, saturating at the length of the impulse response
+        std::size_t fLength { 1 }; ///<! length of the impulse response
+        unsigned int fPhase { 0 };
+        std::chrono::system_clock::duration fDelay {}; ///<! group delay at the nominal input rate
+    };
+
+    auto medianFilter(const Sample& sample, Sample& output) -> bool;
+
+    double fInputRate { 1. };
+    Settings fSettings {};
+    CicDecimator fCic {};
+    DecimatingFir fCompensation {};
+    std::array<Sample, MAX_MEDIAN_WIDTH> fMedianWindow {};
+    std::size_t fMedianPos { 0 };
+    std::size_t fMedianCount { 0 };
+};
+
+} // namespace PiRaTe
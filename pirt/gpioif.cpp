@@ -48,7 +48,7 @@ void Gpio::processEvent(unsigned int gpio, gpiod::line_event event)
     }
 }
 
-void Gpio::eventHandler(gpiod::line line)
+void Gpio::eventHandler(gpiod::line line, bool inline_events)
 {
     while (fThreadRunning) {
         if (inhibit) {
@@ -58,8 +58,13 @@ void Gpio::eventHandler(gpiod::line line)
         const unsigned int gpio { line.offset() };
         if ( line.event_wait(LINE_EVENT_TIMEOUT) ) {
             gpiod::line_event event { line.event_read() };
-            std::thread process_event_bg(&Gpio::processEvent, this, gpio, std::move(event));
-            process_event_bg.detach();
+            if (inline_events) {
+                // spawning a thread for each event does not keep up with high event rates
+                processEvent(gpio, std::move(event));
+            } else {
+                std::thread process_event_bg(&Gpio::processEvent, this, gpio, std::move(event));
+                process_event_bg.detach();
+            }
         } else {
             // a timeout occurred, no event was detected
             // simply go over into the wait loop again
@@ -238,10 +243,14 @@ void Gpio::reloadInterruptSettings()
     this->start();
 }
 
-bool Gpio::registerInterrupt(unsigned int gpio, int edge, std::bitset<32> bias_flags)
+bool Gpio::registerInterrupt(unsigned int gpio, int edge, std::bitset<32> bias_flags, bool inline_events)
 {
     if (!is_initialised())
         return false;
+    if (inline_events)
+        fInlineEventLines.insert(gpio);
+    else
+        fInlineEventLines.erase(gpio);
     auto it = fInterruptLineMap.find(gpio);
     if (it != fInterruptLineMap.end()) {
         // line object exists
@@ -265,6 +274,7 @@ bool Gpio::registerInterrupt(unsigned int gpio, int edge, std::bitset<32> bias_f
     // see if this line is already in use
     if (line.is_used()) {
         std::cerr << "Gpio::registerInterrupt: line " << gpio << " already in use\n";
+        fInlineEventLines.erase(gpio);
         return false;
     }
 
@@ -288,6 +298,7 @@ bool Gpio::unRegisterInterrupt(unsigned int gpio)
     if (it != fInterruptLineMap.end()) {
         it->second.release();
         fInterruptLineMap.erase(it);
+        fInlineEventLines.erase(gpio);
         reloadInterruptSettings();
         return true;
     }
@@ -315,7 +326,8 @@ void Gpio::start()
     fThreadRunning = true;
 
     for (auto& [gpio, line] : fInterruptLineMap) {
-        fThreads[gpio] = std::make_unique<std::thread>([this, gpio, line]() { this->eventHandler(line); });
+        const bool inline_events { fInlineEventLines.count(gpio) > 0 };
+        fThreads[gpio] = std::make_unique<std::thread>([this, line, inline_events]() { this->eventHandler(line, inline_events); });
     }
 }
 
@@ -15,6 +15,7 @@
 #include <memory>
 #include <functional>
 #include <map>
+#include <set>
 
 #include <gpiod.hpp>
 
@@ -75,7 +76,11 @@ public:
     bool setPinBias(unsigned int gpio, std::bitset<32> bias_flags);
     bool setPinState(unsigned int gpio, bool state);
     bool getPinState(unsigned int gpio);
-    bool registerInterrupt(unsigned int gpio, int edge, std::bitset<32> bias_flags);
+    /** @brief request a line for edge events, which are passed to the event callback
+     * @param inline_events process the events in the line's thread instead of a detached thread per event,
+     * for high event rates (e.g. data-ready signals of an ADC) with a callback which returns quickly
+     */
+    bool registerInterrupt(unsigned int gpio, int edge, std::bitset<32> bias_flags, bool inline_events = false);
     bool unRegisterInterrupt(unsigned int gpio);
     void setInhibited(bool inh = true) { inhibit = inh; }
     void set_event_callback(event_callback_t cb) { fEventCallback = cb; }
@@ -89,13 +94,14 @@ public:
 
 private:
     void reloadInterruptSettings();
-    [[gnu::hot]] void eventHandler(gpiod::line line);
+    [[gnu::hot]] void eventHandler(gpiod::line line, bool inline_events);
     [[gnu::hot]] void processEvent(unsigned int gpio, gpiod::line_event event);
 
     bool inhibit { false };
     int verbose { 0 };
     gpiod::chip fChip {};
     std::map<unsigned int, gpiod::line> fInterruptLineMap {};
+    std::set<unsigned int> fInlineEventLines {}; ///< lines whose events are processed in the line's thread
     std::map<unsigned int, gpiod::line> fLineMap {};
     bool fThreadRunning { false };
     std::map<unsigned int, std::unique_ptr<std::thread>> fThreads {};
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cmath>
+
+#include "gpioif.h"
+#include "lockin.h"
+#include "timebase.h"
+
+namespace PiRaTe {
+
+LockInDetector::LockInDetector(std::shared_ptr<Gpio> gpio, unsigned int ref_pin, bool inverted)
+    : fGpio { std::move(gpio) }
+    , fRefPin { ref_pin }
+    , fInverted { inverted }
+    , fCycleTimer { std::chrono::nanoseconds(static_cast<long>(0.5e9 / DEFAULT_LOCKIN_FREQUENCY)) }
+{
+}
+
+LockInDetector::~LockInDetector()
+{
+    stop();
+}
+
+auto LockInDetector::start(double frequency, std::chrono::milliseconds blanking) -> bool
+{
+    stop();
+    if (fGpio == nullptr || !fGpio->is_initialised())
+        return false;
+    frequency = std::clamp(frequency, MIN_LOCKIN_FREQUENCY, MAX_LOCKIN_FREQUENCY);
+    // two transitions per cycle
+    fCycleTimer.setPeriod(std::chrono::nanoseconds(static_cast<long>(0.5e9 / frequency)));
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fBlanking = blanking;
+        fNrTransitions = 0;
+        fHalfSeq = 0;
+        fHalfCount = 0;
+        fHalfSum = 0.;
+        fOnValid = false;
+        fCycles.clear();
+    }
+    fActiveLoop = true;
+    fThread = std::make_unique<std::thread>([this]() { this->threadLoop(); });
+    return true;
+}
+
+void LockInDetector::stop()
+{
+    if (fThread == nullptr)
+        return;
+    fActiveLoop = false;
+    fThread->join();
+    fThread.reset();
+    fGpio->set_gpio_state(fRefPin, fInverted);
+}
+
+auto LockInDetector::frequency() const -> double
+{
+    return 0.5e9 / fCycleTimer.period().count();
+}
+
+// this is the background thread loop
+void LockInDetector::threadLoop()
+{
+    bool on { true };
+    fCycleTimer.start();
+    while (fActiveLoop) {
+        setReference(on);
+        on = !on;
+        fCycleTimer.wait();
+    }
+}
+
+void LockInDetector::setReference(bool on)
+{
+    fGpio->set_gpio_state(fRefPin, on != fInverted);
+    const auto now { TimeBase::now() };
+    std::lock_guard<std::mutex> lock(fMutex);
+    Transition& transition { fTransitions[fNrTransitions % TRANSITION_HISTORY] };
+    transition.time = now;
+    transition.seq = ++fNrTransitions;
+    transition.on = on;
+}
+
+void LockInDetector::process(std::chrono::time_point<std::chrono::system_clock> time, double value)
+{
+    if (!fActiveLoop)
+        return;
+    std::lock_guard<std::mutex> lock(fMutex);
+    // find the latest transition before the sample time
+    const std::size_t nr_kept { static_cast<std::size_t>(std::min<std::uint64_t>(fNrTransitions, TRANSITION_HISTORY)) };
+    const Transition* transition { nullptr };
+    for (std::size_t i { 0 }; i < nr_kept; ++i) {
+        const Transition& candidate { fTransitions[(fNrTransitions - 1 - i) % TRANSITION_HISTORY] };
+        if (candidate.time <= time) {
+            transition = &candidate;
+            break;
+        }
+    }
+    if (transition == nullptr)
+        return;
+    if (transition->seq != fHalfSeq) {
+        closeHalfCycle();
+        fHalfSeq = transition->seq;
+        fHalfOn = transition->on;
+    }
+    if (time - transition->time < fBlanking)
+        return;
+    fHalfSum += value;
+    fHalfCount++;
+    fHalfEnd = time;
+}
+
+// must be called with the mutex locked
+void LockInDetector::closeHalfCycle()
+{
+    if (fHalfCount == 0)
+        return;
+    const double mean { fHalfSum / fHalfCount };
+    fHalfSum = 0.;
+    fHalfCount = 0;
+    if (fHalfOn) {
+        fOnSeq = fHalfSeq;
+        fOnMean = mean;
+        fOnValid = true;
+        return;
+    }
+    // an OFF half cycle completes a cycle, if it immediately follows an ON half cycle
+    if (!fOnValid || fOnSeq + 1 != fHalfSeq)
+        return;
+    fOnValid = false;
+    if (fCycles.full())
+        fCycles.pop_front();
+    fCycles.push_back({ fHalfEnd, fOnMean, mean });
+}
+
+auto LockInDetector::result(std::chrono::milliseconds window) -> Result
+{
+    const auto since { TimeBase::now() - window };
+    std::lock_guard<std::mutex> lock(fMutex);
+    Result result {};
+    double sum_diff_sq { 0. };
+    for (std::size_t i { 0 }; i < fCycles.size(); ++i) {
+        const Cycle& cycle { fCycles[i] };
+        if (cycle.time < since)
+            continue;
+        const double diff { cycle.on - cycle.off };
+        result.cycles++;
+        result.on += cycle.on;
+        result.off += cycle.off;
+        result.diff += diff;
+        sum_diff_sq += diff * diff;
+    }
+    if (result.cycles == 0)
+        return result;
+    const double n { static_cast<double>(result.cycles) };
+    result.on /= n;
+    result.off /= n;
+    result.diff /= n;
+    if (result.cycles > 1) {
+        const double variance { std::max((sum_diff_sq - n * result.diff * result.diff) / (n - 1.), 0.) };
+        result.diffError = std::sqrt(variance / n);
+    }
+    return result;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "cycletimer.h"
+#include "utility.h"
+
+namespace PiRaTe {
+
+class Gpio;
+
+constexpr double DEFAULT_LOCKIN_FREQUENCY { 1. }; //< default switching frequency of the reference output in Hz
+constexpr double MIN_LOCKIN_FREQUENCY { 0.01 }; //< minimum switching frequency in Hz
+constexpr double MAX_LOCKIN_FREQUENCY { 100. }; //< maximum switching frequency in Hz
+constexpr std::chrono::milliseconds DEFAULT_LOCKIN_BLANKING { 20 }; //< default time after each switching, during which the samples are discarded
+
+/**
+ * @brief Synchronous (lock-in) detection with a switched reference
+ * The detector toggles a reference gpio output, e.g. a Dicke switch or a noise source, in a separate thread loop
+ * with a fixed frequency. The times of all transitions are kept, so that each measurement sample supplied with
+ * {@link LockInDetector::process} is tagged with the phase of the reference at its sample time. Samples within
+ * the blanking time after a transition are discarded, which allows for the settling of the switch and the
+ * receiver. The remaining samples of each half cycle are averaged in a per-phase integrator, and for each
+ * pair of an ON and the subsequent OFF half cycle the difference ON-OFF is computed. Since gain variations
+ * which are slow compared to the switching frequency affect both phases equally, they cancel in the difference.
+ * The phase ON denotes the active reference output.
+ */
+class LockInDetector {
+public:
+    /// demodulated result of one full switching cycle
+    struct Cycle {
+        std::chrono::time_point<std::chrono::system_clock> time {}; ///<! time of the end of the cycle
+        double on { 0. }; ///<! mean value of the ON phase
+        double off { 0. }; ///<! mean value of the OFF phase
+    };
+
+    /// average of the cycles within a time window
+    struct Result {
+        std::size_t cycles { 0 }; ///<! nr. of cycles
+        double on { 0. }; ///<! mean value of the ON phases
+        double off { 0. }; ///<! mean value of the OFF phases
+        double diff { 0. }; ///<! mean of the ON-OFF differences
+        double diffError { 0. }; ///<! standard error of the mean difference
+    };
+
+    LockInDetector() = delete;
+    /**
+    * @brief The main constructor.
+    * @param gpio the gpio interface
+    * @param ref_pin gpio pin of the reference output
+    * @param inverted the reference is active low
+    * @note The reference output is not switched until {@link LockInDetector::start} is called.
+    */
+    LockInDetector(std::shared_ptr<Gpio> gpio, unsigned int ref_pin, bool inverted = false);
+    ~LockInDetector();
+
+    /**
+    * @brief start switching the reference output
+    * @param frequency switching frequency in Hz (one full ON/OFF cycle per period)
+    * @param blanking time after each transition, during which the samples are discarded
+    */
+    auto start(double frequency, std::chrono::milliseconds blanking = DEFAULT_LOCKIN_BLANKING) -> bool;
+    /**
+    * @brief stop switching and set the reference output inactive
+    */
+    void stop();
+    [[nodiscard]] auto isActive() const -> bool { return fActiveLoop.load(); }
+    [[nodiscard]] auto refPin() const -> unsigned int { return fRefPin; }
+    [[nodiscard]] auto frequency() const -> double;
+
+    /**
+    * @brief phase-tag and integrate one measurement sample
+    * Samples are expected in the order of their sample times.
+    */
+    void process(std::chrono::time_point<std::chrono::system_clock> time, double value);
+    /**
+    * @brief average of the cycles which ended within the given time window before now
+    */
+    [[nodiscard]] auto result(std::chrono::milliseconds window) -> Result;
+
+private:
+    static constexpr std::size_t TRANSITION_HISTORY { 256 };
+    static constexpr std::size_t CYCLE_CAPACITY { 8192 };
+
+    struct Transition {
+        std::chrono::time_point<std::chrono::system_clock> time {};
+        std::uint64_t seq { 0 }; ///<! running nr. of the half cycle starting with this transition
+        bool on { false };
+    };
+
+    void threadLoop();
+    void setReference(bool on);
+    void closeHalfCycle();
+
+    std::shared_ptr<Gpio> fGpio { nullptr };
+    unsigned int fRefPin { 0 };
+    bool fInverted { false };
+    CycleTimer fCycleTimer;
+    std::chrono::milliseconds fBlanking { DEFAULT_LOCKIN_BLANKING };
+
+    std::array<Transition, TRANSITION_HISTORY> fTransitions {};
+    std::uint64_t fNrTransitions { 0 };
+
+    // integrator of the current half cycle
+    std::uint64_t fHalfSeq { 0 };
+    bool fHalfOn { false };
+    double fHalfSum { 0. };
+    std::size_t fHalfCount { 0 };
+    std::chrono::time_point<std::chrono::system_clock> fHalfEnd {};
+    // mean of the last completed ON half cycle
+    std::uint64_t fOnSeq { 0 };
+    double fOnMean { 0. };
+    bool fOnValid { false };
+    CircularQueue<Cycle> fCycles { CYCLE_CAPACITY };
+
+    std::atomic<bool> fActiveLoop { false };
+    std::unique_ptr<std::thread> fThread { nullptr };
+    std::mutex fMutex;
+};
+
+} // namespace PiRaTe
@@ -141,7 +141,7 @@ void MotorDriver::threadLoop()
                 setSpeed(fCurrentDutyCycle);
             }
         }
-        if (hasAdc() && !cycle_counter--) {
+        if (hasAdc() && !fExternalReadout && !cycle_counter--) {
             double voltage { 0. };
             double conv_time { 0. };
             if ([[maybe_unused]] bool readout_guard = true) {
@@ -151,15 +151,7 @@ void MotorDriver::threadLoop()
                 conv_time = fAdc->getLastConvTime();
                 fMutex.unlock();
             }
-            if (std::abs(fCurrentDutyCycle) < ramp_increment)
-                fOffsetBuffer.add(voltage);
-            double _current = (voltage - fOffsetBuffer.mean()) * MOTOR_CURRENT_FACTOR;
-            fMutex.lock();
-            fCurrent = _current;
-            if (_current > fMaxCurrent)
-                fMaxCurrent = _current;
-            fUpdated = true;
-            fMutex.unlock();
+            processCurrentReadout(voltage);
             cycle_counter = adc_measurement_rate_loop_cycles;
             std::this_thread::sleep_for(std::chrono::milliseconds(std::max(loop_delay.count() - static_cast<long long int>(conv_time), 1LL)));
         } else {
@@ -168,6 +160,18 @@ void MotorDriver::threadLoop()
     }
 }
 
+void MotorDriver::processCurrentReadout(double voltage)
+{
+    const std::lock_guard<std::mutex> lock(fMutex);
+    if (std::abs(fCurrentDutyCycle) < ramp_increment)
+        fOffsetBuffer.add(voltage);
+    const double _current = (voltage - fOffsetBuffer.mean()) * MOTOR_CURRENT_FACTOR;
+    fCurrent = _current;
+    if (_current > fMaxCurrent)
+        fMaxCurrent = _current;
+    fUpdated = true;
+}
+
 void MotorDriver::measureVoltageOffset()
 {
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <inttypes.h> // uint8_t, etc
 #include <iomanip>
@@ -101,6 +102,14 @@ public:
 
     void setEnabled(bool enable);
     [[nodiscard]] auto adc() -> std::shared_ptr<ADS1115>& { return fAdc; }
+    [[nodiscard]] auto adcChannel() const -> std::uint8_t { return fAdcChannel; }
+    /**
+    * @brief hand over the readout of the current-supervision adc to an external instance, e.g. {@link AdcScheduler}
+    * When set, the motor driver does not access the adc anymore. The external instance must then supply
+    * the voltages with {@link MotorDriver::processCurrentReadout}.
+    */
+    void setExternalReadout(bool external) { fExternalReadout = external; }
+    void processCurrentReadout(double voltage);
 
 private:
     void threadLoop();
@@ -121,6 +130,7 @@ private:
     std::uint8_t fAdcChannel { 0 };
     double fCurrent { 0. };
     double fMaxCurrent { 0. };
+    std::atomic<bool> fExternalReadout { false };
 
     std::unique_ptr<std::thread> fThread { nullptr };
 
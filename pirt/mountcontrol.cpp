@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "encoder.h"
+#include "motordriver.h"
+#include "mountcontrol.h"
+
+namespace PiRaTe {
+
+auto MountController::Target::evaluate(std::chrono::time_point<std::chrono::system_clock> time) const -> TrackingEngine::State
+{
+    if (equatorial)
+        return engine.evaluate(time);
+    // extrapolate the horizontal segment linearly from its epoch
+    const double dt { std::chrono::duration<double>(time - epoch).count() };
+    TrackingEngine::State state {};
+    state.az = az + azRate * dt;
+    state.alt = alt + altRate * dt;
+    state.azRate = azRate;
+    state.altRate = altRate;
+    return state;
+}
+
+MountController::MountController(std::array<SsiPosEncoder*, 2> encoders, std::array<MotorDriver*, 2> motors, std::array<AxisServo*, 2> servos, double rate_hz)
+    : fEncoders { encoders }
+    , fMotors { motors }
+    , fServos { servos }
+    , fCycleTimer { std::chrono::nanoseconds(static_cast<long>(1e9 / std::clamp(rate_hz, MIN_CONTROL_RATE, MAX_CONTROL_RATE))) }
+{
+    for (std::size_t axis = 0; axis < 2; axis++) {
+        if (fEncoders[axis] == nullptr || fMotors[axis] == nullptr || fServos[axis] == nullptr)
+            return;
+    }
+    fActiveLoop = true;
+    fThread = std::make_unique<std::thread>([this]() { this->threadLoop(); });
+}
+
+MountController::~MountController()
+{
+    fActiveLoop = false;
+    if (fThread != nullptr) {
+        fThread->join();
+        stopAll();
+    }
+}
+
+// this is the background thread loop
+void MountController::threadLoop()
+{
+    fCycleTimer.start();
+    while (fActiveLoop) {
+        fCycleTimer.wait();
+        controlStep(std::chrono::system_clock::now());
+    }
+}
+
+void MountController::controlStep(std::chrono::time_point<std::chrono::system_clock> now)
+{
+    const Config config { fConfig.load() };
+    for (std::size_t axis = 0; axis < 2; axis++)
+        fState.absTurns[axis] = axisTurns(axis, config);
+
+    Command cmd {};
+    while (fCommands.pop(cmd))
+        processCommand(cmd);
+
+    if (fState.mode != Mode::Idle)
+        followTarget(config, now);
+
+    checkCurrents(config);
+    checkLimits(config);
+
+    for (std::size_t axis = 0; axis < 2; axis++)
+        fState.motorSpeed[axis] = fMotors[axis]->currentSpeed();
+    fState.cycles++;
+    fStatus.store(fState);
+}
+
+void MountController::processCommand(const Command& cmd)
+{
+    switch (cmd.type) {
+    case Command::Type::Slew:
+    case Command::Type::Track:
+        fTarget = cmd.target;
+        fState.id = cmd.id;
+        fState.mode = (cmd.type == Command::Type::Slew) ? Mode::Slewing : Mode::Tracking;
+        fState.manual.fill(false);
+        fSlewPlanRequired = (cmd.type == Command::Type::Slew);
+        fInTolerance = false;
+        break;
+    case Command::Type::UpdateTarget:
+        fTarget = cmd.target;
+        break;
+    case Command::Type::Move:
+        if (cmd.axis > AXIS_ALT)
+            break;
+        if (cmd.speed == 0.) {
+            fMotors[cmd.axis]->stop();
+            fState.manual[cmd.axis] = false;
+            break;
+        }
+        // manual motion overrides the servo
+        fServos[cmd.axis]->disable();
+        fMotors[cmd.axis]->move(static_cast<float>(std::clamp(cmd.speed, -1., 1.)));
+        fState.manual[cmd.axis] = true;
+        break;
+    case Command::Type::Stop:
+    default:
+        stopAll();
+        break;
+    }
+}
+
+void MountController::followTarget(const Config& config, std::chrono::time_point<std::chrono::system_clock> now)
+{
+    const auto target { fTarget.evaluate(now) };
+    const double azAbsTurns { fState.absTurns[AXIS_AZ] };
+    const double altAbsTurns { fState.absTurns[AXIS_ALT] };
+
+    // calculate the movement vector and correct the angles to the valid range
+    double dx { std::remainder(target.az - 360. * azAbsTurns, 360.) };
+    const double dy { std::remainder(target.alt - 360. * altAbsTurns, 360.) };
+
+    // check, if the absolute position of the target is beyond the allowable limit
+    // if so, we still must be sure to turn into the right direction toward the allowable range
+    // e.g. if we are currently far in the forbidden range, make sure to not go further in
+    if (std::abs(azAbsTurns + dx / 360.) >= 0.5 + config.azOverturn) {
+        const double alt_dx { (dx > 0.) ? (dx - 360.) : (dx + 360.) };
+        if (std::abs(azAbsTurns + dx / 360.) > std::abs(azAbsTurns + alt_dx / 360.))
+            dx = alt_dx;
+    }
+    fState.error = { dx, dy };
+
+    // a new slew is executed along a planned trajectory, afterwards the setpoints are handed over to the axis
+    // servos directly, a moving target's rate is applied as velocity feed-forward
+    if (fSlewPlanRequired) {
+        fSlewPlanRequired = false;
+        const std::array<double, 2> start { 360. * azAbsTurns, 360. * altAbsTurns };
+        const std::array<double, 2> distance { dx, dy };
+        const std::array<double, 2> rate { target.azRate, target.altRate };
+        std::array<TrapezoidalProfile, 2> profiles {};
+        double duration { 0. };
+        // aim at the position of a moving target at the time of arrival,
+        // two iterations are sufficient for targets moving at sidereal rate
+        for (int i = 0; i < 2; i++) {
+            for (std::size_t axis = 0; axis < 2; axis++)
+                profiles[axis] = TrapezoidalProfile(start[axis], distance[axis] + rate[axis] * duration, config.slewLimits[axis]);
+            duration = synchronize(profiles[AXIS_AZ], profiles[AXIS_ALT]);
+        }
+        for (std::size_t axis = 0; axis < 2; axis++) {
+            if (!fState.manual[axis])
+                fServos[axis]->followTrajectory(profiles[axis], rate[axis]);
+        }
+    }
+    if (!fServos[AXIS_AZ]->trajectoryActive() && !fServos[AXIS_ALT]->trajectoryActive()) {
+        if (!fState.manual[AXIS_AZ])
+            fServos[AXIS_AZ]->setTarget(360. * azAbsTurns + dx, target.azRate);
+        if (!fState.manual[AXIS_ALT])
+            fServos[AXIS_ALT]->setTarget(360. * altAbsTurns + dy, target.altRate);
+    }
+
+    if (fState.mode != Mode::Slewing)
+        return;
+    // the slew is complete when both axes stayed within the tolerance for the settle time
+    if (std::abs(dx) >= config.tolerance[AXIS_AZ] || std::abs(dy) >= config.tolerance[AXIS_ALT]) {
+        fInTolerance = false;
+        return;
+    }
+    if (!fInTolerance) {
+        fInTolerance = true;
+        fToleranceStart = now;
+        return;
+    }
+    if (now - fToleranceStart >= config.settleTime) {
+        stopAll();
+        pushEvent(Event::Type::SlewComplete, AXIS_AZ, azAbsTurns);
+    }
+}
+
+void MountController::checkLimits(const Config& config)
+{
+    // stop all movements if motors are moving further into the forbidden range,
+    // on the other hand, allow movement into the opposite direction only
+    const double azLimit { 0.5 + config.azOverturn + config.azLimitMargin };
+    const double az { fState.absTurns[AXIS_AZ] };
+    const double azSpeed { fMotors[AXIS_AZ]->currentSpeed() };
+    if ((az < -azLimit && azSpeed < 0.) || (az > azLimit && azSpeed > 0.)) {
+        stopAll();
+        pushEvent(Event::Type::LimitStop, AXIS_AZ, az);
+    }
+    const double alt { fState.absTurns[AXIS_ALT] };
+    const double altSpeed { fMotors[AXIS_ALT]->currentSpeed() };
+    if ((alt < config.altLimitLow && altSpeed < 0.) || (alt > config.altLimitHigh && altSpeed > 0.)) {
+        stopAll();
+        pushEvent(Event::Type::LimitStop, AXIS_ALT, alt);
+    }
+}
+
+void MountController::checkCurrents(const Config& config)
+{
+    for (std::size_t axis = 0; axis < 2; axis++) {
+        if (!fMotors[axis]->hasAdc())
+            continue;
+        const double current { fMotors[axis]->readCurrent() };
+        fState.motorCurrent[axis] = current;
+        const bool overCurrent { current > config.currentLimit[axis] };
+        if (overCurrent) {
+            // motor current limit exceeded. Stop immediately
+            fServos[axis]->disable();
+            fMotors[axis]->stop();
+            fState.manual[axis] = false;
+            if (!fState.overCurrent[axis])
+                pushEvent(Event::Type::CurrentLimit, axis, current);
+        }
+        fState.overCurrent[axis] = overCurrent;
+    }
+}
+
+void MountController::stopAll()
+{
+    for (std::size_t axis = 0; axis < 2; axis++) {
+        fServos[axis]->disable();
+        fMotors[axis]->stop();
+    }
+    fState.mode = Mode::Idle;
+    fState.manual.fill(false);
+    fSlewPlanRequired = false;
+    fInTolerance = false;
+}
+
+void MountController::pushEvent(Event::Type type, std::size_t axis, double value)
+{
+    Event event {};
+    event.type = type;
+    event.id = fState.id;
+    event.axis = axis;
+    event.value = value;
+    // the event is dropped if the driver does not keep up with the queue
+    fEvents.push(event);
+}
+
+auto MountController::axisTurns(std::size_t axis, const Config& config) -> double
+{
+    const auto& scale { config.scale[axis] };
+    if (scale.ratio == 0.)
+        return 0.;
+    const double turns { fEncoders[axis]->absolutePosition() / scale.ratio + scale.offset / 360. };
+    return (scale.invert) ? -turns : turns;
+}
+
+auto MountController::command(const Command& cmd) -> bool
+{
+    return fCommands.push(cmd);
+}
+
+auto MountController::nextEvent(Event& event) -> bool
+{
+    return fEvents.pop(event);
+}
+
+void MountController::setRate(double rate_hz)
+{
+    rate_hz = std::clamp(rate_hz, MIN_CONTROL_RATE, MAX_CONTROL_RATE);
+    fCycleTimer.setPeriod(std::chrono::nanoseconds(static_cast<long>(1e9 / rate_hz)));
+}
+
+auto MountController::rate() const -> double
+{
+    return 1e9 / fCycleTimer.period().count();
+}
+
+auto MountController::setRealtimePriority(int priority) -> bool
+{
+    if (fThread == nullptr)
+        return false;
+    return PiRaTe::setRealtimePriority(*fThread, priority);
+}
+
+} // namespace PiRaTe
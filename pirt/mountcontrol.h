@@ -0,0 +1,187 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "cycletimer.h"
+#include "servo.h"
+#include "tracking.h"
+#include "trajectory.h"
+#include "utility.h"
+
+namespace PiRaTe {
+
+class MotorDriver;
+class SsiPosEncoder;
+
+constexpr double DEFAULT_CONTROL_RATE { 50. }; //< default rate of the mount control loop in Hz
+constexpr double MIN_CONTROL_RATE { 5. }; //< minimum rate of the mount control loop in Hz
+constexpr double MAX_CONTROL_RATE { 500. }; //< maximum rate of the mount control loop in Hz
+
+/**
+ * @brief Real-time control loop of the telescope mount
+ * The controller runs a separate thread loop which owns all motion decisions of the mount: it reads the axis positions
+ * from the pos encoders, evaluates the current target, plans slews, hands the setpoints over to the axis servos, detects
+ * the completion of a slew and enforces the axis turn limits and motor current limits.
+ * The loop is decoupled from the (possibly slow) driver thread: motion commands are passed in through a lock-free
+ * command queue ({@link MountController::command}), asynchronous events like a completed slew or a limit stop are
+ * passed back through a lock-free event queue ({@link MountController::nextEvent}) and the current state of the
+ * mount is published as a snapshot ({@link MountController::status}) which can be read at any time without blocking
+ * the control loop. The settings are handed over the same way with {@link MountController::setConfig}.
+ * Each of the queues and the settings support exactly one producer and one consumer thread, i.e. all commands and
+ * settings must be issued from the same (driver) thread.
+ * A target is either an equatorial object evaluated by a {@link TrackingEngine} or a linear segment in horizontal
+ * coordinates. The tracking engine must be refreshed by the driver before it expires by sending an
+ * {@link MountController::Command::Type::UpdateTarget} command.
+ */
+class MountController {
+public:
+    static constexpr std::size_t AXIS_AZ { 0 };
+    static constexpr std::size_t AXIS_ALT { 1 };
+
+    /// target of a slew or of a tracking/follow motion
+    struct Target {
+        bool equatorial { false }; ///<! evaluate the target with the tracking engine, otherwise use the horizontal segment
+        TrackingEngine engine {}; ///<! the expansion of an equatorial target
+        double az { 0. }; ///<! azimuth of a horizontal target at the epoch in deg
+        double alt { 0. }; ///<! altitude of a horizontal target at the epoch in deg
+        double azRate { 0. }; ///<! azimuth rate of a horizontal target in deg/s
+        double altRate { 0. }; ///<! altitude rate of a horizontal target in deg/s
+        std::chrono::time_point<std::chrono::system_clock> epoch {}; ///<! reference time of a horizontal target
+        /**
+        * @brief horizontal position and rates of the target at the given time
+        */
+        [[nodiscard]] auto evaluate(std::chrono::time_point<std::chrono::system_clock> time) const -> TrackingEngine::State;
+    };
+
+    struct Command {
+        enum class Type {
+            Slew, ///<! slew along a planned trajectory, an event is issued when the target is reached
+            Track, ///<! follow the target continuously without completion
+            UpdateTarget, ///<! replace the target of the running motion without new slew planning
+            Move, ///<! drive one axis manually with the given speed, speed 0 returns the axis to the control loop
+            Stop ///<! stop all motion
+        };
+        Type type { Type::Stop };
+        unsigned long id { 0 }; ///<! id of the motion, returned with the events caused by this command
+        Target target {};
+        std::size_t axis { AXIS_AZ }; ///<! axis of a manual motion
+        double speed { 0. }; ///<! speed ratio (-1..1) of a manual motion
+    };
+
+    struct Event {
+        enum class Type {
+            SlewComplete, ///<! the target of a slew was reached and the motion was stopped
+            LimitStop, ///<! an axis ran into the turn limits, all motion was stopped
+            CurrentLimit ///<! the motor current limit of an axis was exceeded, the axis was stopped
+        };
+        Type type { Type::SlewComplete };
+        unsigned long id { 0 }; ///<! id of the motion active at the time of the event
+        std::size_t axis { AXIS_AZ };
+        double value { 0. }; ///<! axis position in revolutions or motor current in A, depending on the type
+    };
+
+    struct Config {
+        std::array<AxisServo::Scale, 2> scale {}; ///<! conversion of encoder revolutions to axis positions
+        double azOverturn { 0.5 }; ///<! allowed overturn of the Az axis beyond +-0.5 revolutions at both ends
+        double azLimitMargin { 0.1 }; ///<! additional margin of the Az axis in revolutions before motion is stopped
+        double altLimitLow { 0. }; ///<! lower limit of the Alt axis in revolutions
+        double altLimitHigh { 0.25 }; ///<! upper limit of the Alt axis in revolutions
+        std::array<double, 2> tolerance { 0.05, 0.05 }; ///<! positioning tolerance of both axes in deg
+        std::array<TrapezoidalProfile::Limits, 2> slewLimits {}; ///<! velocity and acceleration limits of the slew planner
+        std::array<double, 2> currentLimit { 1e3, 1e3 }; ///<! motor current limits in A
+        std::chrono::milliseconds settleTime { 250 }; ///<! time within the tolerance before a slew is complete
+    };
+
+    enum class Mode {
+        Idle,
+        Slewing,
+        Tracking
+    };
+
+    /// snapshot of the mount state, updated in each cycle of the control loop
+    struct Status {
+        Mode mode { Mode::Idle };
+        unsigned long id { 0 }; ///<! id of the current motion
+        unsigned long cycles { 0 }; ///<! nr. of control cycles since start
+        std::array<double, 2> absTurns {}; ///<! absolute axis positions in revolutions
+        std::array<double, 2> error {}; ///<! distance to the target in deg
+        std::array<bool, 2> manual {}; ///<! axis in manual motion
+        std::array<double, 2> motorSpeed {}; ///<! current motor speed ratios
+        std::array<double, 2> motorCurrent {}; ///<! last motor current read-outs in A
+        std::array<bool, 2> overCurrent {}; ///<! motor current limit exceeded
+    };
+
+    MountController() = delete;
+    /**
+    * @brief The main constructor.
+    * Launches the control thread loop. The controller is initially idle.
+    * @param encoders the pos encoders of the Az and Alt axis
+    * @param motors the motor drivers of the Az and Alt axis
+    * @param servos the axis servos of the Az and Alt axis
+    * @param rate_hz control loop rate in Hz
+    * @note encoders, motors and servos must outlive the controller object
+    */
+    MountController(std::array<SsiPosEncoder*, 2> encoders, std::array<MotorDriver*, 2> motors, std::array<AxisServo*, 2> servos, double rate_hz = DEFAULT_CONTROL_RATE);
+    ~MountController();
+
+    /**
+    * @brief queue a motion command for the control loop
+    * @return false if the command queue is full
+    */
+    auto command(const Command& cmd) -> bool;
+    /**
+    * @brief fetch the next event issued by the control loop
+    * @return false if no event is pending
+    */
+    auto nextEvent(Event& event) -> bool;
+    void setConfig(const Config& config) { fConfig.store(config); }
+    [[nodiscard]] auto config() const -> Config { return fConfig.load(); }
+    [[nodiscard]] auto status() const -> Status { return fStatus.load(); }
+
+    void setRate(double rate_hz);
+    [[nodiscard]] auto rate() const -> double;
+    auto setRealtimePriority(int priority) -> bool;
+    /**
+    * @brief jitter statistics of the control loop
+    * @return the statistics accumulated since the last call
+    */
+    [[nodiscard]] auto jitterStatistics() -> CycleTimer::Statistics { return fCycleTimer.statistics(); }
+
+private:
+    void threadLoop();
+    void controlStep(std::chrono::time_point<std::chrono::system_clock> now);
+    void processCommand(const Command& cmd);
+    void planSlew(const Config& config, std::chrono::time_point<std::chrono::system_clock> now);
+    void followTarget(const Config& config, std::chrono::time_point<std::chrono::system_clock> now);
+    void checkLimits(const Config& config);
+    void checkCurrents(const Config& config);
+    void stopAll();
+    void pushEvent(Event::Type type, std::size_t axis, double value);
+    [[nodiscard]] auto axisTurns(std::size_t axis, const Config& config) -> double;
+
+    std::array<SsiPosEncoder*, 2> fEncoders {};
+    std::array<MotorDriver*, 2> fMotors {};
+    std::array<AxisServo*, 2> fServos {};
+    CycleTimer fCycleTimer;
+
+    SpscRing<Command, 16> fCommands {};
+    SpscRing<Event, 16> fEvents {};
+    SeqLock<Config> fConfig {};
+    SeqLock<Status> fStatus {};
+
+    // the following members are accessed by the control thread only
+    Status fState {};
+    Target fTarget {};
+    bool fSlewPlanRequired { false };
+    bool fInTolerance { false };
+    std::chrono::time_point<std::chrono::system_clock> fToleranceStart {};
+
+    std::atomic<bool> fActiveLoop { false };
+    std::unique_ptr<std::thread> fThread { nullptr };
+};
+
+} // namespace PiRaTe
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cmath>
+
+#include "outlierdetector.h"
+
+namespace PiRaTe {
+
+constexpr double MAD_TO_SIGMA { 1.4826 }; //< ratio of standard deviation and MAD for normally distributed samples
+constexpr std::size_t MIN_OUTLIER_WINDOW { 16 };
+
+OutlierDetector::OutlierDetector(std::size_t window, double threshold)
+    : fWindow { std::clamp(window, MIN_OUTLIER_WINDOW, MAX_OUTLIER_WINDOW) }
+    , fThreshold { std::max(threshold, 0.) }
+{
+}
+
+auto OutlierDetector::process(double value) -> bool
+{
+    if (!isEnabled())
+        return false;
+    bool flagged { false };
+    // decide only when the window is at least half filled
+    if (fCount >= fWindow / 2) {
+        const double s { sigma() };
+        flagged = (s > 0. && std::abs(value - median()) > fThreshold * s);
+    }
+    insert(value);
+    return flagged;
+}
+
+void OutlierDetector::insert(double value)
+{
+    const auto sorted_end { fSorted.begin() + fCount };
+    if (fCount == fWindow) {
+        // remove the oldest sample from the sorted window
+        const double oldest { fHistory[fPos] };
+        const auto it { std::lower_bound(fSorted.begin(), sorted_end, oldest) };
+        std::copy(it + 1, sorted_end, it);
+        fCount--;
+    }
+    const auto new_end { fSorted.begin() + fCount };
+    const auto it { std::upper_bound(fSorted.begin(), new_end, value) };
+    std::copy_backward(it, new_end, new_end + 1);
+    *it = value;
+    fCount++;
+    fHistory[fPos] = value;
+    fPos = (fPos + 1) % fWindow;
+}
+
+auto OutlierDetector::median() const -> double
+{
+    if (fCount == 0)
+        return 0.;
+    if (fCount % 2)
+        return fSorted[fCount / 2];
+    return 0.5 * (fSorted[fCount / 2 - 1] + fSorted[fCount / 2]);
+}
+
+auto OutlierDetector::sigma() const -> double
+{
+    if (fCount < 2)
+        return 0.;
+    const double med { median() };
+    // the deviations grow monotonically to both sides of the median in the sorted window,
+    // so the median deviation is found by merging both sides up to the middle element
+    std::ptrdiff_t left { static_cast<std::ptrdiff_t>((fCount - 1) / 2) };
+    std::size_t right { fCount / 2 };
+    if (left == static_cast<std::ptrdiff_t>(right))
+        right++;
+    const std::size_t k { fCount / 2 };
+    double deviation { 0. };
+    double previous { 0. };
+    for (std::size_t i { 0 }; i <= k; ++i) {
+        previous = deviation;
+        const double dl { (left >= 0) ? med - fSorted[left] : INFINITY };
+        const double dr { (right < fCount) ? fSorted[right] - med : INFINITY };
+        if (dl <= dr) {
+            deviation = dl;
+            left--;
+        } else {
+            deviation = dr;
+            right++;
+        }
+    }
+    const double mad { (fCount % 2) ? deviation : 0.5 * (previous + deviation) };
+    return MAD_TO_SIGMA * mad;
+}
+
+void OutlierDetector::reset()
+{
+    fPos = fCount = 0;
+}
+
+} // namespace PiRaTe
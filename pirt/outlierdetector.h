@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace PiRaTe {
+
+constexpr std::size_t MAX_OUTLIER_WINDOW { 256 }; //< maximum length of the sliding window of the outlier detector
+constexpr std::size_t DEFAULT_OUTLIER_WINDOW { 64 }; //< default length of the sliding window in samples
+constexpr double DEFAULT_OUTLIER_THRESHOLD { 5. }; //< default flag threshold in units of the robust standard deviation
+
+/**
+ * @brief Streaming outlier detection with running median and MAD
+ * Each new sample is compared to the median of the preceding samples in a sliding window. The sample is flagged as
+ * outlier, if its deviation from the median exceeds the threshold in units of the robust standard deviation,
+ * which is estimated from the median absolute deviation (MAD) as sigma = 1.4826 * MAD.
+ * Since median and MAD are insensitive to the outliers themselves, flagged samples are kept in the window, such that
+ * a persistent level change is accepted after half a window length.
+ * The window is kept sorted, so that the median is found in constant time and the MAD by merging the deviations of
+ * both halves of the sorted window outward from the median. The cost per sample is linear in the window length
+ * without any allocation.
+ * @note The class is not thread-safe.
+ */
+class OutlierDetector {
+public:
+    /**
+    * @brief The main constructor.
+    * @param window length of the sliding window in samples
+    * @param threshold flag threshold in units of the robust standard deviation, 0 disables the flagging
+    */
+    explicit OutlierDetector(std::size_t window = DEFAULT_OUTLIER_WINDOW, double threshold = DEFAULT_OUTLIER_THRESHOLD);
+
+    /**
+    * @brief check a new sample and insert it into the window
+    * @return true, if the sample is flagged as outlier
+    */
+    auto process(double value) -> bool;
+    void reset();
+
+    [[nodiscard]] auto isEnabled() const -> bool { return (fThreshold > 0.); }
+    [[nodiscard]] auto window() const -> std::size_t { return fWindow; }
+    [[nodiscard]] auto threshold() const -> double { return fThreshold; }
+    /**
+    * @brief median of the current window
+    */
+    [[nodiscard]] auto median() const -> double;
+    /**
+    * @brief robust standard deviation of the current window (1.4826 * MAD)
+    */
+    [[nodiscard]] auto sigma() const -> double;
+
+private:
+    void insert(double value);
+
+    std::size_t fWindow { DEFAULT_OUTLIER_WINDOW };
+    double fThreshold { DEFAULT_OUTLIER_THRESHOLD };
+    std::array<double, MAX_OUTLIER_WINDOW> fHistory {}; ///<! samples in the order of arrival (ring)
+    std::array<double, MAX_OUTLIER_WINDOW> fSorted {}; ///<! the same samples in ascending order
+    std::size_t fPos { 0 };
+    std::size_t fCount { 0 };
+};
+
+} // namespace PiRaTe
@@ -16,6 +16,7 @@
 
 #include "indicom.h"
 
+#include <algorithm>
 #include <cmath>
 #include <map>
 #include <memory>
@@ -29,6 +30,7 @@
 #include "encoder.h"
 #include "gpioif.h"
 #include "motordriver.h"
+#include "servo.h"
 #include "config.h"
 
 #include "sysfspwm.hpp"
@@ -42,6 +44,7 @@ namespace Connection {
 constexpr char GPIO_CHIP_PATH[] {"/dev/gpiochip0"};
 
 constexpr unsigned int SSI_BAUD_RATE { 1'000'000 }; //< SPI baud rate for encoder read-out
+constexpr double DEFAULT_ENCODER_READ_RATE { 200. }; //< default read-out rate of the pos encoders in Hz, should exceed the servo rate
 constexpr char AZ_SPIDEV_PATH[] {"/dev/spidev0.0"};
 constexpr char ALT_SPIDEV_PATH[] {"/dev/spidev6.0"};
 
@@ -49,6 +52,7 @@ constexpr unsigned int POLL_INTERVAL_MS { 200 }; //< polling interval of this dr
 constexpr double DEFAULT_AZ_AXIS_TURNS_RATIO { 152. / 9. }; //< ratio between Az encoder revolutions and Az axis revolutions
 constexpr double DEFAULT_EL_AXIS_TURNS_RATIO { 1. }; //< ratio between Alt encoder revolutions and Alt axis revolutions
 constexpr double MAX_AZ_OVERTURN { 0.5 }; //< maximum overturn in Az in revolutions at both ends
+constexpr double AZ_LIMIT_MARGIN { 0.1 }; //< margin beyond the Az overturn in revolutions, at which all motion is stopped
 constexpr double ALT_LIMIT_LOW { 0.25 / 360. }; //< lower position limit Alt in revolutions
 constexpr double ALT_LIMIT_HI { 100. / 360. }; //< upper position limit in Alt in revolutions
 constexpr bool AZ_POS_DIR_INVERT { false }; //< invert helicity of Az axis
@@ -56,11 +60,18 @@ constexpr bool ALT_POS_DIR_INVERT { true }; //< invert helicity of Alt axis
 constexpr double DEFAULT_AZ_AXIS_OFFSET { -181.25 }; //< offset between Az encoder-axis zero and real world Az-axis zero
 constexpr double DEFAULT_ALT_AXIS_OFFSET { 0.64 }; //< offset between Alt encoder-axis zero and real world Alt-axis zero
 
-constexpr double POS_ACCURACY_COARSE { 4.0 }; //< coarse positioning accuracy threshold in degrees
-constexpr double POS_ACCURACY_FINE { 0.2 }; //< fine positioning accuracy threshold in degrees
 constexpr double TRACK_ACCURACY_AZ { 0.06 }; //< tracking accuracy for Az axis threshold in degrees
 constexpr double TRACK_ACCURACY_ALT { 0.04 }; //< tracking accuracy for Alt axis threshold in degrees
 
+constexpr double DEFAULT_SERVO_KP { 0.25 }; //< default proportional gain of the axis servos in 1/deg (full throttle at 4 deg error)
+constexpr double DEFAULT_SERVO_KI { 0.05 }; //< default integral gain of the axis servos in 1/(deg*s)
+constexpr double DEFAULT_SERVO_KD { 0. }; //< default velocity error gain of the axis servos in s/deg
+constexpr double DEFAULT_SERVO_KFF { 0.5 }; //< default velocity feed-forward gain in s/deg, approx. the inverse of the axis speed at full throttle
+constexpr double DEFAULT_AZ_MAX_VELOCITY { 1.8 }; //< default velocity limit of planned Az slews in deg/s
+constexpr double DEFAULT_ALT_MAX_VELOCITY { 1.8 }; //< default velocity limit of planned Alt slews in deg/s
+constexpr double DEFAULT_AZ_MAX_ACCELERATION { 2.4 }; //< default acceleration limit of planned Az slews in deg/s^2, compatible with the motor driver ramp
+constexpr double DEFAULT_ALT_MAX_ACCELERATION { 2.4 }; //< default acceleration limit of planned Alt slews in deg/s^2, compatible with the motor driver ramp
+
 constexpr unsigned int NR_SLEW_RATES { 5 }; //< number of slew speeds available for this scope
 
 constexpr double MIN_AZ_MOTOR_THROTTLE_DEFAULT { 0.04 }; //< minimum applicable motor throttle, Az motor
@@ -96,10 +107,33 @@ constexpr char I2C_DEV_PATH[] { "/dev/i2c-1" };
 
 constexpr std::uint8_t MOTOR_ADC_ADDR { 0x48 }; //< I2C address of ADS1115 ADC for motor current read-out
 constexpr std::uint8_t VOLTAGE_MONITOR_ADC_ADDR { 0x49 }; //< I2C address of ADS1115 ADC for voltage monitoring
+constexpr unsigned int MEASUREMENT_ADC_RDY_PIN { 4 }; //< GPIO input connected to the ALERT/RDY pin of the measurement ADC
 
 constexpr std::chrono::milliseconds DEFAULT_INT_TIME { 1000 };
-
-constexpr unsigned int MAX_TARGET_POINTING_IMPROVEMENT_TIME_MS { 250 };
+constexpr double DEFAULT_FILTER_RATE { 1. }; //< default output rate of the measurement filters in Hz
+constexpr double MIN_FILTER_RATE { 0.01 }; //< lowest output rate of the measurement filters in Hz, set up in a few ms at 860 SPS
+constexpr unsigned int DEFAULT_CIC_ORDER { 3 }; //< default nr. of stages of the CIC decimator of the measurement filters
+constexpr unsigned int DEFAULT_FIR_TAPS { 31 }; //< default nr. of taps of the CIC compensation filter
+constexpr unsigned int DEFAULT_MEDIAN_WIDTH { 0 }; //< default window of the median spike filter (0=off)
+constexpr unsigned int DEFAULT_ADC_MEAS_WEIGHT { 8 }; //< default nr. of ADC conversion slots per plan cycle for the measurement channels
+constexpr unsigned int DEFAULT_ADC_MOTOR_WEIGHT { 2 }; //< default nr. of ADC conversion slots per plan cycle for the motor currents
+constexpr unsigned int DEFAULT_ADC_MONITOR_WEIGHT { 1 }; //< default nr. of ADC conversion slots per plan cycle for the supply voltages
+constexpr std::size_t LOCKIN_REF_OUTPUT_INDEX { 4 }; //< index of the gpio output in GpioOutputVector, which is switched as lock-in reference (RefOut)
+constexpr std::size_t DEFAULT_CAL_OUTPUT_INDEX { 4 }; //< default index of the gpio output in GpioOutputVector, which switches the calibration source
+
+constexpr double DEFAULT_POSITION_PUBLISH_RATE { 0. }; //< default rate cap of the position properties in Hz (0=no cap)
+constexpr double DEFAULT_MOTOR_PUBLISH_RATE { 0. }; //< default rate cap of the motor and servo properties in Hz (0=no cap)
+constexpr double DEFAULT_MONITOR_PUBLISH_RATE { 1. }; //< default rate cap of the monitoring properties in Hz (0=no cap)
+constexpr double DEFAULT_PUBLISH_HEARTBEAT { 10. }; //< default maximum time between two publishings of a property in s (0=off)
+
+constexpr double DEFAULT_SCAN_STEP { 1.0 }; //< default step size of grid scans in degrees
+constexpr char DEFAULT_SCAN_FILE[] { "/tmp/rt_scan.txt" }; //< default output file of grid scans
+constexpr std::chrono::seconds POSITION_HISTORY_TIME { 2 }; //< time span of encoder positions kept for interpolation
+constexpr std::chrono::milliseconds MIN_SAMPLE_BUFFER_TIME { 1000 }; //< minimum length of the measurement buffers during OTF scans
+constexpr std::size_t RECORDER_QUEUE_SIZE { 32768 }; //< max. nr. of samples per channel queued for the data recorder (about 40 s at 860 SPS)
+constexpr char DEFAULT_RECORDER_FILE[] { "/tmp/rt_record.bin" }; //< default output file of the data recorder
+
+constexpr unsigned int MAX_TARGET_POINTING_IMPROVEMENT_TIME_MS { 250 }; //< time within the tracking accuracy before a slew is complete
 
 struct GpioPin {
     std::string name;
@@ -267,14 +301,20 @@ bool PiRT::initProperties()
     IUFillNumber(&AzEncoderN[2], "AZ_ENC_MT", "MT", "%5.0f", -32767, 32767, 0, 0);
     IUFillNumber(&AzEncoderN[3], "AZ_ENC_ERR", "Bit Errors", "%5.0f", 0, 0, 0, 0);
     IUFillNumber(&AzEncoderN[4], "AZ_ENC_ROTIME", "R/O Time", "%5.0f us", 0, 0, 0, 0);
-    IUFillNumberVector(&AzEncoderNP, AzEncoderN, 5, getDeviceName(), "AZ_ENC", "Azimuth", "Encoders",
+    IUFillNumber(&AzEncoderN[5], "AZ_ENC_JITTER", "Jitter (rms)", "%5.0f us", 0, 0, 0, 0);
+    IUFillNumber(&AzEncoderN[6], "AZ_ENC_JITTER_MAX", "Jitter (max)", "%5.0f us", 0, 0, 0, 0);
+    IUFillNumber(&AzEncoderN[7], "AZ_ENC_OVERRUNS", "Overruns", "%5.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&AzEncoderNP, AzEncoderN, 8, getDeviceName(), "AZ_ENC", "Azimuth", "Encoders",
         IP_RO, 60, IPS_IDLE);
     IUFillNumber(&ElEncoderN[0], "EL_ENC_POS", "Position", "%5.4f rev", -32767, 32767, 0, 0);
     IUFillNumber(&ElEncoderN[1], "EL_ENC_ST", "ST", "%5.0f", 0, 65535, 0, 3);
     IUFillNumber(&ElEncoderN[2], "EL_ENC_MT", "MT", "%5.0f", -32767, 32767, 0, 4);
     IUFillNumber(&ElEncoderN[3], "EL_ENC_ERR", "Bit Errors", "%5.0f", 0, 0, 0, 0);
     IUFillNumber(&ElEncoderN[4], "EL_ENC_ROTIME", "R/O Time", "%5.0f us", 0, 0, 0, 0);
-    IUFillNumberVector(&ElEncoderNP, ElEncoderN, 5, getDeviceName(), "EL_ENC", "Elevation", "Encoders",
+    IUFillNumber(&ElEncoderN[5], "EL_ENC_JITTER", "Jitter (rms)", "%5.0f us", 0, 0, 0, 0);
+    IUFillNumber(&ElEncoderN[6], "EL_ENC_JITTER_MAX", "Jitter (max)", "%5.0f us", 0, 0, 0, 0);
+    IUFillNumber(&ElEncoderN[7], "EL_ENC_OVERRUNS", "Overruns", "%5.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&ElEncoderNP, ElEncoderN, 8, getDeviceName(), "EL_ENC", "Elevation", "Encoders",
         IP_RO, 60, IPS_IDLE);
     IUFillNumber(&AzEncSettingN[0], "AZ_ENC_ST_BITS", "ST bits", "%5.0f", 0, 24, 0, 12);
     IUFillNumber(&AzEncSettingN[1], "AZ_ENC_MT_BITS", "MT bits", "%5.0f", 0, 24, 0, 12);
@@ -290,7 +330,27 @@ bool PiRT::initProperties()
     defineProperty(&ElEncSettingNP);
     IDSetNumber(&ElEncSettingNP, NULL);
 
-    double initval = DEFAULT_AZ_AXIS_TURNS_RATIO;
+    double initval = DEFAULT_ENCODER_READ_RATE;
+    if (IUGetConfigNumber(getDeviceName(), "ENC_READOUT", "ENC_READ_RATE", &initval)==0) {
+        DEBUGF(DBG_SCOPE, "Found config for ENC_READ_RATE: %5.1f", initval);
+    }
+    IUFillNumber(&EncoderReadoutN[0], "ENC_READ_RATE", "Read-out Rate", "%5.0f Hz", PiRaTe::MIN_READ_RATE, PiRaTe::MAX_READ_RATE, 0, initval);
+    initval = 0;
+    if (IUGetConfigNumber(getDeviceName(), "ENC_READOUT", "ENC_RT_PRIORITY", &initval)==0) {
+        DEBUGF(DBG_SCOPE, "Found config for ENC_RT_PRIORITY: %2.0f", initval);
+    }
+    IUFillNumber(&EncoderReadoutN[1], "ENC_RT_PRIORITY", "RT Priority (0=off)", "%2.0f", 0, 99, 1, initval);
+    initval = -1;
+    if (IUGetConfigNumber(getDeviceName(), "ENC_READOUT", "ENC_CPU", &initval)==0) {
+        DEBUGF(DBG_SCOPE, "Found config for ENC_CPU: %2.0f", initval);
+    }
+    IUFillNumber(&EncoderReadoutN[2], "ENC_CPU", "CPU (-1=any)", "%2.0f", -1, 63, 1, initval);
+    IUFillNumberVector(&EncoderReadoutNP, EncoderReadoutN, 3, getDeviceName(), "ENC_READOUT", "Read-out", "Encoders",
+        IP_RW, 60, IPS_IDLE);
+    defineProperty(&EncoderReadoutNP);
+    IDSetNumber(&EncoderReadoutNP, NULL);
+
+    initval = DEFAULT_AZ_AXIS_TURNS_RATIO;
     if (IUGetConfigNumber(getDeviceName(), "AZ_AXIS_SETTING", "AZ_AXIS_RATIO", &initval)==0) {
         DEBUGF(DBG_SCOPE, "Found config for AZ_AXIS_RATIO: %5.4f", initval);
     }
@@ -370,6 +430,48 @@ bool PiRT::initProperties()
     IUFillNumberVector(&MotorCurrentLimitNP, MotorCurrentLimitN, 2, getDeviceName(), "MOTOR_CURRENT_LIMITS", "Motor Current Limits", "Motors",
         IP_RW, 60, IPS_IDLE);
 
+    // fill a servo number element with the value stored in the config file, if present
+    auto fillServoNumber = [this](INumber* np, const char* property, const char* name, const char* label, const char* format, double min, double max, double value) {
+        if (IUGetConfigNumber(getDeviceName(), property, name, &value) == 0) {
+            DEBUGF(DBG_SCOPE, "Found config for %s: %g", name, value);
+        }
+        IUFillNumber(np, name, label, format, min, max, 0, value);
+    };
+    fillServoNumber(&AzServoGainN[0], "AZ_SERVO_GAINS", "AZ_SERVO_KP", "Kp", "%6.4f", 0., 100., DEFAULT_SERVO_KP);
+    fillServoNumber(&AzServoGainN[1], "AZ_SERVO_GAINS", "AZ_SERVO_KI", "Ki", "%6.4f", 0., 100., DEFAULT_SERVO_KI);
+    fillServoNumber(&AzServoGainN[2], "AZ_SERVO_GAINS", "AZ_SERVO_KD", "Kd", "%6.4f", 0., 100., DEFAULT_SERVO_KD);
+    fillServoNumber(&AzServoGainN[3], "AZ_SERVO_GAINS", "AZ_SERVO_KFF", "Kff", "%6.4f", 0., 100., DEFAULT_SERVO_KFF);
+    IUFillNumberVector(&AzServoGainNP, AzServoGainN, 4, getDeviceName(), "AZ_SERVO_GAINS", "Az Servo Gains", "Servo",
+        IP_RW, 60, IPS_IDLE);
+    fillServoNumber(&ElServoGainN[0], "EL_SERVO_GAINS", "EL_SERVO_KP", "Kp", "%6.4f", 0., 100., DEFAULT_SERVO_KP);
+    fillServoNumber(&ElServoGainN[1], "EL_SERVO_GAINS", "EL_SERVO_KI", "Ki", "%6.4f", 0., 100., DEFAULT_SERVO_KI);
+    fillServoNumber(&ElServoGainN[2], "EL_SERVO_GAINS", "EL_SERVO_KD", "Kd", "%6.4f", 0., 100., DEFAULT_SERVO_KD);
+    fillServoNumber(&ElServoGainN[3], "EL_SERVO_GAINS", "EL_SERVO_KFF", "Kff", "%6.4f", 0., 100., DEFAULT_SERVO_KFF);
+    IUFillNumberVector(&ElServoGainNP, ElServoGainN, 4, getDeviceName(), "EL_SERVO_GAINS", "El Servo Gains", "Servo",
+        IP_RW, 60, IPS_IDLE);
+    fillServoNumber(&ServoSettingN[0], "SERVO_SETTINGS", "SERVO_RATE", "Loop Rate", "%5.0f Hz", PiRaTe::MIN_SERVO_RATE, PiRaTe::MAX_SERVO_RATE, PiRaTe::DEFAULT_SERVO_RATE);
+    IUFillNumberVector(&ServoSettingNP, ServoSettingN, 1, getDeviceName(), "SERVO_SETTINGS", "Servo Settings", "Servo",
+        IP_RW, 60, IPS_IDLE);
+    fillServoNumber(&SlewLimitN[0], "SLEW_LIMITS", "AZ_MAX_VEL", "Az max. Velocity", "%5.2f deg/s", 0.01, 100., DEFAULT_AZ_MAX_VELOCITY);
+    fillServoNumber(&SlewLimitN[1], "SLEW_LIMITS", "AZ_MAX_ACC", "Az max. Acceleration", "%5.2f deg/s^2", 0.01, 100., DEFAULT_AZ_MAX_ACCELERATION);
+    fillServoNumber(&SlewLimitN[2], "SLEW_LIMITS", "EL_MAX_VEL", "El max. Velocity", "%5.2f deg/s", 0.01, 100., DEFAULT_ALT_MAX_VELOCITY);
+    fillServoNumber(&SlewLimitN[3], "SLEW_LIMITS", "EL_MAX_ACC", "El max. Acceleration", "%5.2f deg/s^2", 0.01, 100., DEFAULT_ALT_MAX_ACCELERATION);
+    IUFillNumberVector(&SlewLimitNP, SlewLimitN, 4, getDeviceName(), "SLEW_LIMITS", "Slew Limits", "Servo",
+        IP_RW, 60, IPS_IDLE);
+
+    IUFillNumber(&AzServoStatusN[0], "AZ_SERVO_ERR", "Error", "%6.4f deg", 0, 0, 0, 0);
+    IUFillNumber(&AzServoStatusN[1], "AZ_SERVO_ERR_RMS", "Error (rms)", "%6.4f deg", 0, 0, 0, 0);
+    IUFillNumber(&AzServoStatusN[2], "AZ_SERVO_ERR_MAX", "Error (max)", "%6.4f deg", 0, 0, 0, 0);
+    IUFillNumber(&AzServoStatusN[3], "AZ_SERVO_SETTLE", "Settle Time", "%5.2f s", 0, 0, 0, 0);
+    IUFillNumberVector(&AzServoStatusNP, AzServoStatusN, 4, getDeviceName(), "AZ_SERVO_STATUS", "Az Servo Status", "Servo",
+        IP_RO, 60, IPS_IDLE);
+    IUFillNumber(&ElServoStatusN[0], "EL_SERVO_ERR", "Error", "%6.4f deg", 0, 0, 0, 0);
+    IUFillNumber(&ElServoStatusN[1], "EL_SERVO_ERR_RMS", "Error (rms)", "%6.4f deg", 0, 0, 0, 0);
+    IUFillNumber(&ElServoStatusN[2], "EL_SERVO_ERR_MAX", "Error (max)", "%6.4f deg", 0, 0, 0, 0);
+    IUFillNumber(&ElServoStatusN[3], "EL_SERVO_SETTLE", "Settle Time", "%5.2f s", 0, 0, 0, 0);
+    IUFillNumberVector(&ElServoStatusNP, ElServoStatusN, 4, getDeviceName(), "EL_SERVO_STATUS", "El Servo Status", "Servo",
+        IP_RO, 60, IPS_IDLE);
+
     IUFillNumber(&VoltageMonitorN[0], "VOLTAGE", "+0V", "%4.2f V", 0, 0, 0, 0);
     IUFillNumberVector(&VoltageMonitorNP, VoltageMonitorN, 0, getDeviceName(), "VOLTAGE_MONITOR", "Voltages", "Monitoring",
         IP_RO, 60, IPS_IDLE);
@@ -377,9 +479,86 @@ bool PiRT::initProperties()
     IUFillNumber(&VoltageMeasurementN[0], "MEASUREMENT0", "+0V", "%4.2f V", 0, 0, 0, 0);
     IUFillNumberVector(&VoltageMeasurementNP, VoltageMeasurementN, 0, getDeviceName(), "MEASUREMENTS", "Measurements", "Monitoring",
         IP_RO, 60, IPS_IDLE);
+    IUFillNumber(&MeasurementStatsN[0], "MEASUREMENT0_STDDEV", "+0V stddev", "%4.2f V", 0, 0, 0, 0);
+    IUFillNumberVector(&MeasurementStatsNP, MeasurementStatsN, 0, getDeviceName(), "MEASUREMENT_STATS", "Measurement Statistics", "Monitoring",
+        IP_RO, 60, IPS_IDLE);
+    IUFillNumber(&FilteredMeasurementN[0], "FILTERED0", "+0V", "%4.2f V", 0, 0, 0, 0);
+    IUFillNumberVector(&FilteredMeasurementNP, FilteredMeasurementN, 0, getDeviceName(), "FILTERED_MEASUREMENTS", "Filtered Measurements", "Monitoring",
+        IP_RO, 60, IPS_IDLE);
+    IUFillNumber(&FilterSettingN[0], "FILTER_RATE", "Output Rate (0=off)", "%6.3f Hz", 0., 100., 0.1, DEFAULT_FILTER_RATE);
+    IUFillNumber(&FilterSettingN[1], "CIC_ORDER", "CIC Order", "%1.0f", 1, PiRaTe::MAX_CIC_ORDER, 1, DEFAULT_CIC_ORDER);
+    IUFillNumber(&FilterSettingN[2], "FIR_TAPS", "FIR Taps (0=off)", "%3.0f", 0, 255, 2, DEFAULT_FIR_TAPS);
+    IUFillNumber(&FilterSettingN[3], "MEDIAN_WIDTH", "Median Width (0=off)", "%2.0f", 0, PiRaTe::MAX_MEDIAN_WIDTH, 2, DEFAULT_MEDIAN_WIDTH);
+    IUFillNumberVector(&FilterSettingNP, FilterSettingN, 4, getDeviceName(), "MEASUREMENT_FILTER", "Measurement Filter", "Monitoring",
+        IP_RW, 60, IPS_IDLE);
+    IUFillNumber(&OutlierSettingN[0], "OUTLIER_WINDOW", "Window", "%3.0f samples", 16, PiRaTe::MAX_OUTLIER_WINDOW, 1, PiRaTe::DEFAULT_OUTLIER_WINDOW);
+    IUFillNumber(&OutlierSettingN[1], "OUTLIER_THRESHOLD", "Threshold (0=off)", "%4.1f sigma", 0., 100., 0.5, PiRaTe::DEFAULT_OUTLIER_THRESHOLD);
+    IUFillNumberVector(&OutlierSettingNP, OutlierSettingN, 2, getDeviceName(), "OUTLIER_FLAGGING", "Outlier Flagging", "Monitoring",
+        IP_RW, 60, IPS_IDLE);
+    IUFillNumber(&OutlierStatusN[0], "OUTLIERS0_TOTAL", "+0V flagged", "%8.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&OutlierStatusNP, OutlierStatusN, 0, getDeviceName(), "OUTLIER_STATUS", "Flagged Outliers", "Monitoring",
+        IP_RO, 60, IPS_IDLE);
     IUFillNumber(&MeasurementIntTimeN, "TIME", "time", "%5.2f s", 0.01, 1000., 0.1, DEFAULT_INT_TIME.count() / 1000.);
     IUFillNumberVector(&MeasurementIntTimeNP, &MeasurementIntTimeN, 1, getDeviceName(), "INT_TIME", "Integration Time", "Monitoring",
         IP_RW, 60, IPS_IDLE);
+    IUFillSwitch(&MeasurementModeS[MEAS_POLLED], "MEAS_POLLED", "Polled", ISS_ON);
+    IUFillSwitch(&MeasurementModeS[MEAS_CONTINUOUS], "MEAS_CONTINUOUS", "Continuous (ALERT/RDY)", ISS_OFF);
+    IUFillSwitchVector(&MeasurementModeSP, MeasurementModeS, 2, getDeviceName(), "MEASUREMENT_MODE", "Measurement Mode", "Monitoring",
+        IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+    IUFillNumber(&AdcScheduleN[ADC_GROUP_MEAS], "MEAS_WEIGHT", "Measurement Slots", "%3.0f", 0, 100, 1, DEFAULT_ADC_MEAS_WEIGHT);
+    IUFillNumber(&AdcScheduleN[ADC_GROUP_MOTOR], "MOTOR_WEIGHT", "Motor Current Slots", "%3.0f", 0, 100, 1, DEFAULT_ADC_MOTOR_WEIGHT);
+    IUFillNumber(&AdcScheduleN[ADC_GROUP_MONITOR], "MONITOR_WEIGHT", "Supply Voltage Slots", "%3.0f", 0, 100, 1, DEFAULT_ADC_MONITOR_WEIGHT);
+    IUFillNumber(&AdcScheduleN[3], "SLOT_PERIOD", "Slot Period", "%5.2f ms", 1.5, 100., 0.1, PiRaTe::DEFAULT_ADC_SLOT_PERIOD.count() / 1000.);
+    IUFillNumberVector(&AdcScheduleNP, AdcScheduleN, 4, getDeviceName(), "ADC_SCHEDULE", "ADC Schedule", "Monitoring",
+        IP_RW, 60, IPS_IDLE);
+    IUFillNumber(&AdcScheduleStatusN[0], "MEAS_RATE", "Measurement Rate", "%5.1f Hz", 0, 0, 0, 0);
+    IUFillNumber(&AdcScheduleStatusN[1], "JITTER_RMS", "Jitter (rms)", "%6.1f us", 0, 0, 0, 0);
+    IUFillNumber(&AdcScheduleStatusN[2], "OVERRUNS", "Overruns", "%6.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&AdcScheduleStatusNP, AdcScheduleStatusN, 3, getDeviceName(), "ADC_SCHEDULE_STATUS", "ADC Schedule Status", "Monitoring",
+        IP_RO, 60, IPS_IDLE);
+    IUFillNumber(&LockInSettingN[0], "LOCKIN_FREQUENCY", "Switching Frequency", "%6.2f Hz", PiRaTe::MIN_LOCKIN_FREQUENCY, PiRaTe::MAX_LOCKIN_FREQUENCY, 0.1, PiRaTe::DEFAULT_LOCKIN_FREQUENCY);
+    IUFillNumber(&LockInSettingN[1], "LOCKIN_BLANKING", "Blanking", "%5.0f ms", 0, 1000, 1, PiRaTe::DEFAULT_LOCKIN_BLANKING.count());
+    IUFillNumberVector(&LockInSettingNP, LockInSettingN, 2, getDeviceName(), "LOCKIN_SETTINGS", "Lock-In Settings", "Monitoring",
+        IP_RW, 60, IPS_IDLE);
+    IUFillSwitch(&LockInControlS[LOCKIN_START], "LOCKIN_START", "Start", ISS_OFF);
+    IUFillSwitch(&LockInControlS[LOCKIN_STOP], "LOCKIN_STOP", "Stop", ISS_ON);
+    IUFillSwitchVector(&LockInControlSP, LockInControlS, 2, getDeviceName(), "LOCKIN_CONTROL", "Lock-In Mode", "Monitoring",
+        IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+    IUFillNumber(&LockInResultN[0], "LOCKIN_ON", "ON", "%6.4f V", 0, 0, 0, 0);
+    IUFillNumber(&LockInResultN[1], "LOCKIN_OFF", "OFF", "%6.4f V", 0, 0, 0, 0);
+    IUFillNumber(&LockInResultN[2], "LOCKIN_DIFF", "ON-OFF", "%7.5f V", 0, 0, 0, 0);
+    IUFillNumber(&LockInResultN[3], "LOCKIN_DIFF_ERR", "ON-OFF error", "%7.5f V", 0, 0, 0, 0);
+    IUFillNumber(&LockInResultN[4], "LOCKIN_CYCLES", "Cycles", "%6.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&LockInResultNP, LockInResultN, 5, getDeviceName(), "LOCKIN_RESULT", "Lock-In Result", "Monitoring",
+        IP_RO, 60, IPS_IDLE);
+    IUFillNumber(&CalibrationSettingN[0], "CAL_INTERVAL", "Interval", "%5.0f s", 1, 86400, 1, PiRaTe::DEFAULT_CAL_INTERVAL.count());
+    IUFillNumber(&CalibrationSettingN[1], "CAL_DURATION", "Segment Length", "%5.1f s", 0.1, 600, 0.1, PiRaTe::DEFAULT_CAL_DURATION.count() / 1000.);
+    IUFillNumber(&CalibrationSettingN[2], "CAL_SETTLE", "Settling Time", "%5.0f ms", 0, 10000, 10, PiRaTe::DEFAULT_CAL_SETTLE_TIME.count());
+    IUFillNumber(&CalibrationSettingN[3], "CAL_TEMPERATURE", "Cal. Source Temp.", "%6.1f K", 0.1, 1e6, 1, PiRaTe::DEFAULT_CAL_TEMPERATURE);
+    IUFillNumber(&CalibrationSettingN[4], "CAL_OUTPUT", "Output Index", "%1.0f", 0, GpioOutputVector.size() - 1, 1, DEFAULT_CAL_OUTPUT_INDEX);
+    IUFillNumberVector(&CalibrationSettingNP, CalibrationSettingN, 5, getDeviceName(), "CALIBRATION_SETTINGS", "Calibration Settings", "Monitoring",
+        IP_RW, 60, IPS_IDLE);
+    IUFillSwitch(&CalibrationControlS[CAL_START], "CAL_START", "Start", ISS_OFF);
+    IUFillSwitch(&CalibrationControlS[CAL_STOP], "CAL_STOP", "Stop", ISS_ON);
+    IUFillSwitchVector(&CalibrationControlSP, CalibrationControlS, 2, getDeviceName(), "CALIBRATION_CONTROL", "Periodic Calibration", "Monitoring",
+        IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+    IUFillNumber(&CalibrationStatusN[0], "CAL_GAIN", "Gain (power/K)", "%10.4g", 0, 0, 0, 0);
+    IUFillNumber(&CalibrationStatusN[1], "CAL_TSYS", "Tsys", "%7.1f K", 0, 0, 0, 0);
+    IUFillNumber(&CalibrationStatusN[2], "CAL_COUNT", "Calibrations", "%6.0f", 0, 0, 0, 0);
+    IUFillNumber(&CalibrationStatusN[3], "CAL_AGE", "Last Calibration", "%7.0f s ago", 0, 0, 0, 0);
+    IUFillNumberVector(&CalibrationStatusNP, CalibrationStatusN, 4, getDeviceName(), "CALIBRATION_STATUS", "Calibration Status", "Monitoring",
+        IP_RO, 60, IPS_IDLE);
+    IUFillNumber(&PublishSettingN[PUBLISH_POSITION], "POSITION_RATE", "Position Rate (0=no cap)", "%5.1f Hz", 0, 100, 0.1, DEFAULT_POSITION_PUBLISH_RATE);
+    IUFillNumber(&PublishSettingN[PUBLISH_MOTOR], "MOTOR_RATE", "Motor Rate (0=no cap)", "%5.1f Hz", 0, 100, 0.1, DEFAULT_MOTOR_PUBLISH_RATE);
+    IUFillNumber(&PublishSettingN[PUBLISH_MONITOR], "MONITOR_RATE", "Monitoring Rate (0=no cap)", "%5.1f Hz", 0, 100, 0.1, DEFAULT_MONITOR_PUBLISH_RATE);
+    IUFillNumber(&PublishSettingN[3], "HEARTBEAT", "Heartbeat (0=off)", "%5.1f s", 0, 3600, 1, DEFAULT_PUBLISH_HEARTBEAT);
+    IUFillNumberVector(&PublishSettingNP, PublishSettingN, 4, getDeviceName(), "PUBLISH_SETTINGS", "Property Updates", "Options",
+        IP_RW, 60, IPS_IDLE);
+    IUFillNumber(&PublishStatusN[0], "PUBLISHED", "Sent", "%5.1f /s", 0, 0, 0, 0);
+    IUFillNumber(&PublishStatusN[1], "SUPPRESSED", "Suppressed", "%5.1f %%", 0, 0, 0, 0);
+    IUFillNumberVector(&PublishStatusNP, PublishStatusN, 2, getDeviceName(), "PUBLISH_STATUS", "Property Update Rate", "Options",
+        IP_RO, 60, IPS_IDLE);
+    applyPublishSettings();
 
     IUFillNumber(&TempMonitorN[0], "TEMP_SYSTEM", "CPU", "%4.2f °C", 0, 0, 0, 0);
     IUFillNumberVector(&TempMonitorNP, TempMonitorN, 0, getDeviceName(), "TEMPERATURE_MONITOR", "Temperatures", "Monitoring",
@@ -408,6 +587,66 @@ bool PiRT::initProperties()
     IUFillLightVector(&WeatherStatusNP, &WeatherStatusN, 1, getDeviceName(), "WEATHER_STATUS", "Status", "Monitoring",
         IPS_IDLE);
 
+    IUFillNumber(&ScanWindowN[0], "SCAN_MIN1", "Min Az/RA", "%7.4f", -360., 360., 0, 0.);
+    IUFillNumber(&ScanWindowN[1], "SCAN_MAX1", "Max Az/RA", "%7.4f", -360., 360., 0, 0.);
+    IUFillNumber(&ScanWindowN[2], "SCAN_MIN2", "Min Alt/Dec", "%7.4f", -90., 90., 0, 0.);
+    IUFillNumber(&ScanWindowN[3], "SCAN_MAX2", "Max Alt/Dec", "%7.4f", -90., 90., 0, 0.);
+    IUFillNumberVector(&ScanWindowNP, ScanWindowN, 4, getDeviceName(), "SCAN_WINDOW", "Scan Window", "Scan",
+        IP_RW, 60, IPS_IDLE);
+
+    initval = DEFAULT_SCAN_STEP;
+    if (IUGetConfigNumber(getDeviceName(), "SCAN_SETTINGS", "SCAN_STEP1", &initval)==0) {
+        DEBUGF(DBG_SCOPE, "Found config for SCAN_STEP1: %5.4f", initval);
+    }
+    IUFillNumber(&ScanSettingN[0], "SCAN_STEP1", "Step Az/RA", "%6.4f", 0.0001, 90., 0, initval);
+    initval = DEFAULT_SCAN_STEP;
+    if (IUGetConfigNumber(getDeviceName(), "SCAN_SETTINGS", "SCAN_STEP2", &initval)==0) {
+        DEBUGF(DBG_SCOPE, "Found config for SCAN_STEP2: %5.4f", initval);
+    }
+    IUFillNumber(&ScanSettingN[1], "SCAN_STEP2", "Step Alt/Dec", "%6.4f", 0.0001, 90., 0, initval);
+    initval = DEFAULT_INT_TIME.count() / 1000.;
+    if (IUGetConfigNumber(getDeviceName(), "SCAN_SETTINGS", "SCAN_INT_TIME", &initval)==0) {
+        DEBUGF(DBG_SCOPE, "Found config for SCAN_INT_TIME: %5.2f", initval);
+    }
+    IUFillNumber(&ScanSettingN[2], "SCAN_INT_TIME", "Int. Time", "%5.2f s", 0.01, 1000., 0.1, initval);
+    IUFillNumberVector(&ScanSettingNP, ScanSettingN, 3, getDeviceName(), "SCAN_SETTINGS", "Scan Settings", "Scan",
+        IP_RW, 60, IPS_IDLE);
+
+    IUFillText(&ScanFileT[0], "SCAN_FILENAME", "File", DEFAULT_SCAN_FILE);
+    IUFillTextVector(&ScanFileTP, ScanFileT, 1, getDeviceName(), "SCAN_FILE", "Scan Output", "Scan",
+        IP_RW, 60, IPS_IDLE);
+
+    IUFillSwitch(&ScanControlS[SCAN_HOR], "SCAN_HOR", "Hor. Scan", ISS_OFF);
+    IUFillSwitch(&ScanControlS[SCAN_EQU], "SCAN_EQU", "Equ. Scan", ISS_OFF);
+    IUFillSwitch(&ScanControlS[SCAN_STOP], "SCAN_STOP", "Stop", ISS_ON);
+    IUFillSwitchVector(&ScanControlSP, ScanControlS, 3, getDeviceName(), "SCAN_CONTROL", "Scan Control", "Scan",
+        IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
+    IUFillSwitch(&ScanModeS[SCAN_GRID], "SCAN_GRID", "Grid", ISS_ON);
+    IUFillSwitch(&ScanModeS[SCAN_OTF], "SCAN_OTF", "On-the-fly", ISS_OFF);
+    IUFillSwitchVector(&ScanModeSP, ScanModeS, 2, getDeviceName(), "SCAN_MODE", "Scan Mode", "Scan",
+        IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
+    IUFillNumber(&ScanStatusN[0], "SCAN_POINT", "Point", "%6.0f", 0, 0, 0, 0);
+    IUFillNumber(&ScanStatusN[1], "SCAN_POINTS", "Total", "%6.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&ScanStatusNP, ScanStatusN, 2, getDeviceName(), "SCAN_STATUS", "Scan Status", "Scan",
+        IP_RO, 60, IPS_IDLE);
+
+    IUFillText(&RecorderFileT[0], "RECORDER_FILENAME", "File", DEFAULT_RECORDER_FILE);
+    IUFillTextVector(&RecorderFileTP, RecorderFileT, 1, getDeviceName(), "RECORDER_FILE", "Recorder Output", "Recorder",
+        IP_RW, 60, IPS_IDLE);
+
+    IUFillSwitch(&RecorderControlS[RECORDER_START], "RECORDER_START", "Start", ISS_OFF);
+    IUFillSwitch(&RecorderControlS[RECORDER_STOP], "RECORDER_STOP", "Stop", ISS_ON);
+    IUFillSwitchVector(&RecorderControlSP, RecorderControlS, 2, getDeviceName(), "RECORDER_CONTROL", "Recorder Control", "Recorder",
+        IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
+    IUFillNumber(&RecorderStatusN[0], "RECORDER_SAMPLES", "Samples", "%10.0f", 0, 0, 0, 0);
+    IUFillNumber(&RecorderStatusN[1], "RECORDER_SIZE", "Size (MB)", "%8.2f", 0, 0, 0, 0);
+    IUFillNumber(&RecorderStatusN[2], "RECORDER_LOST", "Lost samples", "%10.0f", 0, 0, 0, 0);
+    IUFillNumberVector(&RecorderStatusNP, RecorderStatusN, 3, getDeviceName(), "RECORDER_STATUS", "Recorder Status", "Recorder",
+        IP_RO, 60, IPS_IDLE);
+
     addDebugControl();
     return true;
 }
@@ -441,15 +680,50 @@ bool PiRT::updateProperties()
         defineProperty(&MotorCurrentNP);
         defineProperty(&MotorThresholdNP);
         defineProperty(&MotorCurrentLimitNP);
+        defineProperty(&AzServoGainNP);
+        defineProperty(&ElServoGainNP);
+        defineProperty(&ServoSettingNP);
+        defineProperty(&SlewLimitNP);
+        defineProperty(&AzServoStatusNP);
+        defineProperty(&ElServoStatusNP);
         defineProperty(&VoltageMonitorNP);
         defineProperty(&VoltageMeasurementNP);
+        defineProperty(&MeasurementStatsNP);
+        defineProperty(&FilteredMeasurementNP);
+        defineProperty(&FilterSettingNP);
+        defineProperty(&OutlierSettingNP);
+        defineProperty(&OutlierStatusNP);
         defineProperty(&MeasurementIntTimeNP);
+        defineProperty(&MeasurementModeSP);
+        defineProperty(&AdcScheduleNP);
+        defineProperty(&AdcScheduleStatusNP);
+        defineProperty(&LockInSettingNP);
+        defineProperty(&LockInControlSP);
+        defineProperty(&LockInResultNP);
+        defineProperty(&CalibrationSettingNP);
+        defineProperty(&CalibrationControlSP);
+        defineProperty(&CalibrationStatusNP);
+        defineProperty(&PublishSettingNP);
+        defineProperty(&PublishStatusNP);
+        // send all status properties with the next poll
+        publisher.invalidate();
         defineProperty(&TempMonitorNP);
         defineProperty(&DriverUpTimeNP);
 
         defineProperty(&OutputSwitchSP);
         defineProperty(&GpioInputLP);
 
+        defineProperty(&ScanWindowNP);
+        defineProperty(&ScanSettingNP);
+        defineProperty(&ScanFileTP);
+        defineProperty(&ScanModeSP);
+        defineProperty(&ScanControlSP);
+        defineProperty(&ScanStatusNP);
+
+        defineProperty(&RecorderFileTP);
+        defineProperty(&RecorderControlSP);
+        defineProperty(&RecorderStatusNP);
+
         IDSnoopDevice("Weather Watcher", "WEATHER_STATUS");
     } else {
         deleteProperty(ScopeStatusLP.name);
@@ -470,14 +744,47 @@ bool PiRT::updateProperties()
         deleteProperty(MotorCurrentNP.name);
         deleteProperty(MotorThresholdNP.name);
         deleteProperty(MotorCurrentLimitNP.name);
+        deleteProperty(AzServoGainNP.name);
+        deleteProperty(ElServoGainNP.name);
+        deleteProperty(ServoSettingNP.name);
+        deleteProperty(SlewLimitNP.name);
+        deleteProperty(AzServoStatusNP.name);
+        deleteProperty(ElServoStatusNP.name);
         deleteProperty(VoltageMonitorNP.name);
         deleteProperty(VoltageMeasurementNP.name);
+        deleteProperty(MeasurementStatsNP.name);
+        deleteProperty(FilteredMeasurementNP.name);
+        deleteProperty(FilterSettingNP.name);
+        deleteProperty(OutlierSettingNP.name);
+        deleteProperty(OutlierStatusNP.name);
         deleteProperty(MeasurementIntTimeNP.name);
+        deleteProperty(MeasurementModeSP.name);
+        deleteProperty(AdcScheduleNP.name);
+        deleteProperty(AdcScheduleStatusNP.name);
+        deleteProperty(LockInSettingNP.name);
+        deleteProperty(LockInControlSP.name);
+        deleteProperty(LockInResultNP.name);
+        deleteProperty(CalibrationSettingNP.name);
+        deleteProperty(CalibrationControlSP.name);
+        deleteProperty(CalibrationStatusNP.name);
+        deleteProperty(PublishSettingNP.name);
+        deleteProperty(PublishStatusNP.name);
         deleteProperty(TempMonitorNP.name);
         deleteProperty(DriverUpTimeNP.name);
 
         deleteProperty(OutputSwitchSP.name);
         deleteProperty(GpioInputLP.name);
+
+        deleteProperty(ScanWindowNP.name);
+        deleteProperty(ScanSettingNP.name);
+        deleteProperty(ScanFileTP.name);
+        deleteProperty(ScanModeSP.name);
+        deleteProperty(ScanControlSP.name);
+        deleteProperty(ScanStatusNP.name);
+
+        deleteProperty(RecorderFileTP.name);
+        deleteProperty(RecorderControlSP.name);
+        deleteProperty(RecorderStatusNP.name);
     }
 
     return true;
@@ -498,6 +805,13 @@ bool PiRT::ISNewSwitch(const char* dev, const char* name, ISState* states, char*
                 ISwitch* sw = IUFindSwitch(&OutputSwitchSP, names[index]);
                 if (sw != nullptr) {
                     std::size_t sw_pos = std::distance(OutputSwitchS, sw);
+                    if (isOutputInUse(sw_pos)) {
+                        // the output is owned by the lock-in detector or the calibration while they are running
+                        if (states[index] != sw->s)
+                            DEBUGF(INDI::Logger::DBG_WARNING, "Output %s is in use by lock-in or calibration - it can not be switched manually.", GpioOutputVector[sw_pos].name.c_str());
+                        states[index] = sw->s;
+                        continue;
+                    }
                     if (sw->s != states[index]) {
                         tempstr += std::to_string(index + 1);
                         if (states[index] == ISS_ON) {
@@ -516,6 +830,98 @@ bool PiRT::ISNewSwitch(const char* dev, const char* name, ISState* states, char*
             IUUpdateSwitch(&OutputSwitchSP, states, names, n);
             IDSetSwitch(&OutputSwitchSP, tempstr.c_str());
             return true;
+        } else if (!strcmp(name, ScanControlSP.name)) {
+            // start or stop a grid scan
+            IUUpdateSwitch(&ScanControlSP, states, names, n);
+            const int index = IUFindOnSwitchIndex(&ScanControlSP);
+            if (index == SCAN_HOR || index == SCAN_EQU) {
+                if (!startScan((index == SCAN_HOR) ? PiRaTe::ScanEngine::CoordSystem::Horizontal : PiRaTe::ScanEngine::CoordSystem::Equatorial)) {
+                    IUResetSwitch(&ScanControlSP);
+                    ScanControlS[SCAN_STOP].s = ISS_ON;
+                    ScanControlSP.s = IPS_ALERT;
+                    IDSetSwitch(&ScanControlSP, nullptr);
+                    return false;
+                }
+            } else {
+                stopScan();
+            }
+            return true;
+        } else if (!strcmp(name, RecorderControlSP.name)) {
+            // start or stop the data recorder
+            IUUpdateSwitch(&RecorderControlSP, states, names, n);
+            if (IUFindOnSwitchIndex(&RecorderControlSP) == RECORDER_START) {
+                if (!startRecorder()) {
+                    IUResetSwitch(&RecorderControlSP);
+                    RecorderControlS[RECORDER_STOP].s = ISS_ON;
+                    RecorderControlSP.s = IPS_ALERT;
+                    IDSetSwitch(&RecorderControlSP, nullptr);
+                    return false;
+                }
+            } else {
+                stopRecorder();
+            }
+            return true;
+        } else if (!strcmp(name, LockInControlSP.name)) {
+            // start or stop the synchronous detection with the switched reference output
+            IUUpdateSwitch(&LockInControlSP, states, names, n);
+            if (IUFindOnSwitchIndex(&LockInControlSP) == LOCKIN_START) {
+                if (!startLockIn()) {
+                    IUResetSwitch(&LockInControlSP);
+                    LockInControlS[LOCKIN_STOP].s = ISS_ON;
+                    LockInControlSP.s = IPS_ALERT;
+                    IDSetSwitch(&LockInControlSP, nullptr);
+                    return false;
+                }
+            } else {
+                stopLockIn();
+            }
+            return true;
+        } else if (!strcmp(name, CalibrationControlSP.name)) {
+            // start or stop the periodic calibration
+            IUUpdateSwitch(&CalibrationControlSP, states, names, n);
+            if (IUFindOnSwitchIndex(&CalibrationControlSP) == CAL_START) {
+                if (!startCalibration()) {
+                    IUResetSwitch(&CalibrationControlSP);
+                    CalibrationControlS[CAL_STOP].s = ISS_ON;
+                    CalibrationControlSP.s = IPS_ALERT;
+                    IDSetSwitch(&CalibrationControlSP, nullptr);
+                    return false;
+                }
+            } else {
+                stopCalibration();
+            }
+            return true;
+        } else if (!strcmp(name, MeasurementModeSP.name)) {
+            // select polled single-shot or interrupt-driven continuous conversions of the first measurement channel
+            IUUpdateSwitch(&MeasurementModeSP, states, names, n);
+            if (!applyMeasurementMode(MeasurementModeS[MEAS_CONTINUOUS].s == ISS_ON)) {
+                // fall back to polled conversions
+                applyMeasurementMode(false);
+                IUResetSwitch(&MeasurementModeSP);
+                MeasurementModeS[MEAS_POLLED].s = ISS_ON;
+                MeasurementModeSP.s = IPS_ALERT;
+                IDSetSwitch(&MeasurementModeSP, nullptr);
+                return false;
+            }
+            MeasurementModeSP.s = IPS_OK;
+            IDSetSwitch(&MeasurementModeSP, nullptr);
+            return true;
+        } else if (!strcmp(name, ScanModeSP.name)) {
+            // select stop-and-stare grid or on-the-fly scanning
+            if (scanEngine.isActive()) {
+                DEBUG(INDI::Logger::DBG_WARNING, "Scan in progress - scan mode can not be changed.");
+                ScanModeSP.s = IPS_ALERT;
+                IDSetSwitch(&ScanModeSP, nullptr);
+                return false;
+            }
+            IUUpdateSwitch(&ScanModeSP, states, names, n);
+            ScanModeSP.s = IPS_OK;
+            IDSetSwitch(&ScanModeSP, nullptr);
+            return true;
+        } else if (!strcmp(name, AbortSP.name)) {
+            // an explicit abort from the client terminates a running scan as well
+            if (scanEngine.isActive())
+                stopScan();
         }
     }
     //  Nobody has claimed this, so forward it to the base class's method
@@ -594,6 +1000,94 @@ bool PiRT::ISNewNumber(const char* dev, const char* name, double values[], char*
                 ElEncSettingNP.s = IPS_ALERT;
                 return false;
             }
+        } else if (!strcmp(name, EncoderReadoutNP.name)) {
+            // set encoder read-out rate and real-time scheduling options
+            if (IUUpdateNumber(&EncoderReadoutNP, values, names, n) < 0) {
+                EncoderReadoutNP.s = IPS_ALERT;
+                IDSetNumber(&EncoderReadoutNP, nullptr);
+                return false;
+            }
+            EncoderReadoutNP.s = IPS_OK;
+            if (isConnected())
+                applyEncoderReadoutSettings();
+            IDSetNumber(&EncoderReadoutNP, nullptr);
+            return true;
+        } else if (!strcmp(name, LockInSettingNP.name)) {
+            // set up the switching of the lock-in reference, a running detection is restarted with the new settings
+            if (IUUpdateNumber(&LockInSettingNP, values, names, n) < 0) {
+                LockInSettingNP.s = IPS_ALERT;
+                IDSetNumber(&LockInSettingNP, nullptr);
+                return false;
+            }
+            LockInSettingNP.s = IPS_OK;
+            IDSetNumber(&LockInSettingNP, nullptr);
+            if (lockIn != nullptr && lockIn->isActive())
+                startLockIn();
+            return true;
+        } else if (!strcmp(name, CalibrationSettingNP.name)) {
+            // set up the periodic calibration, the settings are applied with the next start
+            if (calibration != nullptr && calibration->isActive()) {
+                DEBUG(INDI::Logger::DBG_WARNING, "Calibration in progress - settings can not be changed.");
+                CalibrationSettingNP.s = IPS_ALERT;
+                IDSetNumber(&CalibrationSettingNP, nullptr);
+                return false;
+            }
+            if (IUUpdateNumber(&CalibrationSettingNP, values, names, n) < 0) {
+                CalibrationSettingNP.s = IPS_ALERT;
+                IDSetNumber(&CalibrationSettingNP, nullptr);
+                return false;
+            }
+            CalibrationSettingNP.s = IPS_OK;
+            IDSetNumber(&CalibrationSettingNP, nullptr);
+            return true;
+        } else if (!strcmp(name, PublishSettingNP.name)) {
+            // set up the rate caps and the heartbeat of the status properties
+            if (IUUpdateNumber(&PublishSettingNP, values, names, n) < 0) {
+                PublishSettingNP.s = IPS_ALERT;
+                IDSetNumber(&PublishSettingNP, nullptr);
+                return false;
+            }
+            PublishSettingNP.s = IPS_OK;
+            applyPublishSettings();
+            IDSetNumber(&PublishSettingNP, nullptr);
+            return true;
+        } else if (!strcmp(name, OutlierSettingNP.name)) {
+            // set up the outlier flagging of the measurement channels
+            if (IUUpdateNumber(&OutlierSettingNP, values, names, n) < 0) {
+                OutlierSettingNP.s = IPS_ALERT;
+                IDSetNumber(&OutlierSettingNP, nullptr);
+                return false;
+            }
+            OutlierSettingNP.s = IPS_OK;
+            applyOutlierSettings();
+            IDSetNumber(&OutlierSettingNP, nullptr);
+            return true;
+        } else if (!strcmp(name, FilterSettingNP.name)) {
+            // set up the decimating filters of the measurement channels
+            if (IUUpdateNumber(&FilterSettingNP, values, names, n) < 0) {
+                FilterSettingNP.s = IPS_ALERT;
+                IDSetNumber(&FilterSettingNP, nullptr);
+                return false;
+            }
+            if (FilterSettingN[0].value > 0. && FilterSettingN[0].value < MIN_FILTER_RATE) {
+                DEBUGF(INDI::Logger::DBG_WARNING, "Filter output rate below %4.2f Hz not supported, using %4.2f Hz.", MIN_FILTER_RATE, MIN_FILTER_RATE);
+                FilterSettingN[0].value = MIN_FILTER_RATE;
+            }
+            FilterSettingNP.s = IPS_OK;
+            applyFilterSettings();
+            IDSetNumber(&FilterSettingNP, nullptr);
+            return true;
+        } else if (!strcmp(name, AdcScheduleNP.name)) {
+            // set the slot weights and the slot period of the ADC conversion plan
+            if (IUUpdateNumber(&AdcScheduleNP, values, names, n) < 0) {
+                AdcScheduleNP.s = IPS_ALERT;
+                IDSetNumber(&AdcScheduleNP, nullptr);
+                return false;
+            }
+            AdcScheduleNP.s = IPS_OK;
+            applyAdcScheduleSettings();
+            IDSetNumber(&AdcScheduleNP, nullptr);
+            return true;
         } else if (!strcmp(name, AzAxisSettingNP.name)) {
             // Az axis settings: encoder-to-axis turns ratio and offset
             AzAxisSettingNP.s = IPS_OK;
@@ -604,6 +1098,7 @@ bool PiRT::ISNewNumber(const char* dev, const char* name, double values[], char*
             axisOffset[0] = values[1];
             DEBUGF(DBG_SCOPE, "Setting Az axis turns ratio to %5.4f rev.", axisRatio[0]);
             DEBUGF(DBG_SCOPE, "Setting Az axis offset %5.4f rev.", axisOffset[0]);
+            applyServoSettings();
             return true;
         } else if (!strcmp(name, ElAxisSettingNP.name)) {
             // El axis settings: encoder-to-axis turns ratio and offset
@@ -615,6 +1110,7 @@ bool PiRT::ISNewNumber(const char* dev, const char* name, double values[], char*
             axisOffset[1] = values[1];
             DEBUGF(DBG_SCOPE, "Setting El axis turns ratio to %5.4f rev.", axisRatio[1]);
             DEBUGF(DBG_SCOPE, "Setting El axis offset %5.4f rev.", axisOffset[1]);
+            applyServoSettings();
         } else if (!strcmp(name, MotorCurrentLimitNP.name)) {
             // set motor current limit
             bool success { true };
@@ -631,6 +1127,7 @@ bool PiRT::ISNewNumber(const char* dev, const char* name, double values[], char*
             if (!success) {
                 MotorCurrentLimitNP.s = IPS_ALERT;
             } else MotorCurrentLimitNP.s = IPS_OK;
+            applyControlSettings();
             IDSetNumber(&MotorCurrentLimitNP, nullptr);
         } else if (!strcmp(name, MotorThresholdNP.name)) {
             // set motor thresholds
@@ -649,12 +1146,57 @@ bool PiRT::ISNewNumber(const char* dev, const char* name, double values[], char*
                 MotorThresholdNP.s = IPS_ALERT;
             } else MotorThresholdNP.s = IPS_OK;
             IDSetNumber(&MotorThresholdNP, nullptr);
+            applyServoSettings();
+        } else if (!strcmp(name, AzServoGainNP.name) || !strcmp(name, ElServoGainNP.name) || !strcmp(name, ServoSettingNP.name)) {
+            // set servo gains and loop rate
+            INumberVectorProperty* nvp { (!strcmp(name, AzServoGainNP.name)) ? &AzServoGainNP : (!strcmp(name, ElServoGainNP.name)) ? &ElServoGainNP : &ServoSettingNP };
+            if (IUUpdateNumber(nvp, values, names, n) < 0) {
+                nvp->s = IPS_ALERT;
+                IDSetNumber(nvp, nullptr);
+                return false;
+            }
+            nvp->s = IPS_OK;
+            applyServoSettings();
+            IDSetNumber(nvp, nullptr);
+            return true;
+        } else if (!strcmp(name, SlewLimitNP.name)) {
+            // set velocity and acceleration limits of the slew planner
+            if (IUUpdateNumber(&SlewLimitNP, values, names, n) < 0) {
+                SlewLimitNP.s = IPS_ALERT;
+                IDSetNumber(&SlewLimitNP, nullptr);
+                return false;
+            }
+            SlewLimitNP.s = IPS_OK;
+            applyControlSettings();
+            IDSetNumber(&SlewLimitNP, nullptr);
+            return true;
+        } else if (!strcmp(name, ScanWindowNP.name)) {
+            // set the boundaries of the scan window
+            if (IUUpdateNumber(&ScanWindowNP, values, names, n) < 0 || ScanWindowN[2].value > ScanWindowN[3].value) {
+                ScanWindowNP.s = IPS_ALERT;
+                IDSetNumber(&ScanWindowNP, nullptr);
+                return false;
+            }
+            ScanWindowNP.s = IPS_OK;
+            IDSetNumber(&ScanWindowNP, nullptr);
+            return true;
+        } else if (!strcmp(name, ScanSettingNP.name)) {
+            // set the step sizes and the integration time of the scan
+            if (IUUpdateNumber(&ScanSettingNP, values, names, n) < 0) {
+                ScanSettingNP.s = IPS_ALERT;
+                IDSetNumber(&ScanSettingNP, nullptr);
+                return false;
+            }
+            ScanSettingNP.s = IPS_OK;
+            IDSetNumber(&ScanSettingNP, nullptr);
+            return true;
         } else if (!strcmp(name, MeasurementIntTimeNP.name)) {
             if (!voltageMeasurements.empty() && values[0] > 0. && values[0] < 1000.) {
+                const double int_time { values[0] };
                 for (auto meas : voltageMeasurements) {
-                    meas->setIntTime(std::chrono::milliseconds(static_cast<long int>(values[0] * 1000)));
+                    meas->setIntTime(std::chrono::milliseconds(static_cast<long int>(int_time * 1000)));
                 }
-                MeasurementIntTimeN.value = values[0];
+                MeasurementIntTimeN.value = int_time;
                 IDSetNumber(&MeasurementIntTimeNP, nullptr);
                 MeasurementIntTimeNP.s = IPS_OK;
                 return true;
@@ -668,6 +1210,39 @@ bool PiRT::ISNewNumber(const char* dev, const char* name, double values[], char*
     return INDI::Telescope::ISNewNumber(dev, name, values, names, n);
 }
 
+bool PiRT::ISNewText(const char* dev, const char* name, char* texts[], char* names[], int n)
+{
+    if (strcmp(dev, getDeviceName()) == 0) {
+        if (!strcmp(name, ScanFileTP.name)) {
+            // set the output file for grid scans
+            if (scanEngine.isActive()) {
+                DEBUG(INDI::Logger::DBG_WARNING, "Scan in progress - output file can not be changed.");
+                ScanFileTP.s = IPS_ALERT;
+                IDSetText(&ScanFileTP, nullptr);
+                return false;
+            }
+            IUUpdateText(&ScanFileTP, texts, names, n);
+            ScanFileTP.s = IPS_OK;
+            IDSetText(&ScanFileTP, nullptr);
+            return true;
+        } else if (!strcmp(name, RecorderFileTP.name)) {
+            // set the output file of the data recorder
+            if (recorder.isActive()) {
+                DEBUG(INDI::Logger::DBG_WARNING, "Recording in progress - output file can not be changed.");
+                RecorderFileTP.s = IPS_ALERT;
+                IDSetText(&RecorderFileTP, nullptr);
+                return false;
+            }
+            IUUpdateText(&RecorderFileTP, texts, names, n);
+            RecorderFileTP.s = IPS_OK;
+            IDSetText(&RecorderFileTP, nullptr);
+            return true;
+        }
+    }
+    //  Nobody has claimed this, so forward it to the base class method
+    return INDI::Telescope::ISNewText(dev, name, texts, names, n);
+}
+
 bool PiRT::ISSnoopDevice(XMLEle* root)
 {
     char *dev, *name;
@@ -692,9 +1267,25 @@ bool PiRT::saveConfigItems(FILE *fp) {
     // Save custom setting
     IUSaveConfigNumber(fp, &MotorCurrentLimitNP);
     IUSaveConfigNumber(fp, &MotorThresholdNP);
+    IUSaveConfigNumber(fp, &AzServoGainNP);
+    IUSaveConfigNumber(fp, &ElServoGainNP);
+    IUSaveConfigNumber(fp, &ServoSettingNP);
+    IUSaveConfigNumber(fp, &SlewLimitNP);
     IUSaveConfigNumber(fp, &EncoderBitRateNP);
+    IUSaveConfigNumber(fp, &EncoderReadoutNP);
     IUSaveConfigNumber(fp, &AzAxisSettingNP);
     IUSaveConfigNumber(fp, &ElAxisSettingNP);
+    IUSaveConfigNumber(fp, &ScanSettingNP);
+    IUSaveConfigSwitch(fp, &ScanModeSP);
+    IUSaveConfigSwitch(fp, &MeasurementModeSP);
+    IUSaveConfigNumber(fp, &AdcScheduleNP);
+    IUSaveConfigNumber(fp, &FilterSettingNP);
+    IUSaveConfigNumber(fp, &OutlierSettingNP);
+    IUSaveConfigNumber(fp, &LockInSettingNP);
+    IUSaveConfigNumber(fp, &CalibrationSettingNP);
+    IUSaveConfigNumber(fp, &PublishSettingNP);
+    IUSaveConfigText(fp, &ScanFileTP);
+    IUSaveConfigText(fp, &RecorderFileTP);
     // Save base telescope config
     return INDI::Telescope::saveConfigItems(fp);
 }
@@ -741,7 +1332,7 @@ bool PiRT::Park()
     // Inform client we are slewing to a new position
     DEBUGF(INDI::Logger::DBG_SESSION, "Slewing to Park Pos ( Az: %s - Alt: %s )", AzStr, AltStr);
 
-    return true;
+    return sendMotion(PiRaTe::MountController::Command::Type::Slew);
 }
 
 bool PiRT::UnPark()
@@ -776,6 +1367,11 @@ bool PiRT::Connect()
     // before instantiating a new GPIO interface, all objects which carry a reference
     // to the old gpio object must be invalidated, to make sure
     // that noone else uses the shared_ptr<GPIO> when it is newly created
+    adcScheduler.reset();
+    mountControl.reset();
+    azServo.reset();
+    elServo.reset();
+    encoderGroup.reset();
     az_encoder.reset();
     el_encoder.reset();
     az_motor.reset();
@@ -784,6 +1380,9 @@ bool PiRT::Connect()
     i2cDeviceMap.clear();
     voltageMonitors.clear();
     voltageMeasurements.clear();
+    azPositionHistory.clear();
+    elPositionHistory.clear();
+    azEncoderOverruns = elEncoderOverruns = 0;
 
     gpio = std::make_shared<PiRaTe::Gpio>(GPIO_CHIP_PATH);
     if (!gpio || !gpio->is_initialised()) {
@@ -799,7 +1398,8 @@ bool PiRT::Connect()
     }
 
     // initialize Az pos encoder connected to the main SPI interface
-    az_encoder = std::make_unique<PiRaTe::SsiPosEncoder>(std::string(AZ_SPIDEV_PATH), bitrate, PiRaTe::spi_device::MODE::MODE3);
+    // both encoders are read out synchronously by the encoder group, so they don't run their own thread loops
+    az_encoder = std::make_unique<PiRaTe::SsiPosEncoder>(std::string(AZ_SPIDEV_PATH), bitrate, PiRaTe::spi_device::MODE::MODE3, false);
     if (!az_encoder || !az_encoder->isInitialized()) {
         DEBUGF(INDI::Logger::DBG_ERROR, "Failed to connect to Az position encoder at %s", AZ_SPIDEV_PATH);
         return false;
@@ -810,7 +1410,7 @@ bool PiRT::Connect()
     az_encoder->setMtBitWidth(AzEncSettingN[1].value);
 
     // initialize Alt pos encoder connected to the aux SPI interface
-    el_encoder = std::make_unique<PiRaTe::SsiPosEncoder>(std::string(ALT_SPIDEV_PATH), bitrate, PiRaTe::spi_device::MODE::MODE3);
+    el_encoder = std::make_unique<PiRaTe::SsiPosEncoder>(std::string(ALT_SPIDEV_PATH), bitrate, PiRaTe::spi_device::MODE::MODE3, false);
     if (!el_encoder || !el_encoder->isInitialized()) {
         DEBUGF(INDI::Logger::DBG_ERROR, "Failed to connect to Alt position encoder at %s", ALT_SPIDEV_PATH);
         return false;
@@ -818,6 +1418,8 @@ bool PiRT::Connect()
     DEBUG(INDI::Logger::DBG_SESSION, "Alt position encoder ok.");
     el_encoder->setStBitWidth(ElEncSettingN[0].value);
     el_encoder->setMtBitWidth(ElEncSettingN[1].value);
+    encoderGroup = std::make_unique<PiRaTe::SsiEncoderGroup>(std::vector<PiRaTe::SsiPosEncoder*> { az_encoder.get(), el_encoder.get() }, EncoderReadoutN[0].value);
+    applyEncoderReadoutSettings();
 
     // search for the ADS1115 ADCs at the specified addresses and initialize them
     // instantiate the first ADS1115 foreseen to read back the motor currents
@@ -878,6 +1480,33 @@ bool PiRT::Connect()
         return false;
     }
 
+    // all conversions on the ADCs are triggered by the scheduler, the motor drivers, monitors and measurements
+    // only receive the results
+    adcScheduler = std::make_unique<PiRaTe::AdcScheduler>(std::chrono::microseconds(static_cast<long>(AdcScheduleN[3].value * 1000)));
+    adcScheduler->addGroup(static_cast<unsigned int>(AdcScheduleN[ADC_GROUP_MEAS].value));
+    adcScheduler->addGroup(static_cast<unsigned int>(AdcScheduleN[ADC_GROUP_MOTOR].value));
+    adcScheduler->addGroup(static_cast<unsigned int>(AdcScheduleN[ADC_GROUP_MONITOR].value));
+    for (auto motor : { az_motor.get(), el_motor.get() }) {
+        if (!motor->hasAdc())
+            continue;
+        motor->setExternalReadout(true);
+        adcScheduler->addChannel(ADC_GROUP_MOTOR, motor->adc(), motor->adcChannel(), [motor](std::chrono::time_point<std::chrono::system_clock>, double voltage) {
+            motor->processCurrentReadout(voltage);
+        });
+    }
+
+    // set up the closed-loop servos of both axes
+    azServo = std::make_unique<PiRaTe::AxisServo>(az_motor.get(), az_encoder.get(), ServoSettingN[0].value);
+    elServo = std::make_unique<PiRaTe::AxisServo>(el_motor.get(), el_encoder.get(), ServoSettingN[0].value);
+
+    // the mount control loop takes all motion decisions independent of the poll cycle of the driver
+    mountControl = std::make_unique<PiRaTe::MountController>(
+        std::array<PiRaTe::SsiPosEncoder*, 2> { az_encoder.get(), el_encoder.get() },
+        std::array<PiRaTe::MotorDriver*, 2> { az_motor.get(), el_motor.get() },
+        std::array<PiRaTe::AxisServo*, 2> { azServo.get(), elServo.get() });
+    mountControl->setRealtimePriority(static_cast<int>(EncoderReadoutN[1].value));
+    applyServoSettings();
+
     // initialize the temperature monitor
     TempMonitorNP.nnp = 0;
     IDSetNumber(&TempMonitorNP, nullptr);
@@ -895,6 +1524,10 @@ bool PiRT::Connect()
             continue;
         std::shared_ptr<PiRaTe::ADS1115> adc(std::dynamic_pointer_cast<PiRaTe::ADS1115>(it->second));
         auto mon = std::make_shared<PiRaTe::Ads1115VoltageMonitor>(item.name, std::move(adc), item.adc_channel, item.nominal, item.divider_ratio, item.nominal / 10.);
+        mon->setExternalReadout(true);
+        adcScheduler->addChannel(ADC_GROUP_MONITOR, mon->adc(), mon->adcChannel(), [mon](std::chrono::time_point<std::chrono::system_clock>, double voltage) {
+            mon->processReadout(voltage);
+        });
         voltageMonitors.emplace_back(std::move(mon));
 //         deleteProperty(VoltageMonitorNP.name);
         IUFillNumber(&VoltageMonitorN[voltage_index], ("VOLTAGE" + std::to_string(voltage_index)).c_str(), (item.name).c_str(), "%4.2f V", item.nominal * 0.9, item.nominal * 1.1, 0, 0.);
@@ -914,15 +1547,42 @@ bool PiRT::Connect()
             continue;
         std::shared_ptr<PiRaTe::ADS1115> adc(std::dynamic_pointer_cast<PiRaTe::ADS1115>(it->second));
         auto meas = std::make_shared<PiRaTe::Ads1115Measurement>(item.name, std::move(adc), item.adc_channel, item.divider_ratio, DEFAULT_INT_TIME);
+        meas->setExternalReadout(true);
+        adcScheduler->addChannel(ADC_GROUP_MEAS, meas->adc(), meas->adcChannel(), [meas](std::chrono::time_point<std::chrono::system_clock> time, double voltage) {
+            meas->processReadout(time, voltage);
+        });
         voltageMeasurements.emplace_back(std::move(meas));
 //         deleteProperty(VoltageMeasurementNP.name);
 //         deleteProperty(MeasurementIntTimeNP.name);
         IUFillNumber(&VoltageMeasurementN[voltage_index], ("MEASUREMENT" + std::to_string(voltage_index)).c_str(), (item.name).c_str(), ("%4.3f " + item.unit).c_str(), 0, 0, 0, 0.);
+        const std::string stat_name { "MEASUREMENT" + std::to_string(voltage_index) };
+        IUFillNumber(&MeasurementStatsN[4 * voltage_index], (stat_name + "_STDDEV").c_str(), (item.name + " stddev").c_str(), ("%4.3f " + item.unit).c_str(), 0, 0, 0, 0.);
+        IUFillNumber(&MeasurementStatsN[4 * voltage_index + 1], (stat_name + "_MIN").c_str(), (item.name + " min").c_str(), ("%4.3f " + item.unit).c_str(), 0, 0, 0, 0.);
+        IUFillNumber(&MeasurementStatsN[4 * voltage_index + 2], (stat_name + "_MAX").c_str(), (item.name + " max").c_str(), ("%4.3f " + item.unit).c_str(), 0, 0, 0, 0.);
+        IUFillNumber(&MeasurementStatsN[4 * voltage_index + 3], (stat_name + "_COUNT").c_str(), (item.name + " samples").c_str(), "%6.0f", 0, 0, 0, 0.);
+        IUFillNumber(&OutlierStatusN[2 * voltage_index], (stat_name + "_FLAGGED").c_str(), (item.name + " flagged").c_str(), "%8.0f", 0, 0, 0, 0.);
+        IUFillNumber(&OutlierStatusN[2 * voltage_index + 1], (stat_name + "_FLAG_RATIO").c_str(), (item.name + " flagged in window").c_str(), "%5.2f %%", 0, 0, 0, 0.);
+        IUFillNumber(&FilteredMeasurementN[voltage_index], ("FILTERED" + std::to_string(voltage_index)).c_str(), (item.name).c_str(), ("%4.3f " + item.unit).c_str(), 0, 0, 0, 0.);
+        if (voltage_index == 0)
+            logarithmicDetector = (item.unit == "dB");
 
         voltage_index++;
     }
-    IUFillNumberVector(&VoltageMeasurementNP, VoltageMeasurementN, voltage_index, getDeviceName(), "MEASUREMENTS", "Measurements", "Monitoring",
+    // the first channel is additionally published as temperature with the gain of the periodic calibration
+    if (voltage_index > 0) {
+        IUFillNumber(&VoltageMeasurementN[voltage_index], "MEASUREMENT0_TEMP", (std::string(VoltageMeasurementN[0].label) + " calibrated").c_str(), "%7.1f K", 0, 0, 0, 0.);
+    }
+    IUFillNumberVector(&VoltageMeasurementNP, VoltageMeasurementN, (voltage_index > 0) ? voltage_index + 1 : 0, getDeviceName(), "MEASUREMENTS", "Measurements", "Monitoring",
+        IP_RO, 60, IPS_IDLE);
+    IUFillNumberVector(&MeasurementStatsNP, MeasurementStatsN, 4 * voltage_index, getDeviceName(), "MEASUREMENT_STATS", "Measurement Statistics", "Monitoring",
         IP_RO, 60, IPS_IDLE);
+    IUFillNumberVector(&FilteredMeasurementNP, FilteredMeasurementN, voltage_index, getDeviceName(), "FILTERED_MEASUREMENTS", "Filtered Measurements", "Monitoring",
+        IP_RO, 60, IPS_IDLE);
+    IUFillNumberVector(&OutlierStatusNP, OutlierStatusN, 2 * voltage_index, getDeviceName(), "OUTLIER_STATUS", "Flagged Outliers", "Monitoring",
+        IP_RO, 60, IPS_IDLE);
+    updateMeasurementSampleRates();
+    applyFilterSettings();
+    applyOutlierSettings();
 //     defineProperty(&VoltageMeasurementNP);
 //     defineProperty(&MeasurementIntTimeNP);
 
@@ -933,6 +1593,44 @@ bool PiRT::Connect()
         gpio->set_gpio_state(GpioOutputVector[i].gpio_pin, GpioOutputVector[i].inverted);
     }
 
+    // set up the lock-in detection and the periodic calibration on the first measurement channel
+    lockIn = std::make_shared<PiRaTe::LockInDetector>(gpio, GpioOutputVector[LOCKIN_REF_OUTPUT_INDEX].gpio_pin, GpioOutputVector[LOCKIN_REF_OUTPUT_INDEX].inverted);
+    const std::size_t cal_output { static_cast<std::size_t>(CalibrationSettingN[4].value) };
+    {
+        std::lock_guard<std::mutex> lock(calibrationMutex);
+        calibration = std::make_shared<PiRaTe::CalibrationScheduler>(gpio, GpioOutputVector[cal_output].gpio_pin, GpioOutputVector[cal_output].inverted);
+    }
+    if (!voltageMeasurements.empty()) {
+        // the callback is registered once, it runs in the sampling thread and picks up the current calibration scheduler
+        voltageMeasurements[0]->registerSampleCallback([this, lockin = lockIn](const PiRaTe::Ads1115Measurement::Sample& sample) {
+            if (sample.flagged)
+                return;
+            // the calibration needs the samples taken with the source on, the lock-in must not see them
+            if (!sample.excluded)
+                lockin->process(sample.time, sample.value);
+            std::shared_ptr<PiRaTe::CalibrationScheduler> cal {};
+            {
+                std::lock_guard<std::mutex> lock(calibrationMutex);
+                cal = calibration;
+            }
+            if (cal != nullptr)
+                cal->process(sample.time, sample.value);
+        });
+        // the samples taken with the calibration source on are left out of the integrated measurement values
+        voltageMeasurements[0]->setSampleExclusion([this](std::chrono::time_point<std::chrono::system_clock> time) {
+            std::shared_ptr<PiRaTe::CalibrationScheduler> cal {};
+            {
+                std::lock_guard<std::mutex> lock(calibrationMutex);
+                cal = calibration;
+            }
+            return (cal != nullptr && cal->isCalibrationSample(time));
+        });
+    }
+    IUResetSwitch(&LockInControlSP);
+    LockInControlS[LOCKIN_STOP].s = ISS_ON;
+    IUResetSwitch(&CalibrationControlSP);
+    CalibrationControlS[CAL_STOP].s = ISS_ON;
+
     // set up the gpio pins for the digital inputs
     for (unsigned int i = 0; i < GpioInputVector.size(); i++) {
         gpio->set_gpio_direction(GpioInputVector[i].gpio_pin, PiRaTe::Gpio::Direction::DIRECTION_INPUT);
@@ -951,6 +1649,23 @@ bool PiRT::Connect()
 
 bool PiRT::Disconnect()
 {
+    scanEngine.stop();
+    recorder.stop();
+    if (lockIn != nullptr)
+        lockIn->stop();
+    lockIn.reset();
+    if (calibration != nullptr)
+        calibration->stop();
+    {
+        std::lock_guard<std::mutex> lock(calibrationMutex);
+        calibration.reset();
+    }
+    applyMeasurementMode(false);
+    adcScheduler.reset();
+    mountControl.reset();
+    azServo.reset();
+    elServo.reset();
+    encoderGroup.reset();
     az_encoder.reset();
     el_encoder.reset();
     az_motor.reset();
@@ -1043,10 +1758,7 @@ bool PiRT::Goto(double ra, double dec)
     // Inform client we are slewing to a new position
     DEBUGF(INDI::Logger::DBG_SESSION, "Slewing to RA: %s - DEC: %s", RAStr, DecStr);
 
-    targetPointingCycles = 0;
-
-    // Success!
-    return true;
+    return sendMotion(PiRaTe::MountController::Command::Type::Slew);
 }
 
 /**************************************************************************************
@@ -1079,10 +1791,7 @@ bool PiRT::GotoHor(double az, double alt)
     // Inform client we are slewing to a new position
     DEBUGF(INDI::Logger::DBG_SESSION, "Slewing to Az: %s - Alt: %s", AzStr, AltStr);
 
-    targetPointingCycles = 0;
-
-    // Success!
-    return true;
+    return sendMotion(PiRaTe::MountController::Command::Type::Slew);
 }
 
 /**************************************************************************************
@@ -1090,10 +1799,14 @@ bool PiRT::GotoHor(double az, double alt)
 ***************************************************************************************/
 bool PiRT::Abort()
 {
-    az_motor->stop();
-    el_motor->stop();
-    targetPointingCycles = 0;
-    if (TrackState == SCOPE_IDLE || TrackState == SCOPE_TRACKING || TrackState == SCOPE_PARKED)
+    sendMotion(PiRaTe::MountController::Command::Type::Stop);
+    if (TrackState == SCOPE_TRACKING) {
+        // the control loop does not follow the target anymore, so tracking ends here
+        fIsTracking = false;
+        TrackState = SCOPE_IDLE;
+        return true;
+    }
+    if (TrackState == SCOPE_IDLE || TrackState == SCOPE_PARKED)
         return true;
     else
         TrackState = (isTracking() ? SCOPE_TRACKING : SCOPE_IDLE);
@@ -1104,10 +1817,8 @@ bool PiRT::Abort()
 
 bool PiRT::MoveNS(INDI_DIR_NS dir, TelescopeMotionCommand command)
 {
-    if (command != MOTION_START) {
-        el_motor->stop();
-        return true;
-    }
+    if (command != MOTION_START)
+        return sendManualMotion(PiRaTe::MountController::AXIS_ALT, 0.);
     int speedIndex = IUFindOnSwitchIndex(&SlewRateSP);
 
     float speed = 0.;
@@ -1119,24 +1830,18 @@ bool PiRT::MoveNS(INDI_DIR_NS dir, TelescopeMotionCommand command)
 
     switch (dir) {
     case DIRECTION_SOUTH:
-        el_motor->move(-speed);
-        break;
+        return sendManualMotion(PiRaTe::MountController::AXIS_ALT, -speed);
     case DIRECTION_NORTH:
-        el_motor->move(speed);
-        break;
+        return sendManualMotion(PiRaTe::MountController::AXIS_ALT, speed);
     default:
-        el_motor->stop();
-        break;
+        return sendManualMotion(PiRaTe::MountController::AXIS_ALT, 0.);
     }
-    return true;
 }
 
 bool PiRT::MoveWE(INDI_DIR_WE dir, TelescopeMotionCommand command)
 {
-    if (command != MOTION_START) {
-        az_motor->stop();
-        return true;
-    }
+    if (command != MOTION_START)
+        return sendManualMotion(PiRaTe::MountController::AXIS_AZ, 0.);
 
     int speedIndex = IUFindOnSwitchIndex(&SlewRateSP);
     float speed = 0.;
@@ -1148,16 +1853,12 @@ bool PiRT::MoveWE(INDI_DIR_WE dir, TelescopeMotionCommand command)
 
     switch (dir) {
     case DIRECTION_WEST:
-        az_motor->move(speed);
-        break;
+        return sendManualMotion(PiRaTe::MountController::AXIS_AZ, speed);
     case DIRECTION_EAST:
-        az_motor->move(-speed);
-        break;
+        return sendManualMotion(PiRaTe::MountController::AXIS_AZ, -speed);
     default:
-        az_motor->stop();
-        break;
+        return sendManualMotion(PiRaTe::MountController::AXIS_AZ, 0.);
     }
-    return true;
 }
 
 void PiRT::Hor2Equ(const HorCoords& hor_coords, double* ra, double* dec)
@@ -1174,24 +1875,12 @@ EquCoords PiRT::Hor2Equ(const HorCoords& hor_coords)
 
 void PiRT::Hor2Equ(double az, double alt, double* ra, double* dec)
 {
-    struct ln_date date;
-    struct tm* utc;
-
-    time_t raw_time;
-    time(&raw_time);
-
-    utc = gmtime(&raw_time);
-
-    /* UT date and time */
-    date.years = utc->tm_year + 1900;
-    date.months = utc->tm_mon + 1;
-    date.days = utc->tm_mday;
-    date.hours = utc->tm_hour;
-    date.minutes = utc->tm_min;
-    date.seconds = utc->tm_sec;
-
-    double JD = ln_get_julian_day(&date);
+    // the conversion refers to the epoch of the current poll cycle
+    Hor2Equ(az, alt, timeBase.julianDay(), ra, dec);
+}
 
+void PiRT::Hor2Equ(double az, double alt, double JD, double* ra, double* dec)
+{
     struct ln_hrz_posn horcoords;
     // 0 deg Az should be S, in libnova it is N
     horcoords.az = ln_range_degrees(az + 180.);
@@ -1220,24 +1909,12 @@ HorCoords PiRT::Equ2Hor(const EquCoords& equ_coords)
 
 void PiRT::Equ2Hor(double ra, double dec, double* az, double* alt)
 {
-    struct ln_date date;
-    struct tm* utc;
-
-    time_t raw_time;
-    time(&raw_time);
-
-    utc = gmtime(&raw_time);
-
-    /* UT date and time */
-    date.years = utc->tm_year + 1900;
-    date.months = utc->tm_mon + 1;
-    date.days = utc->tm_mday;
-    date.hours = utc->tm_hour;
-    date.minutes = utc->tm_min;
-    date.seconds = utc->tm_sec;
-
-    double JD = ln_get_julian_day(&date);
+    // the conversion refers to the epoch of the current poll cycle
+    Equ2Hor(ra, dec, timeBase.julianDay(), az, alt);
+}
 
+void PiRT::Equ2Hor(double ra, double dec, double JD, double* az, double* alt)
+{
     struct ln_equ_posn equcoords;
     equcoords.ra = 360. * ra / 24.;
     equcoords.dec = dec;
@@ -1284,42 +1961,224 @@ void PiRT::updateMotorStatus()
     } else {
         MotorStatusNP.s = IPS_OK;
     }
-    MotorStatusN[0].value = 100. * az_motor->currentSpeed();
-    MotorStatusN[1].value = 100. * el_motor->currentSpeed();
-    IDSetNumber(&MotorStatusNP, nullptr);
+    // speeds and currents are taken from the snapshot of the mount control loop,
+    // which also enforces the motor current limits
+    const auto status { (mountControl != nullptr) ? mountControl->status() : PiRaTe::MountController::Status {} };
+    MotorStatusN[0].value = 100. * status.motorSpeed[PiRaTe::MountController::AXIS_AZ];
+    MotorStatusN[1].value = 100. * status.motorSpeed[PiRaTe::MountController::AXIS_ALT];
+    publishNumber(&MotorStatusNP, PUBLISH_MOTOR);
 
     if (az_motor->hasAdc() || el_motor->hasAdc()) {
         MotorCurrentNP.s = IPS_OK;
         if (az_motor->hasAdc()) {
-            MotorCurrentN[0].value = az_motor->readCurrent() + 0.005;
+            MotorCurrentN[0].value = status.motorCurrent[PiRaTe::MountController::AXIS_AZ] + 0.005;
         } else {
             MotorCurrentNP.s = IPS_BUSY;
         }
         if (el_motor->hasAdc()) {
-            MotorCurrentN[1].value = el_motor->readCurrent() + 0.005;
+            MotorCurrentN[1].value = status.motorCurrent[PiRaTe::MountController::AXIS_ALT] + 0.005;
         } else {
             MotorCurrentNP.s = IPS_BUSY;
         }
-        if (MotorCurrentN[0].value > MotorCurrentLimitN[0].value) {
-            // Motor current limit exceeded. Stop immediately
-            az_motor->stop();
+        if (status.overCurrent[PiRaTe::MountController::AXIS_AZ] || status.overCurrent[PiRaTe::MountController::AXIS_ALT])
             MotorCurrentNP.s = IPS_ALERT;
+        //DEBUGF(INDI::Logger::DBG_SESSION, "ADC value ch0: %f V ch1: %f ch3: %f V ch4: %f", v1,v2,v3,v4);
+        publishNumber(&MotorCurrentNP, PUBLISH_MOTOR);
+    }
+}
+
+void PiRT::updateServoStatus()
+{
+    if (azServo == nullptr || elServo == nullptr)
+        return;
+    const auto az_stats { azServo->statistics() };
+    AzServoStatusN[0].value = az_stats.error;
+    AzServoStatusN[1].value = az_stats.rms;
+    AzServoStatusN[2].value = az_stats.max;
+    AzServoStatusN[3].value = az_stats.settleTime;
+    AzServoStatusNP.s = (azServo->isEnabled()) ? IPS_BUSY : IPS_IDLE;
+    publishNumber(&AzServoStatusNP, PUBLISH_MOTOR);
+    const auto el_stats { elServo->statistics() };
+    ElServoStatusN[0].value = el_stats.error;
+    ElServoStatusN[1].value = el_stats.rms;
+    ElServoStatusN[2].value = el_stats.max;
+    ElServoStatusN[3].value = el_stats.settleTime;
+    ElServoStatusNP.s = (elServo->isEnabled()) ? IPS_BUSY : IPS_IDLE;
+    publishNumber(&ElServoStatusNP, PUBLISH_MOTOR);
+}
+
+void PiRT::applyServoSettings()
+{
+    if (azServo == nullptr || elServo == nullptr)
+        return;
+    azServo->setGains({ AzServoGainN[0].value, AzServoGainN[1].value, AzServoGainN[2].value, AzServoGainN[3].value });
+    elServo->setGains({ ElServoGainN[0].value, ElServoGainN[1].value, ElServoGainN[2].value, ElServoGainN[3].value });
+    azServo->setScale({ axisRatio[0], axisOffset[0], AZ_POS_DIR_INVERT });
+    elServo->setScale({ axisRatio[1], axisOffset[1], ALT_POS_DIR_INVERT });
+    azServo->setTolerance(TRACK_ACCURACY_AZ);
+    elServo->setTolerance(TRACK_ACCURACY_ALT);
+    azServo->setMinThrottle(MotorThresholdN[0].value / 100.);
+    elServo->setMinThrottle(MotorThresholdN[1].value / 100.);
+    azServo->setRate(ServoSettingN[0].value);
+    elServo->setRate(ServoSettingN[0].value);
+    DEBUGF(DBG_SCOPE, "Servo loop rate set to %5.0f Hz", ServoSettingN[0].value);
+    applyControlSettings();
+}
+
+void PiRT::applyControlSettings()
+{
+    if (mountControl == nullptr)
+        return;
+    PiRaTe::MountController::Config config {};
+    config.scale = { PiRaTe::AxisServo::Scale { axisRatio[0], axisOffset[0], AZ_POS_DIR_INVERT },
+        PiRaTe::AxisServo::Scale { axisRatio[1], axisOffset[1], ALT_POS_DIR_INVERT } };
+    config.azOverturn = MAX_AZ_OVERTURN;
+    config.azLimitMargin = AZ_LIMIT_MARGIN;
+    config.altLimitLow = ALT_LIMIT_LOW;
+    config.altLimitHigh = ALT_LIMIT_HI;
+    config.tolerance = { TRACK_ACCURACY_AZ, TRACK_ACCURACY_ALT };
+    config.slewLimits = { PiRaTe::TrapezoidalProfile::Limits { SlewLimitN[0].value, SlewLimitN[1].value },
+        PiRaTe::TrapezoidalProfile::Limits { SlewLimitN[2].value, SlewLimitN[3].value } };
+    config.currentLimit = { MotorCurrentLimitN[0].value, MotorCurrentLimitN[1].value };
+    config.settleTime = std::chrono::milliseconds(MAX_TARGET_POINTING_IMPROVEMENT_TIME_MS);
+    mountControl->setConfig(config);
+}
+
+/**************************************************************************************
+** Hand a motion towards the current target over to the mount control loop
+***************************************************************************************/
+bool PiRT::sendMotion(PiRaTe::MountController::Command::Type type, double azRate, double altRate)
+{
+    if (mountControl == nullptr)
+        return false;
+    PiRaTe::MountController::Command cmd {};
+    cmd.type = type;
+    if (type == PiRaTe::MountController::Command::Type::Slew || type == PiRaTe::MountController::Command::Type::Track)
+        ++motionId;
+    cmd.id = motionId;
+    if (type != PiRaTe::MountController::Command::Type::Stop) {
+        if (TargetCoordSystem == SYSTEM_EQ || TrackState == SCOPE_TRACKING) {
+            // an equatorial target is evaluated by the control loop with the expansion of the tracking engine
+            double az_rate { 0. };
+            double alt_rate { 0. };
+            trackingTarget(&targetHorizontalCoords, &az_rate, &alt_rate);
+            cmd.target.equatorial = true;
+            cmd.target.engine = trackingEngine;
+        } else {
+            cmd.target.az = targetHorizontalCoords.Az.value();
+            cmd.target.alt = targetHorizontalCoords.Alt.value();
+            cmd.target.azRate = azRate;
+            cmd.target.altRate = altRate;
+            cmd.target.epoch = std::chrono::system_clock::now();
         }
-        if (MotorCurrentN[1].value > MotorCurrentLimitN[1].value) {
-            // Motor current limit exceeded. Stop immediately
-            el_motor->stop();
-            MotorCurrentNP.s = IPS_ALERT;
+    }
+    if (!mountControl->command(cmd)) {
+        DEBUG(INDI::Logger::DBG_ERROR, "Mount control not responding - command queue full.");
+        return false;
+    }
+    return true;
+}
+
+bool PiRT::sendManualMotion(std::size_t axis, double speed)
+{
+    if (mountControl == nullptr)
+        return false;
+    PiRaTe::MountController::Command cmd {};
+    cmd.type = PiRaTe::MountController::Command::Type::Move;
+    cmd.id = motionId;
+    cmd.axis = axis;
+    cmd.speed = speed;
+    if (!mountControl->command(cmd)) {
+        DEBUG(INDI::Logger::DBG_ERROR, "Mount control not responding - command queue full.");
+        return false;
+    }
+    return true;
+}
+
+/**************************************************************************************
+** Handle the events issued by the mount control loop since the last poll
+***************************************************************************************/
+void PiRT::processControlEvents()
+{
+    if (mountControl == nullptr)
+        return;
+    PiRaTe::MountController::Event event {};
+    while (mountControl->nextEvent(event)) {
+        switch (event.type) {
+        case PiRaTe::MountController::Event::Type::SlewComplete:
+            // ignore the completion of a motion which was superseded in the meantime
+            if (event.id != motionId || (TrackState != SCOPE_SLEWING && TrackState != SCOPE_PARKING))
+                break;
+            if (TargetCoordSystem == SYSTEM_EQ) {
+                EqNP.s = IPS_OK;
+                IDSetNumber(&EqNP, nullptr);
+            } else if (TargetCoordSystem == SYSTEM_HOR) {
+                HorNP.s = lastHorState = IPS_OK;
+                IDSetNumber(&HorNP, nullptr);
+            }
+            if (TrackState == SCOPE_SLEWING) {
+                DEBUG(INDI::Logger::DBG_SESSION, "Telescope slew is complete.");
+            } else if (TrackState == SCOPE_PARKING) {
+                fIsTracking = false;
+                SetParked(true);
+            }
+            Abort();
+            if (TrackState == SCOPE_TRACKING)
+                sendMotion(PiRaTe::MountController::Command::Type::Track);
+            break;
+        case PiRaTe::MountController::Event::Type::LimitStop:
+            // the control loop stopped all motion, stop tracking as well
+            DEBUGF(INDI::Logger::DBG_WARNING, "%s axis limit reached at %5.3f rev - motion stopped.",
+                (event.axis == PiRaTe::MountController::AXIS_AZ) ? "Az" : "Alt", event.value);
+            Abort();
+            if (fIsTracking)
+                TrackState = SCOPE_IDLE;
+            fIsTracking = false;
+            break;
+        case PiRaTe::MountController::Event::Type::CurrentLimit:
+            DEBUGF(INDI::Logger::DBG_WARNING, "%s motor current limit exceeded (%5.3f A) - axis stopped.",
+                (event.axis == PiRaTe::MountController::AXIS_AZ) ? "Az" : "Alt", event.value);
+            break;
         }
-        //DEBUGF(INDI::Logger::DBG_SESSION, "ADC value ch0: %f V ch1: %f ch3: %f V ch4: %f", v1,v2,v3,v4);
-        IDSetNumber(&MotorCurrentNP, nullptr);
     }
 }
 
+/**************************************************************************************
+** Horizontal position and rates of the equatorial target, evaluated from the
+** closed-form expansion of the tracking engine
+***************************************************************************************/
+void PiRT::trackingTarget(HorCoords* coords, double* azRate, double* altRate)
+{
+    const auto now { timeBase.time() };
+    const double ra { targetEquatorialCoords.Ra.value() };
+    const double dec { targetEquatorialCoords.Dec.value() };
+    const double latitude { LocationN[LOCATION_LATITUDE].value };
+    if (trackingEngine.isRefreshDue(now) || trackingEngine.ra() != ra || trackingEngine.dec() != dec || trackingEngine.latitude() != latitude) {
+        // set up a new expansion referenced to the current apparent sidereal time
+        const double JD { timeBase.julianDay() };
+        double lng = LocationN[LOCATION_LONGITUDE].value;
+        if (lng > 180.)
+            lng -= 360.;
+        const double lst { ln_get_apparent_sidereal_time(JD) + lng / 15. };
+        trackingEngine.setAzimuthOffset(0.);
+        trackingEngine.setTarget(ra, dec, latitude, lst, now);
+        // match the azimuth convention of Equ2Hor
+        const HorCoords reference { Equ2Hor(targetEquatorialCoords) };
+        const double offset { reference.Az.value() - trackingEngine.evaluate(now).az };
+        trackingEngine.setAzimuthOffset(180. * std::round(offset / 180.));
+        DEBUGF(DBG_SCOPE, "Tracking expansion set up for RA=%8.5f h Dec=%8.4f deg", ra, dec);
+    }
+    const auto state { trackingEngine.evaluate(now) };
+    *coords = HorCoords { state.az, state.alt };
+    *azRate = state.azRate;
+    *altRate = state.altRate;
+}
+
 void PiRT::updateMonitoring()
 {
     // update uptime
     DriverUpTimeN.value = upTime().count() / 3600.;
-    IDSetNumber(&DriverUpTimeNP, nullptr);
+    publishNumber(&DriverUpTimeNP, PUBLISH_MONITOR);
 
     // update inputs
     bool change_detected { false };
@@ -1361,26 +2220,88 @@ void PiRT::updateMonitoring()
             else
                 VoltageMonitorNP.s = IPS_OK;
         }
-        IDSetNumber(&VoltageMonitorNP, nullptr);
+        publishNumber(&VoltageMonitorNP, PUBLISH_MONITOR);
     }
 
     voltage_index = 0;
     if (!voltageMeasurements.empty()) {
         VoltageMeasurementNP.s = IPS_IDLE;
         for (auto meas : voltageMeasurements) {
+            PiRaTe::Ads1115Measurement::Statistics stats {};
             if (!meas->isInitialized()) {
-                VoltageMeasurementN[voltage_index].value = 0.;
                 VoltageMeasurementNP.s = IPS_ALERT;
             } else {
-                double meanVoltage = meas->meanValue();
-                VoltageMeasurementN[voltage_index].value = meanVoltage;
+                stats = meas->statistics();
             }
+            VoltageMeasurementN[voltage_index].value = stats.mean;
+            MeasurementStatsN[4 * voltage_index].value = stats.stddev;
+            MeasurementStatsN[4 * voltage_index + 1].value = stats.min;
+            MeasurementStatsN[4 * voltage_index + 2].value = stats.max;
+            MeasurementStatsN[4 * voltage_index + 3].value = stats.count;
+            FilteredMeasurementN[voltage_index].value = (meas->isInitialized()) ? meas->filteredValue() : 0.;
+            OutlierStatusN[2 * voltage_index].value = meas->nrFlagged();
+            OutlierStatusN[2 * voltage_index + 1].value = (stats.count + stats.flagged > 0) ? 100. * stats.flagged / (stats.count + stats.flagged) : 0.;
+            if (voltage_index == 0)
+                VoltageMeasurementN[voltageMeasurements.size()].value = (calibration != nullptr) ? calibration->temperature(stats.mean) : 0.;
             voltage_index++;
         }
         if (VoltageMeasurementNP.s != IPS_ALERT) {
             VoltageMeasurementNP.s = IPS_OK;
         }
-        IDSetNumber(&VoltageMeasurementNP, nullptr);
+        MeasurementStatsNP.s = VoltageMeasurementNP.s;
+        FilteredMeasurementNP.s = (FilterSettingN[0].value > 0.) ? VoltageMeasurementNP.s : IPS_IDLE;
+        publishNumber(&VoltageMeasurementNP, PUBLISH_MONITOR);
+        publishNumber(&MeasurementStatsNP, PUBLISH_MONITOR);
+        publishNumber(&FilteredMeasurementNP, PUBLISH_MONITOR);
+        OutlierStatusNP.s = (OutlierSettingN[1].value > 0.) ? VoltageMeasurementNP.s : IPS_IDLE;
+        publishNumber(&OutlierStatusNP, PUBLISH_MONITOR);
+    }
+
+    if (lockIn != nullptr && lockIn->isActive()) {
+        // ON/OFF levels and their difference averaged over the complete cycles within the integration time
+        const auto result { lockIn->result(std::chrono::milliseconds(static_cast<long int>(MeasurementIntTimeN.value * 1000))) };
+        LockInResultN[0].value = result.on;
+        LockInResultN[1].value = result.off;
+        LockInResultN[2].value = result.diff;
+        LockInResultN[3].value = result.diffError;
+        LockInResultN[4].value = result.cycles;
+        LockInResultNP.s = (result.cycles > 0) ? IPS_BUSY : IPS_ALERT;
+        publishNumber(&LockInResultNP, PUBLISH_MONITOR);
+    }
+
+    if (calibration != nullptr) {
+        const auto estimate { calibration->estimate() };
+        CalibrationStatusN[0].value = estimate.gain;
+        CalibrationStatusN[1].value = estimate.tsys;
+        CalibrationStatusN[2].value = estimate.count;
+        CalibrationStatusN[3].value = (estimate.valid) ? std::chrono::duration<double>(timeBase.time() - estimate.time).count() : 0.;
+        if (calibration->isCalibrating())
+            CalibrationStatusNP.s = IPS_BUSY;
+        else if (calibration->isActive())
+            CalibrationStatusNP.s = (estimate.valid) ? IPS_OK : IPS_ALERT;
+        else
+            CalibrationStatusNP.s = IPS_IDLE;
+        publishNumber(&CalibrationStatusNP, PUBLISH_MONITOR);
+    }
+
+    if (adcScheduler != nullptr) {
+        const auto jitter { adcScheduler->jitterStatistics() };
+        AdcScheduleStatusN[0].value = (voltageMeasurements.empty()) ? 0. : adcScheduler->sampleRate(voltageMeasurements[0]->adc(), voltageMeasurements[0]->adcChannel());
+        AdcScheduleStatusN[1].value = jitter.rms;
+        AdcScheduleStatusN[2].value = jitter.overruns;
+        AdcScheduleStatusNP.s = (jitter.overruns > 0) ? IPS_BUSY : IPS_OK;
+        publishNumber(&AdcScheduleStatusNP, PUBLISH_MONITOR);
+    }
+
+    const auto now { std::chrono::steady_clock::now() };
+    const double interval { std::chrono::duration<double>(now - lastPublishStatisticsTime).count() };
+    if (interval >= 1.) {
+        const auto stats { publisher.statistics() };
+        PublishStatusN[0].value = stats.published / interval;
+        PublishStatusN[1].value = (stats.published + stats.suppressed > 0) ? 100. * stats.suppressed / (stats.published + stats.suppressed) : 0.;
+        PublishStatusNP.s = IPS_OK;
+        lastPublishStatisticsTime = now;
+        publishNumber(&PublishStatusNP, PUBLISH_MONITOR);
     }
 }
 
@@ -1392,7 +2313,7 @@ void PiRT::updateTemperatures(PiRaTe::RpiTemperatureMonitor::TemperatureItem ite
     int source = item.sourceIndex;
     if (source < TempMonitorNP.nnp) {
         TempMonitorN[source].value = item.temperature;
-        IDSetNumber(&TempMonitorNP, nullptr);
+        publishNumber(&TempMonitorNP, PUBLISH_MONITOR);
         return;
     }
     deleteProperty(TempMonitorNP.name);
@@ -1417,33 +2338,49 @@ void PiRT::updatePosition()
             ElEncoderNP.s = IPS_ALERT;
         return;
     }
-    // read pos encoders
-    if (az_encoder->isUpdated() || el_encoder->isUpdated()) {
-        AzEncoderN[0].value = az_encoder->absolutePosition();
-        AzEncoderN[1].value = static_cast<double>(az_encoder->position());
-        AzEncoderN[2].value = static_cast<double>(az_encoder->nrTurns());
+    // fetch all pos encoder read-outs since the last poll from the lock-free sample rings
+    std::vector<PiRaTe::SsiPosEncoder::Sample> az_samples {};
+    std::vector<PiRaTe::SsiPosEncoder::Sample> el_samples {};
+    az_encoder->readSamples(az_samples);
+    el_encoder->readSamples(el_samples);
+    appendPositionHistory(*az_encoder, az_samples, azPositionHistory);
+    appendPositionHistory(*el_encoder, el_samples, elPositionHistory);
+
+    if (!az_samples.empty() || !el_samples.empty()) {
+        if (!az_samples.empty())
+            lastAzEncoderSample = az_samples.back();
+        if (!el_samples.empty())
+            lastElEncoderSample = el_samples.back();
+        const double az_revolutions { az_encoder->toRevolutions(lastAzEncoderSample.st, lastAzEncoderSample.mt) };
+        const double el_revolutions { el_encoder->toRevolutions(lastElEncoderSample.st, lastElEncoderSample.mt) };
+
+        AzEncoderN[0].value = az_revolutions;
+        AzEncoderN[1].value = static_cast<double>(lastAzEncoderSample.st);
+        AzEncoderN[2].value = static_cast<double>(lastAzEncoderSample.mt);
         AzEncoderN[3].value = az_encoder->bitErrorCount();
         AzEncoderN[4].value = az_encoder->lastReadOutDuration().count();
+        // both axes are sampled in the same read-out cycle, so they share the jitter statistics
+        const auto jitter { (encoderGroup) ? encoderGroup->jitterStatistics() : PiRaTe::CycleTimer::Statistics {} };
+        azEncoderOverruns += jitter.overruns;
+        AzEncoderN[5].value = jitter.rms;
+        AzEncoderN[6].value = jitter.max;
+        AzEncoderN[7].value = azEncoderOverruns;
         //DEBUGF(INDI::Logger::DBG_SESSION, "Az Encoder values: st=%d mt=%u t_ro=%u us", st, mt, us);
         AzEncoderNP.s = (az_encoder->statusOk()) ? IPS_OK : IPS_ALERT;
-        IDSetNumber(&AzEncoderNP, nullptr);
-        ElEncoderN[0].value = el_encoder->absolutePosition();
-        ElEncoderN[1].value = static_cast<double>(el_encoder->position());
-        ElEncoderN[2].value = static_cast<double>(el_encoder->nrTurns());
+        publishNumber(&AzEncoderNP, PUBLISH_POSITION);
+        ElEncoderN[0].value = el_revolutions;
+        ElEncoderN[1].value = static_cast<double>(lastElEncoderSample.st);
+        ElEncoderN[2].value = static_cast<double>(lastElEncoderSample.mt);
         ElEncoderN[3].value = el_encoder->bitErrorCount();
         ElEncoderN[4].value = el_encoder->lastReadOutDuration().count();
+        elEncoderOverruns += jitter.overruns;
+        ElEncoderN[5].value = jitter.rms;
+        ElEncoderN[6].value = jitter.max;
+        ElEncoderN[7].value = elEncoderOverruns;
         ElEncoderNP.s = (el_encoder->statusOk()) ? IPS_OK : IPS_ALERT;
-        IDSetNumber(&ElEncoderNP, nullptr);
-
-        const double az_revolutions { az_encoder->absolutePosition() };
-        const double el_revolutions { el_encoder->absolutePosition() };
+        publishNumber(&ElEncoderNP, PUBLISH_POSITION);
 
-        azAbsTurns = (az_revolutions / axisRatio[0]) + axisOffset[0] / 360.;
-        altAbsTurns = (el_revolutions / axisRatio[1]) + axisOffset[1] / 360.;
-        if (AZ_POS_DIR_INVERT)
-            azAbsTurns *= -1.;
-        if (ALT_POS_DIR_INVERT)
-            altAbsTurns *= -1.;
+        encoderToAbsTurns(az_revolutions, el_revolutions, &azAbsTurns, &altAbsTurns);
 
         AxisAbsTurnsN[0].value = azAbsTurns;
         AxisAbsTurnsN[1].value = altAbsTurns;
@@ -1452,7 +2389,7 @@ void PiRT::updatePosition()
         } else {
             AxisAbsTurnsNP.s = IPS_OK;
         }
-        IDSetNumber(&AxisAbsTurnsNP, nullptr);
+        publishNumber(&AxisAbsTurnsNP, PUBLISH_POSITION);
 
         currentHorizontalCoords.Az.setValue(360. * azAbsTurns);
         currentHorizontalCoords.Alt.setValue(360. * altAbsTurns);
@@ -1460,44 +2397,218 @@ void PiRT::updatePosition()
     }
 }
 
-void PiRT::updateTime()
+void PiRT::applyEncoderReadoutSettings()
 {
+    if (encoderGroup == nullptr)
+        return;
+    encoderGroup->setReadRate(EncoderReadoutN[0].value);
+    if (!encoderGroup->setRealtimePriority(static_cast<int>(EncoderReadoutN[1].value))) {
+        DEBUG(INDI::Logger::DBG_WARNING, "Failed to set real-time priority of encoder read-out. Missing privileges?");
+        EncoderReadoutNP.s = IPS_ALERT;
+    }
+    // the mount control loop runs with the same priority as the encoder read-out
+    if (mountControl != nullptr)
+        mountControl->setRealtimePriority(static_cast<int>(EncoderReadoutN[1].value));
+    if (!encoderGroup->setCpuAffinity(static_cast<int>(EncoderReadoutN[2].value))) {
+        DEBUGF(INDI::Logger::DBG_WARNING, "Failed to pin encoder read-out to cpu %d", static_cast<int>(EncoderReadoutN[2].value));
+        EncoderReadoutNP.s = IPS_ALERT;
+    }
+    DEBUGF(DBG_SCOPE, "Encoder read-out rate set to %5.0f Hz", EncoderReadoutN[0].value);
+}
 
-    static struct timeval ltv {
-        0, 0
-    };
-    struct timeval tv {
-        0, 0
-    };
-    double dt = 0;
-    static double dt_time_update = 0.;
+void PiRT::applyAdcScheduleSettings()
+{
+    if (adcScheduler == nullptr)
+        return;
+    adcScheduler->setWeight(ADC_GROUP_MEAS, static_cast<unsigned int>(AdcScheduleN[ADC_GROUP_MEAS].value));
+    adcScheduler->setWeight(ADC_GROUP_MOTOR, static_cast<unsigned int>(AdcScheduleN[ADC_GROUP_MOTOR].value));
+    adcScheduler->setWeight(ADC_GROUP_MONITOR, static_cast<unsigned int>(AdcScheduleN[ADC_GROUP_MONITOR].value));
+    adcScheduler->setSlotPeriod(std::chrono::microseconds(static_cast<long>(AdcScheduleN[3].value * 1000)));
+    updateMeasurementSampleRates();
+    DEBUGF(DBG_SCOPE, "ADC schedule set to %.0f:%.0f:%.0f slots of %5.2f ms",
+        AdcScheduleN[ADC_GROUP_MEAS].value, AdcScheduleN[ADC_GROUP_MOTOR].value, AdcScheduleN[ADC_GROUP_MONITOR].value, AdcScheduleN[3].value);
+}
 
-    static char ts[32] = { 0 };
+/**************************************************************************************
+** Set up the rate caps and the heartbeat of the published status properties
+***************************************************************************************/
+void PiRT::applyPublishSettings()
+{
+    const std::chrono::milliseconds heartbeat { static_cast<long int>(PublishSettingN[3].value * 1000) };
+    for (std::size_t group : { PUBLISH_POSITION, PUBLISH_MOTOR, PUBLISH_MONITOR }) {
+        const double rate { PublishSettingN[group].value };
+        const std::chrono::milliseconds min_interval { (rate > 0.) ? static_cast<long int>(1000. / rate) : 0 };
+        publisher.setLimits(group, { min_interval, heartbeat });
+    }
+}
+
+/**************************************************************************************
+** Resolution of a printf-style number format, e.g. 0.01 for "%4.2f V"
+** Formats without fixed precision (e.g. %g or sexagesimal) resolve to zero.
+***************************************************************************************/
+static auto formatResolution(const char* format) -> double
+{
+    const char* conversion { strchr(format, '%') };
+    if (conversion == nullptr)
+        return 0.;
+    const char* precision { strpbrk(conversion, ".fgem") };
+    if (precision == nullptr || *precision != '.')
+        return 0.;
+    char* end { nullptr };
+    const long digits { strtol(precision + 1, &end, 10) };
+    if (end == nullptr || *end != 'f')
+        return 0.;
+    return std::pow(10., -static_cast<double>(digits));
+}
+
+/**************************************************************************************
+** Send a number property to the clients, if its values moved by more than half of
+** the displayed resolution, its state changed or the heartbeat expired
+***************************************************************************************/
+void PiRT::publishNumber(INumberVectorProperty* nvp, std::size_t group)
+{
+    const std::size_t nr_values { static_cast<std::size_t>(std::max(nvp->nnp, 0)) };
+    if (!publisher.isRegistered(nvp, nr_values)) {
+        // (re-)register the property, e.g. after the nr. of elements changed
+        std::vector<double> deadbands(nr_values);
+        for (std::size_t i { 0 }; i < nr_values; ++i)
+            deadbands[i] = 0.5 * formatResolution(nvp->np[i].format);
+        publisher.registerProperty(nvp, group, std::move(deadbands));
+    }
+    // no shared buffer here, the temperature monitor publishes from its own thread
+    std::vector<double> values(nr_values);
+    for (std::size_t i { 0 }; i < nr_values; ++i)
+        values[i] = nvp->np[i].value;
+    if (publisher.update(nvp, values, nvp->s))
+        IDSetNumber(nvp, nullptr);
+}
+
+/**************************************************************************************
+** Send a light property to the clients, if any of its lights changed or the heartbeat expired
+***************************************************************************************/
+void PiRT::publishLight(ILightVectorProperty* lvp, std::size_t group)
+{
+    const std::size_t nr_values { static_cast<std::size_t>(std::max(lvp->nlp, 0)) };
+    if (!publisher.isRegistered(lvp, nr_values))
+        publisher.registerProperty(lvp, group, std::vector<double>(nr_values, 0.));
+    std::vector<double> values(nr_values);
+    for (std::size_t i { 0 }; i < nr_values; ++i)
+        values[i] = lvp->lp[i].s;
+    if (publisher.update(lvp, values, lvp->s))
+        IDSetLight(lvp, nullptr);
+}
+
+/**************************************************************************************
+** Set up the outlier flagging of the measurement channels
+***************************************************************************************/
+void PiRT::applyOutlierSettings()
+{
+    for (auto meas : voltageMeasurements)
+        meas->setOutlierRejection(static_cast<std::size_t>(OutlierSettingN[0].value), OutlierSettingN[1].value);
+}
+
+/**************************************************************************************
+** Set up the decimating filter chains of the measurement channels
+***************************************************************************************/
+void PiRT::applyFilterSettings()
+{
+    PiRaTe::FilterChain::Settings settings {};
+    settings.outputRate = FilterSettingN[0].value;
+    settings.cicOrder = static_cast<unsigned int>(FilterSettingN[1].value);
+    settings.firTaps = static_cast<unsigned int>(FilterSettingN[2].value);
+    settings.medianWidth = static_cast<unsigned int>(FilterSettingN[3].value);
+    for (auto meas : voltageMeasurements) {
+        if (settings.outputRate <= 0.) {
+            meas->disableFilter();
+            continue;
+        }
+        meas->setFilter(settings);
+        DEBUGF(DBG_SCOPE, "Filter of %s set to an output rate of %6.3f Hz", meas->name().c_str(), meas->filterOutputRate());
+    }
+}
+
+/**************************************************************************************
+** Size the sample buffers of the measurements for the sample rates of the ADC schedule
+***************************************************************************************/
+void PiRT::updateMeasurementSampleRates()
+{
+    if (adcScheduler == nullptr)
+        return;
+    for (auto meas : voltageMeasurements) {
+        const double rate { adcScheduler->sampleRate(meas->adc(), meas->adcChannel()) };
+        if (rate > 0.)
+            meas->setSampleRate(rate);
+    }
+}
+
+void PiRT::encoderToAbsTurns(double az_revolutions, double el_revolutions, double* azAbsTurns, double* altAbsTurns) const
+{
+    *azAbsTurns = (az_revolutions / axisRatio[0]) + axisOffset[0] / 360.;
+    *altAbsTurns = (el_revolutions / axisRatio[1]) + axisOffset[1] / 360.;
+    if (AZ_POS_DIR_INVERT)
+        *azAbsTurns *= -1.;
+    if (ALT_POS_DIR_INVERT)
+        *altAbsTurns *= -1.;
+}
+
+void PiRT::appendPositionHistory(const PiRaTe::SsiPosEncoder& encoder,
+    const std::vector<PiRaTe::SsiPosEncoder::Sample>& samples,
+    std::deque<PiRaTe::SsiPosEncoder::PositionSample>& history)
+{
+    for (const auto& sample : samples) {
+        history.push_back({ sample.time, encoder.toRevolutions(sample.st, sample.mt) });
+    }
+    if (history.empty())
+        return;
+    const auto oldest { history.back().time - POSITION_HISTORY_TIME };
+    while (history.size() > 2 && history.front().time < oldest) {
+        history.pop_front();
+    }
+}
+
+HorCoords PiRT::horizontalCoordsAt(std::chrono::time_point<std::chrono::system_clock> time)
+{
+    if (azPositionHistory.empty() || elPositionHistory.empty())
+        return currentHorizontalCoords;
+    // the encoder samples carry monotonic time stamps
+    const auto monotonic_time { std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(time - std::chrono::system_clock::now()) };
+    double azAbsTurns { 0. };
+    double altAbsTurns { 0. };
+    encoderToAbsTurns(PiRaTe::SsiPosEncoder::interpolate(azPositionHistory, monotonic_time),
+        PiRaTe::SsiPosEncoder::interpolate(elPositionHistory, monotonic_time),
+        &azAbsTurns, &altAbsTurns);
+    return HorCoords { 360. * azAbsTurns, 360. * altAbsTurns };
+}
+
+void PiRT::updateTime()
+{
+    static std::chrono::time_point<std::chrono::system_clock> last_time {};
+    static double dt_time_update = 0.;
+
+    static char ts[32] = { 0 };
     struct tm *utc, *local;
 
-    /* update elapsed time since last poll, don't presume exactly POLLMS */
-    gettimeofday(&tv, nullptr);
+    /* take the epoch of this poll cycle, don't presume exactly POLLMS */
+    timeBase.update();
+    const auto now { timeBase.time() };
 
     // this is the first poll after connect
-    if (ltv.tv_sec == 0 && ltv.tv_usec == 0) {
-        ltv = tv;
+    if (last_time.time_since_epoch().count() == 0) {
+        last_time = now;
         LocationNP.s = IPS_OK;
         IDSetNumber(&LocationNP, NULL);
     }
 
     // time since last update
-    dt = tv.tv_sec - ltv.tv_sec + 1e-6 * (tv.tv_usec - ltv.tv_usec);
-    ltv = tv;
-
-    //       LocationNP.s = IPS_OK;
-    //       IDSetNumber(&LocationNP, NULL);
+    const double dt { std::chrono::duration<double>(now - last_time).count() };
+    last_time = now;
 
     // update telescope time display only about once per second to save bandwidth
     dt_time_update += dt;
     if (dt_time_update > 0.9) {
         dt_time_update = 0.;
-        time_t raw_time;
-        time(&raw_time);
+        const time_t raw_time { std::chrono::system_clock::to_time_t(now) };
 
         utc = gmtime(&raw_time);
         strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", utc);
@@ -1510,23 +2621,9 @@ void PiRT::updateTime()
         TimeTP.s = IPS_OK;
         IDSetText(&TimeTP, NULL);
 
-        struct ln_date date;
-        //struct tm *utc;
-
-        /* UT date and time */
-        date.years = utc->tm_year + 1900;
-        date.months = utc->tm_mon + 1;
-        date.days = utc->tm_mday;
-        date.hours = utc->tm_hour;
-        date.minutes = utc->tm_min;
-        date.seconds = utc->tm_sec;
-
-        double JD = ln_get_julian_day(&date);
-        JDN.value = JD;
+        JDN.value = timeBase.julianDay();
         JDNP.s = IPS_OK;
         IDSetNumber(&JDNP, NULL);
-        //       LocationNP.s = IPS_OK;
-        //       IDSetNumber(&LocationNP, NULL);
     }
 }
 
@@ -1535,187 +2632,59 @@ void PiRT::updateTime()
 ***************************************************************************************/
 bool PiRT::ReadScopeStatus()
 {
-    double dx = 0, dy = 0;
+    double targetAzRate = 0, targetAltRate = 0;
 
     updateTime();
 
-    //DEBUG(INDI::Logger::DBG_SESSION, "before encoder readout");
-    double azAbsTurns { 0. };
-    double altAbsTurns { 0. };
-
     // read pos encoders and update the horizontal coordinates, absolute turn values and properties
     updatePosition();
-    azAbsTurns = AxisAbsTurnsN[0].value;
-    altAbsTurns = AxisAbsTurnsN[1].value;
+
+    // the motion itself is run by the mount control loop, here only its events are handled
+    processControlEvents();
 
     // update motor status
     updateMotorStatus();
+    updateServoStatus();
 
     // update monitoring variables
     updateMonitoring();
 
-    const unsigned int MAX_TARGET_POINTING_CYCLES { 1 + MAX_TARGET_POINTING_IMPROVEMENT_TIME_MS / std::max(getCurrentPollingPeriod(), 10U) };
-
     // the state machine to handle all operation conditions:
     // SCOPE_IDLE, SCOPE_TRACKING, SCOPE_PARKING, SCOPE_PARKED and SCOPE_SLEWING
     switch (TrackState) {
     case SCOPE_TRACKING:
         TargetCoordSystem = SYSTEM_HOR;
-        targetHorizontalCoords = Equ2Hor(targetEquatorialCoords);
         [[fallthrough]];
     case SCOPE_PARKING:
         [[fallthrough]];
     case SCOPE_SLEWING:
-        if (TargetCoordSystem == SYSTEM_EQ) {
-            //Equ2Hor(targetRA, targetDEC, &targetAz, &targetAlt);
-            targetHorizontalCoords = Equ2Hor(targetEquatorialCoords);
-        } else if (TargetCoordSystem == SYSTEM_HOR) {
-        } else if (TargetCoordSystem == SYSTEM_GAL) {
-        } else {
-            // unknown coordinate system - abort
-            Abort();
-        }
-
-        //PiRaTe::RotAxis diffAz { -180, 180, 360};
-
-        // calculate the movement vector
-        dx = targetHorizontalCoords.Az.value() - currentHorizontalCoords.Az.value();
-        dy = targetHorizontalCoords.Alt.value() - currentHorizontalCoords.Alt.value();
-
-        // correct angles to valid range
-        if (dx > 180.) {
-            dx -= 360.;
-        } else if (dx < -180.) {
-            dx += 360.;
-        }
-
-        // this should never happen
-        if (dy > 180.) {
-            dy -= 360.;
-        } else if (dy < -180.) {
-            dy += 360.;
-        }
-
-        /*
-			DEBUGF(INDI::Logger::DBG_SESSION, "trg  Az=%f Alt=%f", targetHorizontalCoords.Az.value(), targetHorizontalCoords.Alt.value());
-			DEBUGF(INDI::Logger::DBG_SESSION, "curr Az=%f Alt=%f", currentHorizontalCoords.Az.value(), currentHorizontalCoords.Alt.value());
-			DEBUGF(INDI::Logger::DBG_SESSION, "initial dx=%f dy=%f", dx, dy);
-*/
-
-        // check, if the absolute position of the target is beyond the allowable limit
-        if (!isInAbsoluteTurnRangeAz(azAbsTurns + dx / 360.)) {
-            //DEBUGF(INDI::Logger::DBG_SESSION, "initial dx=%f dy=%f", dx, dy);
-            // if not, we still must be sure to turn into the right direction toward the allowable range
-            // e.g. if we are currently far in the forbidden range, make sure to not go further in
-            const double alt_dx = (dx > 0.) ? (dx - 360.) : (dx + 360.);
-            if (std::abs(azAbsTurns + dx / 360.) > std::abs(azAbsTurns + alt_dx / 360.)) {
-                dx = alt_dx;
-            }
-            //DEBUGF(INDI::Logger::DBG_SESSION, "allowed dx=%f dy=%f", dx, dy);
-        }
-
-        // do the actual movement
-        // in Az
-        if (std::abs(dx) > POS_ACCURACY_COARSE) {
-            az_motor->move((dx >= 0) ? 1. : -1.);
-        } else if (std::abs(dx) > POS_ACCURACY_FINE) {
-            double mot = dx / POS_ACCURACY_COARSE;
-            if (std::abs(mot) < MotorThresholdN[0].value / 100.) {
-                mot = (dx > 0.) ? MotorThresholdN[0].value / 100. : -MotorThresholdN[0].value / 100.;
-            }
-            az_motor->move(mot);
-        } else if (std::abs(dx) > TRACK_ACCURACY_AZ) {
-            az_motor->move((dx > 0.) ? MotorThresholdN[0].value / 100. : -MotorThresholdN[0].value / 100.);
-        } else
-            az_motor->stop();
-
-        // in Alt
-        if (std::abs(dy) > POS_ACCURACY_COARSE) {
-            el_motor->move((dy >= 0) ? 1. : -1.);
-        } else if (std::abs(dy) > POS_ACCURACY_FINE) {
-            double mot = dy / POS_ACCURACY_COARSE;
-            if (std::abs(mot) < MotorThresholdN[1].value / 100.) {
-                mot = (dy > 0.) ? MotorThresholdN[1].value / 100. : -MotorThresholdN[1].value / 100.;
-            }
-            el_motor->move(mot);
-        } else if (std::abs(dy) > TRACK_ACCURACY_ALT) {
-            el_motor->move((dy > 0.) ? MotorThresholdN[1].value / 100. : -MotorThresholdN[1].value / 100.);
-        } else
-            el_motor->stop();
-
-        // Let's check if we reached target position for both axes
-        if (std::abs(dx) < TRACK_ACCURACY_AZ
-            && std::abs(dy) < TRACK_ACCURACY_ALT
-            && (++targetPointingCycles > MAX_TARGET_POINTING_CYCLES)) {
-            if (TargetCoordSystem == SYSTEM_EQ) {
-                EqNP.s = IPS_OK;
-                IDSetNumber(&EqNP, nullptr);
-            } else if (TargetCoordSystem == SYSTEM_HOR) {
-                HorNP.s = lastHorState = IPS_OK;
-                IDSetNumber(&HorNP, nullptr);
-            }
-            if (TrackState == SCOPE_SLEWING) {
-                DEBUG(INDI::Logger::DBG_SESSION, "Telescope slew is complete.");
-            } else if (TrackState == SCOPE_PARKING) {
-                fIsTracking = false;
-                //TrackState = SCOPE_PARKED;
-                SetParked(true);
-            }
-            Abort();
-        } else {
-            //targetPointingCycles = 0;
+        if (TargetCoordSystem == SYSTEM_EQ || TrackState == SCOPE_TRACKING) {
+            // keep the target display up to date and refresh the tracking expansion
+            // of the control loop before it expires
+            const bool refresh { trackingEngine.isRefreshDue(timeBase.time()) };
+            trackingTarget(&targetHorizontalCoords, &targetAzRate, &targetAltRate);
+            if (refresh)
+                sendMotion(PiRaTe::MountController::Command::Type::UpdateTarget);
         }
         break;
     case SCOPE_PARKED:
     case SCOPE_IDLE:
     default:
-        //Abort();
         break;
     }
 
-    // check for axis limits and stop movement AND tracking, if motors are moving further into the forbidden range
-    // on the other hand, allow movement into the opposite direction only
-    // Az axis
-    if (azAbsTurns < -0.6 - MAX_AZ_OVERTURN) {
-        // no more movements towards negative direction allowed
-        DEBUGF(INDI::Logger::DBG_SESSION, "neg. Az overturn: azAbsTurns=%f limit=%f", azAbsTurns, -0.6 - MAX_AZ_OVERTURN);
-        if (az_motor->currentSpeed() < 0.) {
-            Abort();
-            fIsTracking = false;
-        }
-    } else if (azAbsTurns > 0.6 + MAX_AZ_OVERTURN) {
-        // no more movements towards positive direction allowed
-        DEBUGF(INDI::Logger::DBG_SESSION, "pos. Az overturn: azAbsTurns=%f limit=%f", azAbsTurns, 0.6 + MAX_AZ_OVERTURN);
-        if (az_motor->currentSpeed() > 0.) {
-            Abort();
-            fIsTracking = false;
-        }
-    }
-    // Alt axis
-    if (altAbsTurns < ALT_LIMIT_LOW) {
-        // no more movements towards negative direction allowed
-        if (el_motor->currentSpeed() < 0.) {
-            Abort();
-            if (fIsTracking)
-                TrackState = SCOPE_IDLE;
-            fIsTracking = false;
-        }
-    } else if (altAbsTurns > ALT_LIMIT_HI) {
-        // no more movements towards positive direction allowed
-        if (el_motor->currentSpeed() > 0.) {
-            Abort();
-            if (fIsTracking)
-                TrackState = SCOPE_IDLE;
-            fIsTracking = false;
-        }
-    }
+    // advance a running grid scan
+    updateScan();
+
+    // stream the measurement samples of this cycle to the data recorder
+    updateRecorder();
 
     /* update scope status */
     // update the telescope state lights
     for (int i = 0; i < 5; i++)
         ScopeStatusL[i].s = IPS_IDLE;
     ScopeStatusL[TrackState].s = IPS_OK;
-    IDSetLight(&ScopeStatusLP, NULL);
+    publishLight(&ScopeStatusLP, PUBLISH_MOTOR);
 
     // update horizontal coordinates
     if (HorN[AXIS_AZ].value != currentHorizontalCoords.Az.value()
@@ -1743,6 +2712,549 @@ bool PiRT::ReadScopeStatus()
     return true;
 }
 
+/**************************************************************************************
+** Start a grid scan with the window and settings from the scan properties
+***************************************************************************************/
+bool PiRT::startScan(PiRaTe::ScanEngine::CoordSystem system)
+{
+    if (isParked()) {
+        DEBUG(INDI::Logger::DBG_WARNING, "Please unpark the mount before starting a scan.");
+        return false;
+    }
+    PiRaTe::ScanEngine::Window window {};
+    window.min1 = ScanWindowN[0].value;
+    window.max1 = ScanWindowN[1].value;
+    window.min2 = ScanWindowN[2].value;
+    window.max2 = ScanWindowN[3].value;
+    window.step1 = ScanSettingN[0].value;
+    window.step2 = ScanSettingN[1].value;
+    const std::chrono::milliseconds int_time { static_cast<long int>(ScanSettingN[2].value * 1000) };
+
+    if (system == PiRaTe::ScanEngine::CoordSystem::Horizontal && window.min2 < 0.) {
+        DEBUG(INDI::Logger::DBG_ERROR, "Scan window below horizon.");
+        return false;
+    }
+    const auto mode { (ScanModeS[SCAN_OTF].s == ISS_ON) ? PiRaTe::ScanEngine::Mode::Otf : PiRaTe::ScanEngine::Mode::Grid };
+    if (!scanEngine.start(system, mode, window, int_time, ScanFileT[0].text)) {
+        DEBUGF(INDI::Logger::DBG_ERROR, "Failed to start scan with output file %s", ScanFileT[0].text);
+        return false;
+    }
+
+    // the scan positions are approached one by one, so switch off tracking
+    fIsTracking = false;
+
+    // apply the integration time of the scan to the measurements
+    // in OTF mode the measurement buffers must hold at least the samples of one poll interval
+    const auto meas_int_time { (mode == PiRaTe::ScanEngine::Mode::Otf) ? std::max(int_time, MIN_SAMPLE_BUFFER_TIME) : int_time };
+    for (auto meas : voltageMeasurements) {
+        meas->setIntTime(meas_int_time);
+    }
+    MeasurementIntTimeN.value = meas_int_time.count() / 1000.;
+    MeasurementIntTimeNP.s = IPS_OK;
+    IDSetNumber(&MeasurementIntTimeNP, nullptr);
+
+    DEBUGF(INDI::Logger::DBG_SESSION, "Starting %s %s scan with %u %s, output to %s",
+        (system == PiRaTe::ScanEngine::CoordSystem::Horizontal) ? "horizontal" : "equatorial",
+        (mode == PiRaTe::ScanEngine::Mode::Otf) ? "OTF" : "grid",
+        static_cast<unsigned int>(scanEngine.nrPoints()),
+        (mode == PiRaTe::ScanEngine::Mode::Otf) ? "rows" : "points", ScanFileT[0].text);
+
+    ScanStatusN[0].value = 0;
+    ScanStatusN[1].value = scanEngine.nrPoints();
+    ScanStatusNP.s = IPS_BUSY;
+    IDSetNumber(&ScanStatusNP, nullptr);
+    ScanControlSP.s = IPS_BUSY;
+    IDSetSwitch(&ScanControlSP, nullptr);
+
+    if (!gotoScanPoint()) {
+        stopScan();
+        return false;
+    }
+    return true;
+}
+
+/**************************************************************************************
+** Terminate a running grid scan
+***************************************************************************************/
+void PiRT::stopScan()
+{
+    if (scanEngine.isActive()) {
+        scanEngine.stop();
+        Abort();
+        DEBUGF(INDI::Logger::DBG_SESSION, "Scan stopped at point %u of %u.",
+            static_cast<unsigned int>(scanEngine.pointIndex() + 1), static_cast<unsigned int>(scanEngine.nrPoints()));
+        ScanStatusNP.s = IPS_ALERT;
+        IDSetNumber(&ScanStatusNP, nullptr);
+    }
+    IUResetSwitch(&ScanControlSP);
+    ScanControlS[SCAN_STOP].s = ISS_ON;
+    ScanControlSP.s = IPS_IDLE;
+    IDSetSwitch(&ScanControlSP, nullptr);
+}
+
+/**************************************************************************************
+** Issue a goto to the current grid point of the scan
+***************************************************************************************/
+bool PiRT::gotoScanPoint()
+{
+    const auto point { scanEngine.currentPoint() };
+    if (scanEngine.coordSystem() == PiRaTe::ScanEngine::CoordSystem::Horizontal) {
+        if (!GotoHor(point.c1, point.c2))
+            return false;
+        HorNP.s = lastHorState = IPS_BUSY;
+        IDSetNumber(&HorNP, nullptr);
+        return true;
+    }
+    if (isParked()) {
+        DEBUG(INDI::Logger::DBG_WARNING, "Please unpark the mount before issuing any motion/sync commands.");
+        return false;
+    }
+    if (!Goto(point.c1, point.c2))
+        return false;
+    EqNP.s = IPS_BUSY;
+    IDSetNumber(&EqNP, nullptr);
+    return true;
+}
+
+/**************************************************************************************
+** Advance the grid scan state machine, called from ReadScopeStatus
+***************************************************************************************/
+void PiRT::updateScan()
+{
+    if (!scanEngine.isActive())
+        return;
+
+    if (TrackState == SCOPE_PARKING || TrackState == SCOPE_PARKED) {
+        DEBUG(INDI::Logger::DBG_WARNING, "Scope parking - terminating scan.");
+        stopScan();
+        return;
+    }
+
+    const auto now { timeBase.time() };
+    if (scanEngine.state() == PiRaTe::ScanEngine::State::Slewing) {
+        // the goto of the current grid point is complete when the mount left the slewing state
+        if (TrackState != SCOPE_SLEWING) {
+            scanEngine.targetReached(now);
+            lastScanSampleTime = now;
+        }
+        return;
+    }
+
+    if (scanEngine.state() == PiRaTe::ScanEngine::State::Sweeping) {
+        recordSweepSamples();
+        if (!sweepRowDone(now)) {
+            followSweep(now);
+            return;
+        }
+        ScanStatusN[0].value = scanEngine.pointIndex() + 1;
+        IDSetNumber(&ScanStatusNP, nullptr);
+    } else if (!scanEngine.integrationDone(now)) {
+        return;
+    } else {
+        PiRaTe::ScanEngine::Record record {};
+        record.time = now;
+        record.az = currentHorizontalCoords.Az.value();
+        record.alt = currentHorizontalCoords.Alt.value();
+        Hor2Equ(currentHorizontalCoords, &record.ra, &record.dec);
+        if (voltageMeasurements.size() > 0 && voltageMeasurements[0]->isInitialized())
+            record.adc1 = voltageMeasurements[0]->meanValue();
+        if (voltageMeasurements.size() > 1 && voltageMeasurements[1]->isInitialized())
+            record.adc2 = voltageMeasurements[1]->meanValue();
+        if (TempMonitorNP.nnp > 1)
+            record.temp1 = TempMonitorN[1].value;
+        if (TempMonitorNP.nnp > 2)
+            record.temp2 = TempMonitorN[2].value;
+        scanEngine.writeRecord(record);
+
+        ScanStatusN[0].value = scanEngine.pointIndex() + 1;
+        IDSetNumber(&ScanStatusNP, nullptr);
+    }
+
+    if (!scanEngine.advance()) {
+        DEBUGF(INDI::Logger::DBG_SESSION, "Scan finished, data written to %s", ScanFileT[0].text);
+        // stop following the end of the last OTF row
+        if (TrackState == SCOPE_SLEWING)
+            Abort();
+        ScanStatusNP.s = IPS_OK;
+        IDSetNumber(&ScanStatusNP, nullptr);
+        IUResetSwitch(&ScanControlSP);
+        ScanControlS[SCAN_STOP].s = ISS_ON;
+        ScanControlSP.s = IPS_OK;
+        IDSetSwitch(&ScanControlSP, nullptr);
+        return;
+    }
+    if (!gotoScanPoint()) {
+        DEBUG(INDI::Logger::DBG_ERROR, "Scan point not reachable - terminating scan.");
+        stopScan();
+    }
+}
+
+/**************************************************************************************
+** Move the target of an OTF scan along the current row
+***************************************************************************************/
+void PiRT::followSweep(std::chrono::time_point<std::chrono::system_clock> now)
+{
+    const auto point { scanEngine.sweepPoint(now) };
+    // the control loop extrapolates the target along the row in between the polls
+    const auto later { now + std::chrono::seconds(1) };
+    const auto next { scanEngine.sweepPoint(later) };
+    double azRate { 0. }, altRate { 0. };
+    if (scanEngine.coordSystem() == PiRaTe::ScanEngine::CoordSystem::Horizontal) {
+        targetHorizontalCoords = HorCoords { point.c1, point.c2 };
+        azRate = std::remainder(next.c1 - point.c1, 360.);
+        altRate = next.c2 - point.c2;
+    } else {
+        // an equatorial row is followed as horizontal segment, whose rates combine the row rate and the sidereal motion
+        targetEquatorialCoords = EquCoords { point.c1, point.c2 };
+        double az { 0. }, alt { 0. }, next_az { 0. }, next_alt { 0. };
+        Equ2Hor(point.c1, point.c2, PiRaTe::TimeBase::julianDay(now), &az, &alt);
+        Equ2Hor(next.c1, next.c2, PiRaTe::TimeBase::julianDay(later), &next_az, &next_alt);
+        targetHorizontalCoords = HorCoords { az, alt };
+        azRate = std::remainder(next_az - az, 360.);
+        altRate = next_alt - alt;
+    }
+    TargetCoordSystem = SYSTEM_HOR;
+    // keep the state machine in slewing state, the moving target is followed continuously without completion
+    TrackState = SCOPE_SLEWING;
+    sendMotion(PiRaTe::MountController::Command::Type::Track, azRate, altRate);
+}
+
+/**************************************************************************************
+** Check whether the encoder position passed the end of the current OTF row
+***************************************************************************************/
+bool PiRT::sweepRowDone(std::chrono::time_point<std::chrono::system_clock> now)
+{
+    const HorCoords pos { horizontalCoordsAt(now) };
+    if (scanEngine.coordSystem() == PiRaTe::ScanEngine::CoordSystem::Horizontal)
+        return scanEngine.sweepDone(now, pos.Az.value(), TRACK_ACCURACY_AZ);
+    double ra { 0. }, dec { 0. };
+    Hor2Equ(pos.Az.value(), pos.Alt.value(), PiRaTe::TimeBase::julianDay(now), &ra, &dec);
+    // an RA offset corresponds to a smaller angle on the sky by cos(dec)
+    const double tolerance { TRACK_ACCURACY_AZ / 15. / std::max(std::cos(dec * M_PI / 180.), 0.1) };
+    return scanEngine.sweepDone(now, ra, tolerance);
+}
+
+/**************************************************************************************
+** Write the measurement samples acquired during an OTF sweep, each tagged with the
+** encoder position interpolated to the sample time
+***************************************************************************************/
+void PiRT::recordSweepSamples()
+{
+    if (voltageMeasurements.empty() || !voltageMeasurements[0]->isInitialized())
+        return;
+    const auto samples { voltageMeasurements[0]->samplesSince(lastScanSampleTime) };
+    if (samples.empty())
+        return;
+    std::vector<PiRaTe::Ads1115Measurement::Sample> aux_samples {};
+    if (voltageMeasurements.size() > 1 && voltageMeasurements[1]->isInitialized())
+        aux_samples = voltageMeasurements[1]->samplesSince(lastScanSampleTime - std::chrono::seconds(1));
+    auto aux_it { aux_samples.cbegin() };
+
+    for (const auto& sample : samples) {
+        // outliers and samples taken with the calibration source on are left out of the scan,
+        // they are kept in the data recorder only
+        if (sample.flagged || (calibration != nullptr && calibration->isCalibrationSample(sample.time)))
+            continue;
+        PiRaTe::ScanEngine::Record record {};
+        record.time = sample.time;
+        const HorCoords pos { horizontalCoordsAt(sample.time) };
+        record.az = pos.Az.value();
+        record.alt = pos.Alt.value();
+        Hor2Equ(pos.Az.value(), pos.Alt.value(), PiRaTe::TimeBase::julianDay(sample.time), &record.ra, &record.dec);
+        record.adc1 = sample.value;
+        // take the latest sample of the auxiliary channel acquired until the time of this sample
+        while (aux_it != aux_samples.cend() && std::next(aux_it) != aux_samples.cend() && std::next(aux_it)->time <= sample.time)
+            ++aux_it;
+        if (aux_it != aux_samples.cend() && !aux_it->flagged)
+            record.adc2 = aux_it->value;
+        if (TempMonitorNP.nnp > 1)
+            record.temp1 = TempMonitorN[1].value;
+        if (TempMonitorNP.nnp > 2)
+            record.temp2 = TempMonitorN[2].value;
+        scanEngine.writeRecord(record);
+    }
+    lastScanSampleTime = samples.back().time;
+}
+
+/**************************************************************************************
+** Switch the first measurement channel between polled single-shot conversions and
+** continuous conversions which are fetched on the data-ready edges of the ADC
+***************************************************************************************/
+bool PiRT::applyMeasurementMode(bool continuous)
+{
+    if (voltageMeasurements.empty() || !gpio || !gpio->is_initialised())
+        return !continuous;
+    auto meas { voltageMeasurements[0] };
+    if (!continuous) {
+        meas->stopContinuousMode();
+        gpio->unRegisterInterrupt(MEASUREMENT_ADC_RDY_PIN);
+        gpio->set_event_callback(nullptr);
+        if (adcScheduler != nullptr)
+            adcScheduler->setEnabled(meas->adc(), meas->adcChannel(), true);
+        updateMeasurementSampleRates();
+        return true;
+    }
+    if (meas->isContinuousMode())
+        return true;
+    // the ALERT/RDY output is open-drain and pulses low at the end of each conversion
+    gpio->set_event_callback([meas](unsigned int gpio_pin, PiRaTe::Gpio::timestamp_t timestamp) {
+        if (gpio_pin == MEASUREMENT_ADC_RDY_PIN)
+            meas->dataReady(timestamp);
+    });
+    // up to 860 edges per second, so the events are processed in the line's thread
+    if (!gpio->registerInterrupt(MEASUREMENT_ADC_RDY_PIN, PiRaTe::Gpio::EventEdge::EVENT_FALLING_EDGE, PiRaTe::Gpio::PinBias::FLAG_BIAS_PULL_UP, true)) {
+        DEBUGF(INDI::Logger::DBG_ERROR, "Failed to register data-ready interrupt on GPIO%u.", MEASUREMENT_ADC_RDY_PIN);
+        gpio->set_event_callback(nullptr);
+        return false;
+    }
+    if (!meas->startContinuousMode()) {
+        DEBUGF(INDI::Logger::DBG_ERROR, "Failed to start continuous conversions of %s.", meas->name().c_str());
+        gpio->unRegisterInterrupt(MEASUREMENT_ADC_RDY_PIN);
+        gpio->set_event_callback(nullptr);
+        return false;
+    }
+    // the channel is converted continuously now, so remove it from the conversion plan
+    if (adcScheduler != nullptr)
+        adcScheduler->setEnabled(meas->adc(), meas->adcChannel(), false);
+    updateMeasurementSampleRates();
+    DEBUGF(INDI::Logger::DBG_SESSION, "Continuous conversions of %s with data-ready interrupt on GPIO%u.", meas->name().c_str(), MEASUREMENT_ADC_RDY_PIN);
+    return true;
+}
+
+/**************************************************************************************
+** Start the data recorder with the output file from the recorder properties
+***************************************************************************************/
+bool PiRT::startRecorder()
+{
+    if (voltageMeasurements.empty()) {
+        DEBUG(INDI::Logger::DBG_ERROR, "No measurement channels available for recording.");
+        return false;
+    }
+    if (!recorder.start(RecorderFileT[0].text)) {
+        DEBUGF(INDI::Logger::DBG_ERROR, "Failed to start recording to %s (the file must not exist yet)", RecorderFileT[0].text);
+        return false;
+    }
+    // every sample is queued for the recorder, so stalls of the poll loop do not drop samples from the recording
+    for (auto meas : voltageMeasurements) {
+        meas->setSampleQueue(RECORDER_QUEUE_SIZE);
+    }
+    recorderLostSamples = 0;
+
+    DEBUGF(INDI::Logger::DBG_SESSION, "Recording %u measurement channels to %s",
+        static_cast<unsigned int>(voltageMeasurements.size()), RecorderFileT[0].text);
+    RecorderStatusN[0].value = RecorderStatusN[1].value = RecorderStatusN[2].value = 0;
+    RecorderStatusNP.s = IPS_BUSY;
+    IDSetNumber(&RecorderStatusNP, nullptr);
+    RecorderControlSP.s = IPS_BUSY;
+    IDSetSwitch(&RecorderControlSP, nullptr);
+    return true;
+}
+
+/**************************************************************************************
+** Stop the data recorder
+***************************************************************************************/
+void PiRT::stopRecorder()
+{
+    if (recorder.isActive()) {
+        // write out the samples queued since the last cycle
+        updateRecorder();
+        recorder.stop();
+        for (auto meas : voltageMeasurements) {
+            meas->setSampleQueue(0);
+        }
+        RecorderStatusN[0].value = recorder.nrSamples();
+        RecorderStatusN[1].value = recorder.nrBytes() / 1e6;
+        RecorderStatusNP.s = (recorder.isFault()) ? IPS_ALERT : IPS_OK;
+        IDSetNumber(&RecorderStatusNP, nullptr);
+        DEBUGF(INDI::Logger::DBG_SESSION, "Recording stopped, %lu samples written to %s",
+            static_cast<unsigned long>(recorder.nrSamples()), RecorderFileT[0].text);
+    }
+    IUResetSwitch(&RecorderControlSP);
+    RecorderControlS[RECORDER_STOP].s = ISS_ON;
+    RecorderControlSP.s = IPS_IDLE;
+    IDSetSwitch(&RecorderControlSP, nullptr);
+}
+
+/**************************************************************************************
+** Start switching the reference output and the synchronous detection
+** on the first measurement channel
+***************************************************************************************/
+bool PiRT::startLockIn()
+{
+    if (lockIn == nullptr || voltageMeasurements.empty()) {
+        DEBUG(INDI::Logger::DBG_ERROR, "No measurement channel available for lock-in detection.");
+        return false;
+    }
+    if (!lockIn->isActive() && isOutputInUse(LOCKIN_REF_OUTPUT_INDEX)) {
+        DEBUGF(INDI::Logger::DBG_ERROR, "Output %s is in use by the calibration.", GpioOutputVector[LOCKIN_REF_OUTPUT_INDEX].name.c_str());
+        return false;
+    }
+    const std::chrono::milliseconds blanking { static_cast<long int>(LockInSettingN[1].value) };
+    if (blanking.count() >= 500. / LockInSettingN[0].value) {
+        DEBUG(INDI::Logger::DBG_ERROR, "Lock-in blanking time exceeds the half period of the reference.");
+        return false;
+    }
+    if (!lockIn->start(LockInSettingN[0].value, blanking)) {
+        DEBUG(INDI::Logger::DBG_ERROR, "Failed to start switching of the reference output.");
+        return false;
+    }
+    OutputSwitchS[LOCKIN_REF_OUTPUT_INDEX].s = ISS_OFF;
+    OutputSwitchSP.s = IPS_BUSY;
+    IDSetSwitch(&OutputSwitchSP, nullptr);
+    DEBUGF(INDI::Logger::DBG_SESSION, "Lock-in detection started with %5.2f Hz reference on %s",
+        lockIn->frequency(), GpioOutputVector[LOCKIN_REF_OUTPUT_INDEX].name.c_str());
+    LockInResultNP.s = IPS_BUSY;
+    IDSetNumber(&LockInResultNP, nullptr);
+    LockInControlSP.s = IPS_BUSY;
+    IDSetSwitch(&LockInControlSP, nullptr);
+    return true;
+}
+
+/**************************************************************************************
+** Stop the lock-in detection, the reference output is left switched off
+***************************************************************************************/
+void PiRT::stopLockIn()
+{
+    if (lockIn != nullptr && lockIn->isActive()) {
+        lockIn->stop();
+        OutputSwitchSP.s = IPS_IDLE;
+        IDSetSwitch(&OutputSwitchSP, nullptr);
+        LockInResultNP.s = IPS_OK;
+        IDSetNumber(&LockInResultNP, nullptr);
+        DEBUG(INDI::Logger::DBG_SESSION, "Lock-in detection stopped");
+    }
+    IUResetSwitch(&LockInControlSP);
+    LockInControlS[LOCKIN_STOP].s = ISS_ON;
+    LockInControlSP.s = IPS_IDLE;
+    IDSetSwitch(&LockInControlSP, nullptr);
+}
+
+/**************************************************************************************
+** Start the periodic calibration with the settings from the calibration properties
+***************************************************************************************/
+bool PiRT::startCalibration()
+{
+    if (calibration == nullptr || voltageMeasurements.empty()) {
+        DEBUG(INDI::Logger::DBG_ERROR, "No measurement channel available for calibration.");
+        return false;
+    }
+    const std::size_t cal_output { static_cast<std::size_t>(CalibrationSettingN[4].value) };
+    if (calibration->pin() != GpioOutputVector[cal_output].gpio_pin) {
+        // the calibration source output was changed, the scheduler is set up again
+        calibration->stop();
+        auto cal { std::make_shared<PiRaTe::CalibrationScheduler>(gpio, GpioOutputVector[cal_output].gpio_pin, GpioOutputVector[cal_output].inverted) };
+        std::lock_guard<std::mutex> lock(calibrationMutex);
+        calibration = std::move(cal);
+    }
+    if (lockIn != nullptr && lockIn->isActive() && lockIn->refPin() == calibration->pin()) {
+        DEBUGF(INDI::Logger::DBG_ERROR, "Output %s is in use by the lock-in detection.", GpioOutputVector[cal_output].name.c_str());
+        return false;
+    }
+    PiRaTe::CalibrationScheduler::Settings settings {};
+    settings.interval = std::chrono::seconds(static_cast<long int>(CalibrationSettingN[0].value));
+    settings.duration = std::chrono::milliseconds(static_cast<long int>(CalibrationSettingN[1].value * 1000));
+    settings.settle = std::chrono::milliseconds(static_cast<long int>(CalibrationSettingN[2].value));
+    settings.tcal = CalibrationSettingN[3].value;
+    settings.logarithmic = logarithmicDetector;
+    if (!calibration->start(settings)) {
+        DEBUG(INDI::Logger::DBG_ERROR, "Failed to start the periodic calibration.");
+        return false;
+    }
+    OutputSwitchS[cal_output].s = ISS_OFF;
+    OutputSwitchSP.s = IPS_BUSY;
+    IDSetSwitch(&OutputSwitchSP, nullptr);
+    DEBUGF(INDI::Logger::DBG_SESSION, "Periodic calibration started every %.0f s with %s", CalibrationSettingN[0].value, GpioOutputVector[cal_output].name.c_str());
+    CalibrationControlSP.s = IPS_BUSY;
+    IDSetSwitch(&CalibrationControlSP, nullptr);
+    return true;
+}
+
+/**************************************************************************************
+** Stop the periodic calibration, the calibration source is left switched off
+***************************************************************************************/
+void PiRT::stopCalibration()
+{
+    if (calibration != nullptr && calibration->isActive()) {
+        calibration->stop();
+        OutputSwitchSP.s = IPS_IDLE;
+        IDSetSwitch(&OutputSwitchSP, nullptr);
+        DEBUG(INDI::Logger::DBG_SESSION, "Periodic calibration stopped");
+    }
+    IUResetSwitch(&CalibrationControlSP);
+    CalibrationControlS[CAL_STOP].s = ISS_ON;
+    CalibrationControlSP.s = IPS_IDLE;
+    IDSetSwitch(&CalibrationControlSP, nullptr);
+}
+
+/**************************************************************************************
+** Check whether a gpio output is switched by the lock-in detection or the calibration
+***************************************************************************************/
+bool PiRT::isOutputInUse(std::size_t output_index)
+{
+    if (output_index >= GpioOutputVector.size())
+        return false;
+    const unsigned int pin { GpioOutputVector[output_index].gpio_pin };
+    return ((lockIn != nullptr && lockIn->isActive() && lockIn->refPin() == pin)
+        || (calibration != nullptr && calibration->isActive() && calibration->pin() == pin));
+}
+
+/**************************************************************************************
+** Hand the measurement samples acquired since the last cycle over to the data recorder,
+** each tagged with the encoder position interpolated to the sample time
+***************************************************************************************/
+void PiRT::updateRecorder()
+{
+    if (!recorder.isActive())
+        return;
+    std::vector<PiRaTe::DataRecorder::Sample> samples {};
+    std::vector<PiRaTe::Ads1115Measurement::Sample> queued {};
+    for (std::size_t channel { 0 }; channel < voltageMeasurements.size(); ++channel) {
+        queued.clear();
+        const std::size_t lost { voltageMeasurements[channel]->takeQueuedSamples(queued) };
+        if (lost > 0) {
+            recorderLostSamples += lost;
+            DEBUGF(INDI::Logger::DBG_WARNING, "Recorder lost %lu samples of measurement channel %u", static_cast<unsigned long>(lost), static_cast<unsigned int>(channel));
+        }
+        for (const auto& sample : queued) {
+            PiRaTe::DataRecorder::Sample record {};
+            record.time = sample.time;
+            record.channel = static_cast<unsigned int>(channel);
+            record.value = sample.value;
+            if (sample.flagged)
+                record.flags |= PiRaTe::DataRecorder::FlagOutlier;
+            if (calibration != nullptr && calibration->isCalibrationSample(sample.time))
+                record.flags |= PiRaTe::DataRecorder::FlagCalibration;
+            // the first sample behind the lost ones marks the gap
+            if (lost > 0 && &sample == &queued.front())
+                record.flags |= PiRaTe::DataRecorder::FlagGap;
+            samples.push_back(record);
+        }
+    }
+    // the converter relies on time-ordered samples of all channels
+    std::sort(samples.begin(), samples.end(), [](const auto& a, const auto& b) { return a.time < b.time; });
+    for (auto& sample : samples) {
+        const HorCoords pos { horizontalCoordsAt(sample.time) };
+        sample.az = pos.Az.value();
+        sample.alt = pos.Alt.value();
+        Hor2Equ(sample.az, sample.alt, PiRaTe::TimeBase::julianDay(sample.time), &sample.ra, &sample.dec);
+        if (TempMonitorNP.nnp > 1)
+            sample.temp1 = TempMonitorN[1].value;
+        if (TempMonitorNP.nnp > 2)
+            sample.temp2 = TempMonitorN[2].value;
+        recorder.append(sample);
+    }
+
+    if (recorder.isFault() && RecorderStatusNP.s != IPS_ALERT) {
+        DEBUGF(INDI::Logger::DBG_ERROR, "Error writing to recorder file %s", RecorderFileT[0].text);
+        RecorderStatusNP.s = IPS_ALERT;
+    }
+    RecorderStatusN[0].value = recorder.nrSamples();
+    RecorderStatusN[1].value = recorder.nrBytes() / 1e6;
+    // samples lost in the measurement queues and samples dropped by the recorder when the storage stalls
+    RecorderStatusN[2].value = recorderLostSamples + recorder.nrDropped();
+    publishNumber(&RecorderStatusNP, PUBLISH_MONITOR);
+}
+
 auto PiRT::upTime() const -> std::chrono::duration<long, std::ratio<1>>
 {
     auto now { std::chrono::system_clock::now() };
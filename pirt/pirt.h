@@ -14,12 +14,26 @@
 #pragma once
 
 #include "inditelescope.h"
+#include <adcscheduler.h>
 #include <ads1115_measurement.h>
 #include <axis.h>
+#include <calibration.h>
+#include <encoder.h>
+#include <encodergroup.h>
+#include <lockin.h>
+#include <mountcontrol.h>
+#include <publisher.h>
+#include <recorder.h>
 #include <rpi_temperatures.h>
+#include <scanengine.h>
+#include <servo.h>
+#include <timebase.h>
+#include <tracking.h>
 #include <voltage_monitor.h>
 
+#include <deque>
 #include <map>
+#include <mutex>
 
 struct HorCoords {
     HorCoords()
@@ -54,7 +68,6 @@ struct EquCoords {
 
 namespace PiRaTe {
     class Gpio;
-    class SsiPosEncoder;
     class MotorDriver;
     class i2cDevice;
     class ADS1115;
@@ -74,6 +87,49 @@ public:
         AXIS_ALT
     };
 
+    enum {
+        SCAN_HOR,
+        SCAN_EQU,
+        SCAN_STOP
+    };
+
+    enum {
+        SCAN_GRID,
+        SCAN_OTF
+    };
+
+    enum {
+        RECORDER_START,
+        RECORDER_STOP
+    };
+
+    enum {
+        MEAS_POLLED,
+        MEAS_CONTINUOUS
+    };
+
+    enum {
+        CAL_START,
+        CAL_STOP
+    };
+
+    enum {
+        LOCKIN_START,
+        LOCKIN_STOP
+    };
+
+    enum {
+        PUBLISH_POSITION,
+        PUBLISH_MOTOR,
+        PUBLISH_MONITOR
+    };
+
+    enum {
+        ADC_GROUP_MEAS,
+        ADC_GROUP_MOTOR,
+        ADC_GROUP_MONITOR
+    };
+
     PiRT();
     //~PiRT() override;
 
@@ -82,6 +138,7 @@ public:
     void TimerHit() override;
     virtual bool ISNewSwitch(const char* dev, const char* name, ISState* states, char* names[], int n) override;
     virtual bool ISNewNumber(const char* dev, const char* name, double values[], char* names[], int n) override;
+    virtual bool ISNewText(const char* dev, const char* name, char* texts[], char* names[], int n) override;
     virtual bool ISSnoopDevice(XMLEle* root) override;
     virtual bool saveConfigItems(FILE *fp) override;
 
@@ -107,18 +164,56 @@ protected:
 
 private:
     void Hor2Equ(double az, double alt, double* ra, double* dec);
+    void Hor2Equ(double az, double alt, double JD, double* ra, double* dec);
     void Hor2Equ(const HorCoords& hor_coords, double* ra, double* dec);
     void Equ2Hor(double ra, double dec, double* az, double* alt);
+    void Equ2Hor(double ra, double dec, double JD, double* az, double* alt);
     HorCoords Equ2Hor(const EquCoords& equ_coords);
     EquCoords Hor2Equ(const HorCoords& hor_coords);
     bool isInAbsoluteTurnRangeAz(double absRev);
     bool isInAbsoluteTurnRangeAlt(double absRev);
 
     void updatePosition();
+    void applyEncoderReadoutSettings();
+    void applyAdcScheduleSettings();
+    void updateMeasurementSampleRates();
+    void applyFilterSettings();
+    void applyOutlierSettings();
+    void applyPublishSettings();
+    void publishNumber(INumberVectorProperty* nvp, std::size_t group);
+    void publishLight(ILightVectorProperty* lvp, std::size_t group);
+    void encoderToAbsTurns(double az_revolutions, double el_revolutions, double* azAbsTurns, double* altAbsTurns) const;
+    void appendPositionHistory(const PiRaTe::SsiPosEncoder& encoder,
+        const std::vector<PiRaTe::SsiPosEncoder::Sample>& samples,
+        std::deque<PiRaTe::SsiPosEncoder::PositionSample>& history);
+    HorCoords horizontalCoordsAt(std::chrono::time_point<std::chrono::system_clock> time);
     void updateMotorStatus();
+    void updateServoStatus();
+    void applyServoSettings();
+    void applyControlSettings();
+    void trackingTarget(HorCoords* coords, double* azRate, double* altRate);
+    bool sendMotion(PiRaTe::MountController::Command::Type type, double azRate = 0., double altRate = 0.);
+    bool sendManualMotion(std::size_t axis, double speed);
+    void processControlEvents();
     void updateMonitoring();
     void updateTemperatures(PiRaTe::RpiTemperatureMonitor::TemperatureItem item);
     void updateTime();
+    void updateScan();
+    bool startScan(PiRaTe::ScanEngine::CoordSystem system);
+    void stopScan();
+    bool gotoScanPoint();
+    void followSweep(std::chrono::time_point<std::chrono::system_clock> now);
+    bool sweepRowDone(std::chrono::time_point<std::chrono::system_clock> now);
+    void recordSweepSamples();
+    void updateRecorder();
+    bool applyMeasurementMode(bool continuous);
+    bool startRecorder();
+    void stopRecorder();
+    bool startLockIn();
+    void stopLockIn();
+    bool startCalibration();
+    void stopCalibration();
+    bool isOutputInUse(std::size_t output_index);
     auto upTime() const -> std::chrono::duration<long, std::ratio<1>>;
 
     ILight ScopeStatusL[5];
@@ -131,12 +226,14 @@ private:
     INumber EncoderBitRateN;
     INumberVectorProperty EncoderBitRateNP;
 
-    INumber AzEncoderN[5];
-    INumber ElEncoderN[5];
+    INumber AzEncoderN[8];
+    INumber ElEncoderN[8];
     INumberVectorProperty AzEncoderNP;
     INumberVectorProperty ElEncoderNP;
     INumber AzEncSettingN[2], ElEncSettingN[2];
     INumberVectorProperty AzEncSettingNP, ElEncSettingNP;
+    INumber EncoderReadoutN[3];
+    INumberVectorProperty EncoderReadoutNP;
 
     INumber AzAxisSettingN[2], ElAxisSettingN[2];
     INumberVectorProperty AzAxisSettingNP, ElAxisSettingNP;
@@ -153,13 +250,54 @@ private:
     INumber MotorCurrentLimitN[2];
     INumberVectorProperty MotorCurrentLimitNP;
 
+    INumber AzServoGainN[4], ElServoGainN[4];
+    INumberVectorProperty AzServoGainNP, ElServoGainNP;
+    INumber ServoSettingN[1];
+    INumberVectorProperty ServoSettingNP;
+    INumber SlewLimitN[4];
+    INumberVectorProperty SlewLimitNP;
+    INumber AzServoStatusN[4], ElServoStatusN[4];
+    INumberVectorProperty AzServoStatusNP, ElServoStatusNP;
+
     INumber VoltageMonitorN[64];
     INumberVectorProperty VoltageMonitorNP;
 
     INumber VoltageMeasurementN[16];
     INumberVectorProperty VoltageMeasurementNP;
+    INumber MeasurementStatsN[64];
+    INumberVectorProperty MeasurementStatsNP;
+    INumber FilteredMeasurementN[16];
+    INumberVectorProperty FilteredMeasurementNP;
+    INumber FilterSettingN[4];
+    INumberVectorProperty FilterSettingNP;
+    INumber OutlierSettingN[2];
+    INumberVectorProperty OutlierSettingNP;
+    INumber OutlierStatusN[32];
+    INumberVectorProperty OutlierStatusNP;
     INumber MeasurementIntTimeN;
     INumberVectorProperty MeasurementIntTimeNP;
+    ISwitch MeasurementModeS[2];
+    ISwitchVectorProperty MeasurementModeSP;
+    INumber AdcScheduleN[4];
+    INumberVectorProperty AdcScheduleNP;
+    INumber AdcScheduleStatusN[3];
+    INumberVectorProperty AdcScheduleStatusNP;
+    INumber LockInSettingN[2];
+    INumberVectorProperty LockInSettingNP;
+    ISwitch LockInControlS[2];
+    ISwitchVectorProperty LockInControlSP;
+    INumber LockInResultN[5];
+    INumberVectorProperty LockInResultNP;
+    INumber CalibrationSettingN[5];
+    INumberVectorProperty CalibrationSettingNP;
+    ISwitch CalibrationControlS[2];
+    ISwitchVectorProperty CalibrationControlSP;
+    INumber CalibrationStatusN[4];
+    INumberVectorProperty CalibrationStatusNP;
+    INumber PublishSettingN[4];
+    INumberVectorProperty PublishSettingNP;
+    INumber PublishStatusN[2];
+    INumberVectorProperty PublishStatusNP;
 
     INumber TempMonitorN[64];
     INumberVectorProperty TempMonitorNP;
@@ -182,6 +320,26 @@ private:
     ISwitch ErrorResetS;
     ISwitchVectorProperty ErrorResetSP;
 
+    INumber ScanWindowN[4];
+    INumberVectorProperty ScanWindowNP;
+    INumber ScanSettingN[3];
+    INumberVectorProperty ScanSettingNP;
+    IText ScanFileT[1] {};
+    ITextVectorProperty ScanFileTP;
+    ISwitch ScanControlS[3];
+    ISwitchVectorProperty ScanControlSP;
+    ISwitch ScanModeS[2];
+    ISwitchVectorProperty ScanModeSP;
+    INumber ScanStatusN[2];
+    INumberVectorProperty ScanStatusNP;
+
+    IText RecorderFileT[1] {};
+    ITextVectorProperty RecorderFileTP;
+    ISwitch RecorderControlS[2];
+    ISwitchVectorProperty RecorderControlSP;
+    INumber RecorderStatusN[3];
+    INumberVectorProperty RecorderStatusNP;
+
     bool fIsTracking { false };
 
     double axisRatio[2] { 1., 1. };
@@ -193,16 +351,39 @@ private:
     std::shared_ptr<PiRaTe::Gpio> gpio { nullptr };
     std::unique_ptr<PiRaTe::SsiPosEncoder> az_encoder { nullptr };
     std::unique_ptr<PiRaTe::SsiPosEncoder> el_encoder { nullptr };
+    std::unique_ptr<PiRaTe::SsiEncoderGroup> encoderGroup { nullptr };
+    PiRaTe::SsiPosEncoder::Sample lastAzEncoderSample {};
+    PiRaTe::SsiPosEncoder::Sample lastElEncoderSample {};
+    std::deque<PiRaTe::SsiPosEncoder::PositionSample> azPositionHistory {};
+    std::deque<PiRaTe::SsiPosEncoder::PositionSample> elPositionHistory {};
+    unsigned long azEncoderOverruns { 0 };
+    unsigned long elEncoderOverruns { 0 };
     std::unique_ptr<PiRaTe::MotorDriver> az_motor { nullptr };
     std::unique_ptr<PiRaTe::MotorDriver> el_motor { nullptr };
+    std::unique_ptr<PiRaTe::AxisServo> azServo { nullptr };
+    std::unique_ptr<PiRaTe::AxisServo> elServo { nullptr };
+    std::unique_ptr<PiRaTe::MountController> mountControl { nullptr };
     std::map<std::uint8_t, std::shared_ptr<PiRaTe::i2cDevice>> i2cDeviceMap {};
+    std::unique_ptr<PiRaTe::AdcScheduler> adcScheduler { nullptr };
+    std::shared_ptr<PiRaTe::LockInDetector> lockIn { nullptr };
+    std::shared_ptr<PiRaTe::CalibrationScheduler> calibration { nullptr };
+    std::mutex calibrationMutex {};
+    bool logarithmicDetector { false };
     std::shared_ptr<PiRaTe::RpiTemperatureMonitor> tempMonitor { nullptr };
     HorCoords currentHorizontalCoords { 0., 90. };
     HorCoords targetHorizontalCoords { 0., 90. };
     EquCoords targetEquatorialCoords { 0., 0. };
+    PiRaTe::ScanEngine scanEngine {};
+    PiRaTe::TrackingEngine trackingEngine {};
+    PiRaTe::TimeBase timeBase {};
+    std::chrono::time_point<std::chrono::system_clock> lastScanSampleTime {};
+    PiRaTe::DataRecorder recorder {};
+    PiRaTe::PropertyPublisher publisher {};
+    std::chrono::steady_clock::time_point lastPublishStatisticsTime {};
+    unsigned long recorderLostSamples { 0 };
 
     std::vector<std::shared_ptr<PiRaTe::Ads1115VoltageMonitor>> voltageMonitors {};
     std::vector<std::shared_ptr<PiRaTe::Ads1115Measurement>> voltageMeasurements {};
     std::chrono::time_point<std::chrono::system_clock> fStartTime {};
-    unsigned int targetPointingCycles { 0 };
+    unsigned long motionId { 0 };
 };
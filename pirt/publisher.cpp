@@ -0,0 +1,90 @@
+#include <cmath>
+
+#include "publisher.h"
+
+namespace PiRaTe {
+
+void PropertyPublisher::registerProperty(const void* key, std::size_t group, std::vector<double> deadbands)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    Entry& entry { fEntries[key] };
+    entry.group = group;
+    entry.deadbands = std::move(deadbands);
+    entry.values.clear();
+    entry.valid = false;
+}
+
+auto PropertyPublisher::isRegistered(const void* key, std::size_t nr_values) -> bool
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    auto it { fEntries.find(key) };
+    return (it != fEntries.end() && it->second.deadbands.size() == nr_values);
+}
+
+void PropertyPublisher::setLimits(std::size_t group, const Limits& limits)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (group >= fLimits.size())
+        fLimits.resize(group + 1);
+    fLimits[group] = limits;
+}
+
+auto PropertyPublisher::limits(std::size_t group) -> Limits
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    return (group < fLimits.size()) ? fLimits[group] : Limits {};
+}
+
+void PropertyPublisher::invalidate()
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    for (auto& item : fEntries)
+        item.second.valid = false;
+}
+
+auto PropertyPublisher::update(const void* key, const std::vector<double>& values, int state) -> bool
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    auto it { fEntries.find(key) };
+    if (it == fEntries.end()) {
+        fStats.published++;
+        return true;
+    }
+    Entry& entry { it->second };
+    const Limits limits { (entry.group < fLimits.size()) ? fLimits[entry.group] : Limits {} };
+    const auto now { std::chrono::steady_clock::now() };
+    const auto elapsed { now - entry.time };
+
+    bool due { !entry.valid || state != entry.state || values.size() != entry.values.size() };
+    if (!due && elapsed < limits.minInterval) {
+        fStats.suppressed++;
+        return false;
+    }
+    if (!due && limits.maxInterval.count() > 0 && elapsed >= limits.maxInterval)
+        due = true;
+    for (std::size_t i { 0 }; !due && i < values.size(); ++i) {
+        const double deadband { (i < entry.deadbands.size()) ? entry.deadbands[i] : 0. };
+        // written as negation, so that NaN values are always due
+        due = !(std::abs(values[i] - entry.values[i]) <= deadband);
+    }
+    if (!due) {
+        fStats.suppressed++;
+        return false;
+    }
+    entry.values = values;
+    entry.state = state;
+    entry.time = now;
+    entry.valid = true;
+    fStats.published++;
+    return true;
+}
+
+auto PropertyPublisher::statistics() -> Statistics
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    const Statistics stats { fStats };
+    fStats = {};
+    return stats;
+}
+
+} // namespace PiRaTe
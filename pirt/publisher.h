@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace PiRaTe {
+
+/**
+ * @brief Event-driven publishing decisions for the driver's status properties
+ * Instead of sending each property on every poll cycle, the publisher keeps the values and the state of each
+ * registered property as last sent to the clients. A property is due for publishing only if
+ * - any value moved by more than the deadband of its element, or the state or the nr. of values changed,
+ * - or the heartbeat interval of its group expired since the last publishing.
+ * Additionally the rate of each group is capped by a minimum interval between two publishings of a property.
+ * Value changes which are held back by the rate cap are not lost, since the comparison is always made against
+ * the values last sent. State changes (e.g. an alert) bypass the rate cap.
+ * Properties are identified by an arbitrary key (e.g. the address of the property vector). Keys which are not
+ * registered are always due.
+ */
+class PropertyPublisher {
+public:
+    /// publishing limits of a property group
+    struct Limits {
+        std::chrono::milliseconds minInterval { 0 }; ///<! minimum time between two publishings (0=no rate cap)
+        std::chrono::milliseconds maxInterval { 0 }; ///<! heartbeat, maximum time between two publishings (0=off)
+    };
+
+    struct Statistics {
+        unsigned long published { 0 }; ///<! nr. of publishings
+        unsigned long suppressed { 0 }; ///<! nr. of updates which were not published
+    };
+
+    PropertyPublisher() = default;
+
+    /**
+    * @brief register a property
+    * @param key the identifier of the property
+    * @param group the group with the publishing limits of the property
+    * @param deadbands the deadband of each value of the property
+    * @note A registered property is published with the next update.
+    */
+    void registerProperty(const void* key, std::size_t group, std::vector<double> deadbands);
+    [[nodiscard]] auto isRegistered(const void* key, std::size_t nr_values) -> bool;
+    void setLimits(std::size_t group, const Limits& limits);
+    [[nodiscard]] auto limits(std::size_t group) -> Limits;
+    /**
+    * @brief force the publishing of all properties with their next update, e.g. after a new client connected
+    */
+    void invalidate();
+
+    /**
+    * @brief check whether the updated property is due for publishing
+    * If true is returned, the caller is expected to publish the property and the values are taken as sent.
+    * @param key the identifier of the property
+    * @param values the current values
+    * @param state the current state of the property
+    */
+    [[nodiscard]] auto update(const void* key, const std::vector<double>& values, int state) -> bool;
+    /**
+    * @brief publishing statistics
+    * @return the statistics accumulated since the last call
+    */
+    [[nodiscard]] auto statistics() -> Statistics;
+
+private:
+    struct Entry {
+        std::size_t group { 0 };
+        std::vector<double> deadbands {};
+        std::vector<double> values {};
+        int state { 0 };
+        bool valid { false };
+        std::chrono::steady_clock::time_point time {};
+    };
+
+    std::map<const void*, Entry> fEntries {};
+    std::vector<Limits> fLimits {};
+    Statistics fStats {};
+    std::mutex fMutex;
+};
+
+} // namespace PiRaTe
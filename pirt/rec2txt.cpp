@@ -0,0 +1,113 @@
+/* convert a binary recording of the PiRT data recorder into the text column format
+ * of the scan scripts and the driver's scan engine:
+ * # time az alt ra dec adc1 adc2 temp1 temp2 cal
+ * Samples of channel 0 are written as adc1, each accompanied by the latest sample of channel 1 as adc2.
+ * The column cal is 1 for samples taken with the calibration source switched on.
+ * Samples flagged as outliers are skipped.
+ * An optional time window (unix time in seconds) is located via the index records of the file.
+ * usage: rt_rec2txt <recording> [<start_time> [<end_time>]] > output.txt
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "recorder.h"
+
+using Recorder = PiRaTe::DataRecorder;
+
+auto readRecord(std::ifstream& file, std::uint64_t slot, Recorder::SampleRecord* record) -> bool
+{
+    file.clear();
+    file.seekg(sizeof(Recorder::FileHeader) + slot * sizeof(Recorder::SampleRecord));
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(record), sizeof(Recorder::SampleRecord)));
+}
+
+// binary search for the first block whose last sample is not earlier than the given time
+auto findStartSlot(std::ifstream& file, std::uint64_t nr_slots, std::uint32_t index_interval, std::int64_t time) -> std::uint64_t
+{
+    const std::uint64_t block_slots { index_interval + 1ULL };
+    std::uint64_t lo { 0 }, hi { nr_slots / block_slots };
+    while (lo < hi) {
+        const std::uint64_t mid { (lo + hi) / 2 };
+        Recorder::SampleRecord slot {};
+        if (!readRecord(file, (mid + 1) * block_slots - 1, &slot) || slot.type != Recorder::IndexType)
+            return 0;
+        Recorder::IndexRecord index {};
+        std::memcpy(&index, &slot, sizeof(index));
+        if (index.last_time < time)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo * block_slots;
+}
+
+void writeLine(const Recorder::SampleRecord& record, double adc2)
+{
+    PiRaTe::TextRecord line {};
+    line.time = std::chrono::time_point<std::chrono::system_clock> { std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(record.time)) };
+    line.az = record.az;
+    line.alt = record.alt;
+    line.ra = record.ra;
+    line.dec = record.dec;
+    line.adc1 = record.value;
+    line.adc2 = adc2;
+    line.temp1 = record.temp1;
+    line.temp2 = record.temp2;
+    PiRaTe::writeTextRecord(std::cout, line);
+    std::cout << " " << ((record.flags & Recorder::FlagCalibration) ? 1 : 0) << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "convert a binary recording of the PiRT data recorder into text columns\n";
+        std::cerr << "usage: " << argv[0] << " <recording> [<start_time> [<end_time>]]\n";
+        std::cerr << " start_time, end_time - (optional) time window in seconds since the unix epoch\n";
+        return 1;
+    }
+    const std::int64_t start_time { (argc > 2) ? static_cast<std::int64_t>(std::strtod(argv[2], nullptr) * 1e9) : std::numeric_limits<std::int64_t>::min() };
+    const std::int64_t end_time { (argc > 3) ? static_cast<std::int64_t>(std::strtod(argv[3], nullptr) * 1e9) : std::numeric_limits<std::int64_t>::max() };
+
+    std::ifstream file(argv[1], std::ios::binary);
+    Recorder::FileHeader header {};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, Recorder::MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << "error: " << argv[1] << " is not a recorder file\n";
+        return 1;
+    }
+    if (header.version < Recorder::MIN_FORMAT_VERSION || header.version > Recorder::FORMAT_VERSION || header.record_size != sizeof(Recorder::SampleRecord) || header.index_interval == 0) {
+        std::cerr << "error: unsupported recorder file format version " << header.version << "\n";
+        return 1;
+    }
+    file.seekg(0, std::ios::end);
+    const std::uint64_t nr_slots { (static_cast<std::uint64_t>(file.tellg()) - sizeof(header)) / sizeof(Recorder::SampleRecord) };
+
+    const std::uint64_t first_slot { (argc > 2) ? findStartSlot(file, nr_slots, header.index_interval, start_time) : 0 };
+    file.clear();
+    file.seekg(sizeof(header) + first_slot * sizeof(Recorder::SampleRecord));
+    double adc2 { 0. };
+    std::cout << "# time az alt ra dec adc1 adc2 temp1 temp2 cal\n";
+    Recorder::SampleRecord record {};
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        if (record.type != Recorder::SampleType)
+            continue;
+        if (record.time > end_time)
+            break;
+        if ((record.flags & Recorder::FlagGap) && record.time >= start_time)
+            std::cout << "# gap: samples of channel " << static_cast<unsigned int>(record.channel) << " were lost\n";
+        if (record.flags & Recorder::FlagOutlier)
+            continue;
+        if (record.channel == 1)
+            adc2 = record.value;
+        if (record.channel == 0 && record.time >= start_time)
+            writeLine(record, adc2);
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "recorder.h"
+
+namespace PiRaTe {
+
+namespace {
+    auto toNanoseconds(std::chrono::time_point<std::chrono::system_clock> time) -> std::int64_t
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+} // namespace
+
+void writeTextRecord(std::ostream& os, const TextRecord& record)
+{
+    const std::time_t t { std::chrono::system_clock::to_time_t(record.time) };
+    const auto ms { std::chrono::duration_cast<std::chrono::milliseconds>(record.time.time_since_epoch()).count() % 1000 };
+    std::tm utc {};
+    gmtime_r(&t, &utc);
+    // OTF samples come at a rate of up to 100 Hz, so the time stamp carries milliseconds
+    os << std::put_time(&utc, "%Y-%m-%dT%H:%M:%S") << "." << std::setfill('0') << std::setw(3) << ms << std::setfill(' ') << std::fixed
+       << " " << std::setprecision(4) << record.az
+       << " " << std::setprecision(4) << record.alt
+       << " " << std::setprecision(5) << record.ra
+       << " " << std::setprecision(4) << record.dec
+       << " " << std::setprecision(4) << record.adc1
+       << " " << std::setprecision(4) << record.adc2
+       << " " << std::setprecision(2) << record.temp1
+       << " " << std::setprecision(2) << record.temp2;
+}
+
+DataRecorder::~DataRecorder()
+{
+    stop();
+}
+
+auto DataRecorder::start(const std::string& filename, std::chrono::milliseconds sync_interval, std::uint32_t index_interval, std::size_t max_pending) -> bool
+{
+    stop();
+    if (index_interval == 0 || sync_interval.count() <= 0 || max_pending == 0) {
+        std::cerr << "DataRecorder::start(): invalid sync or index interval or queue size\n";
+        return false;
+    }
+    // never overwrite or extend an existing file, so that the index records are found at fixed positions
+    fFd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fFd < 0) {
+        std::cerr << "DataRecorder::start(): error opening output file " << filename << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    fIndexInterval = index_interval;
+    fSyncInterval = sync_interval;
+    fMaxPending = max_pending;
+    fNrSamples = 0;
+    fNrBytes = 0;
+    fNrDropped = 0;
+    fGap.clear();
+    fFault = false;
+    fBlock = IndexRecord {};
+    fBlock.type = IndexType;
+
+    FileHeader header {};
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.record_size = sizeof(SampleRecord);
+    header.index_interval = fIndexInterval;
+    header.start_time = toNanoseconds(std::chrono::system_clock::now());
+    fPending.clear();
+    fPending.insert(fPending.end(), reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header) + sizeof(header));
+
+    fActiveLoop = true;
+    fThread = std::make_unique<std::thread>([this]() { this->threadLoop(); });
+    return true;
+}
+
+void DataRecorder::stop()
+{
+    if (fThread == nullptr)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        // close the last, incomplete block
+        if (fBlock.nr_samples > 0)
+            appendIndex();
+        fActiveLoop = false;
+    }
+    fWakeUp.notify_all();
+    fThread->join();
+    fThread.reset();
+    ::close(fFd);
+    fFd = -1;
+}
+
+void DataRecorder::append(const Sample& sample)
+{
+    if (!fActiveLoop)
+        return;
+    SampleRecord record {};
+    record.time = toNanoseconds(sample.time);
+    record.type = SampleType;
+    record.channel = static_cast<std::uint8_t>(sample.channel);
+    record.flags = sample.flags;
+    record.value = static_cast<float>(sample.value);
+    record.az = static_cast<float>(sample.az);
+    record.alt = static_cast<float>(sample.alt);
+    record.ra = static_cast<float>(sample.ra);
+    record.dec = static_cast<float>(sample.dec);
+    record.temp1 = static_cast<float>(sample.temp1);
+    record.temp2 = static_cast<float>(sample.temp2);
+
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (record.channel >= fGap.size())
+        fGap.resize(record.channel + 1U, false);
+    // the storage stalls, so drop the sample rather than let the queue grow without bound
+    if (fPending.size() / sizeof(SampleRecord) >= fMaxPending) {
+        fGap[record.channel] = true;
+        fNrDropped++;
+        return;
+    }
+    // the first sample behind the dropped ones marks the gap
+    if (fGap[record.channel]) {
+        record.flags |= FlagGap;
+        fGap[record.channel] = false;
+    }
+    fPending.insert(fPending.end(), reinterpret_cast<const char*>(&record), reinterpret_cast<const char*>(&record) + sizeof(record));
+    if (fBlock.nr_samples == 0)
+        fBlock.time = record.time;
+    fBlock.last_time = record.time;
+    fBlock.nr_samples++;
+    fNrSamples++;
+    if (fBlock.nr_samples >= fIndexInterval)
+        appendIndex();
+}
+
+// must be called with the mutex locked
+void DataRecorder::appendIndex()
+{
+    fBlock.total_samples = fNrSamples;
+    fPending.insert(fPending.end(), reinterpret_cast<const char*>(&fBlock), reinterpret_cast<const char*>(&fBlock) + sizeof(fBlock));
+    fBlock = IndexRecord {};
+    fBlock.type = IndexType;
+}
+
+// this is the background thread loop
+void DataRecorder::threadLoop()
+{
+    std::vector<char> buffer {};
+    bool active { true };
+    while (active) {
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fWakeUp.wait_for(lock, fSyncInterval, [this]() { return !fActiveLoop; });
+            active = fActiveLoop;
+            buffer.swap(fPending);
+        }
+        if (buffer.empty())
+            continue;
+        // write out the samples of one sync interval at once and sync them to disk
+        if (!writeOut(buffer) || ::fdatasync(fFd) != 0) {
+            if (!fFault)
+                std::cerr << "DataRecorder: error writing to output file: " << std::strerror(errno) << "\n";
+            fFault = true;
+        }
+        buffer.clear();
+    }
+}
+
+auto DataRecorder::writeOut(const std::vector<char>& buffer) -> bool
+{
+    std::size_t written { 0 };
+    while (written < buffer.size()) {
+        const ssize_t n { ::write(fFd, buffer.data() + written, buffer.size() - written) };
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        written += static_cast<std::size_t>(n);
+        fNrBytes += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+} // namespace PiRaTe
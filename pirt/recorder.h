@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace PiRaTe {
+
+/// one line of the text column format "time az alt ra dec adc1 adc2 temp1 temp2" of the scan files
+struct TextRecord {
+    std::chrono::time_point<std::chrono::system_clock> time {};
+    double az { 0. };
+    double alt { 0. };
+    double ra { 0. };
+    double dec { 0. };
+    double adc1 { 0. };
+    double adc2 { 0. };
+    double temp1 { 0. };
+    double temp2 { 0. };
+};
+
+/**
+ * @brief write the columns of a text record, the time stamp in UTC with milliseconds
+ * The line end is left to the caller, so that further columns may be appended.
+ */
+void writeTextRecord(std::ostream& os, const TextRecord& record);
+
+/**
+ * @brief Append-only binary recorder for receiver samples
+ * Every raw measurement sample is stored together with the telescope position at the sample time and
+ * housekeeping data in a fixed-size record. The file starts with a {@link DataRecorder::FileHeader},
+ * followed by a sequence of records of equal size. After every index_interval sample records, and once more
+ * when the recording is stopped, an index record is inserted which covers the preceding block of samples.
+ * Thus the file can be read in arbitrary chunks and a time range can be located by a binary search over the index records
+ * without scanning the whole file. All values are stored in host byte order.
+ * Samples are collected in memory and written to disk by a separate thread, which calls fsync once per sync interval,
+ * so that the caller is never blocked by slow storage. If the storage stalls for so long that the queue
+ * reaches its limit, further samples are dropped and the next sample of the channel is marked with FlagGap.
+ */
+class DataRecorder {
+public:
+    static constexpr char MAGIC[8] { 'P', 'I', 'R', 'T', 'R', 'E', 'C', '\0' }; //< file signature
+    static constexpr std::uint16_t FORMAT_VERSION { 2 }; //< version 2 added the flags of the sample records
+    static constexpr std::uint16_t MIN_FORMAT_VERSION { 1 }; //< oldest format version which can be read
+    static constexpr std::uint32_t DEFAULT_INDEX_INTERVAL { 1024 }; //< nr. of sample records between two index records
+    static constexpr std::chrono::milliseconds DEFAULT_SYNC_INTERVAL { 2000 }; //< interval of write-out and fsync to disk
+    static constexpr std::size_t DEFAULT_MAX_PENDING { 65536 }; //< max. nr. of records queued for write-out (about 2.6 MB)
+
+    enum RecordType : std::uint16_t {
+        SampleType = 1,
+        IndexType = 2
+    };
+
+    enum SampleFlags : std::uint8_t {
+        FlagOutlier = 0x01, ///<! sample was flagged as outlier (e.g. RFI) and excluded from the integration
+        FlagCalibration = 0x02, ///<! sample was taken with the calibration source switched on
+        FlagGap = 0x04 ///<! samples of the channel preceding this sample were lost, e.g. by a stalled acquisition
+    };
+
+    /// header at the beginning of the file
+    struct FileHeader {
+        char magic[8]; ///<! file signature {@link DataRecorder::MAGIC}
+        std::uint16_t version; ///<! format version
+        std::uint16_t record_size; ///<! size of each record in bytes
+        std::uint32_t index_interval; ///<! nr. of sample records between two index records
+        std::int64_t start_time; ///<! start of the recording in ns since the unix epoch
+        std::uint8_t reserved[40];
+    };
+
+    /// one measurement sample
+    struct SampleRecord {
+        std::int64_t time; ///<! sample time in ns since the unix epoch
+        std::uint16_t type; ///<! record type, always SampleType
+        std::uint8_t channel; ///<! measurement channel
+        std::uint8_t flags; ///<! combination of {@link DataRecorder::SampleFlags}, always 0 in format version 1
+        float value; ///<! measured value
+        float az; ///<! azimuth in deg
+        float alt; ///<! altitude in deg
+        float ra; ///<! right ascension in h
+        float dec; ///<! declination in deg
+        float temp1; ///<! housekeeping temperature 1 in deg C
+        float temp2; ///<! housekeeping temperature 2 in deg C
+    };
+
+    /// index of the block of sample records preceding this record
+    struct IndexRecord {
+        std::int64_t time; ///<! time of the first sample of the block in ns since the unix epoch
+        std::uint16_t type; ///<! record type, always IndexType
+        std::uint16_t reserved;
+        std::uint32_t nr_samples; ///<! nr. of samples in the block
+        std::int64_t last_time; ///<! time of the last sample of the block in ns since the unix epoch
+        std::uint64_t total_samples; ///<! nr. of samples in the file up to and including this block
+        std::uint64_t reserved2;
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "unexpected size of recorder file header");
+    static_assert(sizeof(SampleRecord) == 40, "unexpected size of recorder sample record");
+    static_assert(sizeof(IndexRecord) == sizeof(SampleRecord), "index and sample records must have equal size");
+
+    /// sample as supplied by the caller
+    struct Sample {
+        std::chrono::time_point<std::chrono::system_clock> time {};
+        unsigned int channel { 0 };
+        std::uint8_t flags { 0 };
+        double value { 0. };
+        double az { 0. };
+        double alt { 0. };
+        double ra { 0. };
+        double dec { 0. };
+        double temp1 { 0. };
+        double temp2 { 0. };
+    };
+
+    DataRecorder() = default;
+    ~DataRecorder();
+
+    /**
+    * @brief open the output file and start recording
+    * @param filename output file, the call fails if the file exists already
+    * @param sync_interval interval of write-out and fsync
+    * @param index_interval nr. of sample records between two index records
+    * @param max_pending max. nr. of records queued for write-out, further samples are dropped
+    */
+    auto start(const std::string& filename,
+        std::chrono::milliseconds sync_interval = DEFAULT_SYNC_INTERVAL,
+        std::uint32_t index_interval = DEFAULT_INDEX_INTERVAL,
+        std::size_t max_pending = DEFAULT_MAX_PENDING) -> bool;
+    /**
+    * @brief stop recording, write out all pending samples and close the file
+    */
+    void stop();
+    [[nodiscard]] auto isActive() const -> bool { return fActiveLoop.load(); }
+    [[nodiscard]] auto isFault() const -> bool { return fFault.load(); }
+    /**
+    * @brief queue one sample for recording
+    */
+    void append(const Sample& sample);
+    [[nodiscard]] auto nrSamples() const -> std::uint64_t { return fNrSamples.load(); }
+    [[nodiscard]] auto nrBytes() const -> std::uint64_t { return fNrBytes.load(); }
+    [[nodiscard]] auto nrDropped() const -> std::uint64_t { return fNrDropped.load(); }
+
+private:
+    void threadLoop();
+    void appendIndex();
+    auto writeOut(const std::vector<char>& buffer) -> bool;
+
+    int fFd { -1 };
+    std::uint32_t fIndexInterval { DEFAULT_INDEX_INTERVAL };
+    std::chrono::milliseconds fSyncInterval { DEFAULT_SYNC_INTERVAL };
+    std::size_t fMaxPending { DEFAULT_MAX_PENDING };
+    std::vector<char> fPending {};
+    std::vector<bool> fGap {}; ///<! per channel: samples were dropped since the last recorded sample
+    IndexRecord fBlock {}; ///<! index of the current block
+    std::atomic<std::uint64_t> fNrSamples { 0 };
+    std::atomic<std::uint64_t> fNrBytes { 0 };
+    std::atomic<std::uint64_t> fNrDropped { 0 };
+    std::atomic<bool> fFault { false };
+
+    std::atomic<bool> fActiveLoop { false };
+    std::unique_ptr<std::thread> fThread { nullptr };
+    std::mutex fMutex;
+    std::condition_variable fWakeUp;
+};
+
+} // namespace PiRaTe
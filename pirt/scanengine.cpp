@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "scanengine.h"
+
+namespace PiRaTe {
+
+constexpr double GRID_EPSILON { 1e-6 }; //< tolerance for the inclusion of the upper window boundary
+constexpr std::size_t MAX_GRID_POINTS { 1'000'000 }; //< upper limit of grid points per scan
+constexpr std::chrono::seconds SWEEP_TIMEOUT { 30 }; //< time allowed beyond the nominal duration of an OTF row to reach its end
+
+ScanEngine::~ScanEngine()
+{
+    if (fFile.is_open())
+        fFile.close();
+}
+
+auto ScanEngine::start(CoordSystem system, Mode mode, const Window& window, std::chrono::milliseconds int_time, const std::string& filename) -> bool
+{
+    stop();
+    if (window.step1 <= 0. || window.step2 <= 0. || window.min2 > window.max2 || int_time.count() <= 0) {
+        std::cerr << "ScanEngine::start(): invalid window or step size\n";
+        return false;
+    }
+    if (system == CoordSystem::Horizontal && window.min1 > window.max1) {
+        std::cerr << "ScanEngine::start(): min az > max az\n";
+        return false;
+    }
+    fSystem = system;
+    fMode = mode;
+    fIntTime = int_time;
+    if (fMode == Mode::Grid)
+        buildGrid(window);
+    else
+        buildRows(window);
+    if (fGrid.empty()) {
+        std::cerr << "ScanEngine::start(): empty scan grid\n";
+        return false;
+    }
+    fFile.open(filename, std::ios::out | std::ios::app);
+    if (!fFile.is_open()) {
+        std::cerr << "ScanEngine::start(): error opening output file " << filename << "\n";
+        fGrid.clear();
+        return false;
+    }
+    fFile << "# time az alt ra dec adc1 adc2 temp1 temp2\n" << std::flush;
+    fPointIndex = 0;
+    fState = State::Slewing;
+    return true;
+}
+
+void ScanEngine::stop()
+{
+    if (isActive())
+        fState = State::Aborted;
+    if (fFile.is_open())
+        fFile.close();
+}
+
+void ScanEngine::buildGrid(const Window& window)
+{
+    fGrid.clear();
+    double max1 { window.max1 };
+    // an equatorial window may span across 0h RA
+    if (fSystem == CoordSystem::Equatorial && window.min1 > window.max1)
+        max1 += 24.;
+    const std::size_t n1 { static_cast<std::size_t>(std::floor((max1 - window.min1) / window.step1 + GRID_EPSILON)) + 1 };
+    const std::size_t n2 { static_cast<std::size_t>(std::floor((window.max2 - window.min2) / window.step2 + GRID_EPSILON)) + 1 };
+    if (n1 * n2 > MAX_GRID_POINTS)
+        return;
+    fGrid.reserve(n1 * n2);
+    for (std::size_t i { 0 }; i < n1; ++i) {
+        const double c1 { window.min1 + i * window.step1 };
+        // scan upwards in even columns and downwards in odd columns to avoid long return slews
+        for (std::size_t j { 0 }; j < n2; ++j) {
+            const std::size_t row { (i % 2 == 0) ? j : (n2 - 1 - j) };
+            fGrid.push_back({ c1, window.min2 + row * window.step2 });
+        }
+    }
+}
+
+void ScanEngine::buildRows(const Window& window)
+{
+    fGrid.clear();
+    double max1 { window.max1 };
+    if (fSystem == CoordSystem::Equatorial && window.min1 > window.max1)
+        max1 += 24.;
+    fSweepLength = max1 - window.min1;
+    fSweepRate = window.step1 / std::chrono::duration<double>(fIntTime).count();
+    if (fSweepLength <= 0.)
+        return;
+    const std::size_t n2 { static_cast<std::size_t>(std::floor((window.max2 - window.min2) / window.step2 + GRID_EPSILON)) + 1 };
+    if (n2 > MAX_GRID_POINTS)
+        return;
+    fGrid.reserve(n2);
+    for (std::size_t j { 0 }; j < n2; ++j) {
+        // sweep forward in even rows and backward in odd rows
+        fGrid.push_back({ (j % 2 == 0) ? window.min1 : max1, window.min2 + j * window.step2 });
+    }
+}
+
+auto ScanEngine::currentPoint() const -> GridPoint
+{
+    if (fPointIndex >= fGrid.size())
+        return {};
+    return wrapped(fGrid[fPointIndex]);
+}
+
+auto ScanEngine::sweepPoint(std::chrono::time_point<std::chrono::system_clock> now) const -> GridPoint
+{
+    if (fPointIndex >= fGrid.size())
+        return {};
+    GridPoint point { fGrid[fPointIndex] };
+    if (fState != State::Sweeping)
+        return wrapped(point);
+    const double dir { (fPointIndex % 2 == 0) ? 1. : -1. };
+    const double elapsed { std::max(std::chrono::duration<double>(now - fArrivalTime).count(), 0.) };
+    point.c1 += dir * std::min(elapsed * fSweepRate, fSweepLength);
+    return wrapped(point);
+}
+
+auto ScanEngine::sweepDone(std::chrono::time_point<std::chrono::system_clock> now, double position, double tolerance) const -> bool
+{
+    if (fState != State::Sweeping || fPointIndex >= fGrid.size())
+        return false;
+    const double elapsed { std::max(std::chrono::duration<double>(now - fArrivalTime).count(), 0.) };
+    // give up the row if the mount does not reach its end in time
+    if (elapsed >= fSweepLength / fSweepRate + std::chrono::duration<double>(SWEEP_TIMEOUT).count())
+        return true;
+    const double range { (fSystem == CoordSystem::Horizontal) ? 360. : 24. };
+    const double dir { (fPointIndex % 2 == 0) ? 1. : -1. };
+    // the position is unwrapped with respect to the nominal sweep point, which the mount follows closely
+    const double nominal { std::min(elapsed * fSweepRate, fSweepLength) };
+    const double expected { fGrid[fPointIndex].c1 + dir * nominal };
+    const double progress { nominal + dir * std::remainder(position - expected, range) };
+    return (progress >= fSweepLength - tolerance);
+}
+
+auto ScanEngine::wrapped(GridPoint point) const -> GridPoint
+{
+    const double range { (fSystem == CoordSystem::Horizontal) ? 360. : 24. };
+    point.c1 = std::fmod(point.c1, range);
+    if (point.c1 < 0.)
+        point.c1 += range;
+    return point;
+}
+
+auto ScanEngine::integrationDone(std::chrono::time_point<std::chrono::system_clock> now) const -> bool
+{
+    return (fState == State::Integrating && (now - fArrivalTime) >= fIntTime);
+}
+
+void ScanEngine::targetReached(std::chrono::time_point<std::chrono::system_clock> now)
+{
+    if (fState != State::Slewing)
+        return;
+    fArrivalTime = now;
+    fState = (fMode == Mode::Grid) ? State::Integrating : State::Sweeping;
+}
+
+void ScanEngine::writeRecord(const Record& record)
+{
+    if (!fFile.is_open())
+        return;
+    writeTextRecord(fFile, record);
+    fFile << "\n"
+          << std::flush;
+}
+
+auto ScanEngine::advance() -> bool
+{
+    if (!isActive())
+        return false;
+    if (++fPointIndex >= fGrid.size()) {
+        fState = State::Finished;
+        fFile.close();
+        return false;
+    }
+    fState = State::Slewing;
+    return true;
+}
+
+} // namespace PiRaTe
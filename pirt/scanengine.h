@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "recorder.h"
+
+namespace PiRaTe {
+
+/**
+ * @brief Grid scan state machine for 2d raster measurements
+ * The scan engine holds the list of grid points of a rectangular window (horizontal or equatorial),
+ * keeps track of the current point and the stage of the measurement (slew, integration) and streams
+ * the acquired samples to a text file. It does not move the mount itself, but is driven cyclically
+ * from the driver's status loop which issues the gotos and supplies the samples.
+ * In grid mode the mount stops at each grid point for the integration time (stop-and-stare). In on-the-fly (OTF)
+ * mode coordinate 1 is swept at constant rate across each row, one step per integration time, while every
+ * sample is recorded with the position interpolated at its sample time. A row ends when the mount position
+ * passes the end of the row, the nominal duration of the row only serves as timeout.
+ */
+class ScanEngine {
+public:
+    enum class State {
+        Idle,
+        Slewing,
+        Integrating,
+        Sweeping,
+        Finished,
+        Aborted
+    };
+
+    enum class CoordSystem {
+        Horizontal,
+        Equatorial
+    };
+
+    enum class Mode {
+        Grid,
+        Otf
+    };
+
+    /// window boundaries and step sizes, coordinate 1 is Az (deg) or RA (h), coordinate 2 is Alt or Dec (deg)
+    struct Window {
+        double min1 { 0. };
+        double max1 { 0. };
+        double min2 { 0. };
+        double max2 { 0. };
+        double step1 { 1. };
+        double step2 { 1. };
+    };
+
+    struct GridPoint {
+        double c1 { 0. };
+        double c2 { 0. };
+    };
+
+    /// one line of the output file, same column layout as written by the rt_scan_hor/rt_scan_equ scripts
+    using Record = TextRecord;
+
+    ScanEngine() = default;
+    ~ScanEngine();
+
+    auto start(CoordSystem system, Mode mode, const Window& window, std::chrono::milliseconds int_time, const std::string& filename) -> bool;
+    void stop();
+
+    [[nodiscard]] auto state() const -> State { return fState; }
+    [[nodiscard]] auto isActive() const -> bool { return (fState == State::Slewing || fState == State::Integrating || fState == State::Sweeping); }
+    [[nodiscard]] auto coordSystem() const -> CoordSystem { return fSystem; }
+    [[nodiscard]] auto mode() const -> Mode { return fMode; }
+    [[nodiscard]] auto currentPoint() const -> GridPoint;
+    [[nodiscard]] auto sweepPoint(std::chrono::time_point<std::chrono::system_clock> now) const -> GridPoint;
+    /**
+    * @brief check whether the mount reached the end of the current OTF row
+    * @param now the current time
+    * @param position the current position of coordinate 1, Az (deg) or RA (h)
+    * @param tolerance the tolerance of the position in the same units
+    * @return true if the position passed the end of the row or the row timed out
+    */
+    [[nodiscard]] auto sweepDone(std::chrono::time_point<std::chrono::system_clock> now, double position, double tolerance) const -> bool;
+    [[nodiscard]] auto pointIndex() const -> std::size_t { return fPointIndex; }
+    [[nodiscard]] auto nrPoints() const -> std::size_t { return fGrid.size(); }
+    [[nodiscard]] auto intTime() const -> std::chrono::milliseconds { return fIntTime; }
+    [[nodiscard]] auto integrationDone(std::chrono::time_point<std::chrono::system_clock> now) const -> bool;
+
+    void targetReached(std::chrono::time_point<std::chrono::system_clock> now);
+    void writeRecord(const Record& record);
+    auto advance() -> bool;
+
+private:
+    void buildGrid(const Window& window);
+    void buildRows(const Window& window);
+    [[nodiscard]] auto wrapped(GridPoint point) const -> GridPoint;
+
+    State fState { State::Idle };
+    CoordSystem fSystem { CoordSystem::Horizontal };
+    Mode fMode { Mode::Grid };
+    std::vector<GridPoint> fGrid {}; ///<! grid points in grid mode, row start points in OTF mode
+    double fSweepLength { 0. };
+    double fSweepRate { 0. }; ///<! sweep rate of coordinate 1 in units per second
+    std::size_t fPointIndex { 0 };
+    std::chrono::milliseconds fIntTime { 1000 };
+    std::chrono::time_point<std::chrono::system_clock> fArrivalTime {}; ///<! arrival at grid point or start of sweep
+    std::ofstream fFile {};
+};
+
+} // namespace PiRaTe
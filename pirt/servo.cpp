@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "encoder.h"
+#include "motordriver.h"
+#include "servo.h"
+#include "utility.h"
+
+namespace PiRaTe {
+
+constexpr double SETTLE_BAND_FACTOR { 10. }; //< settling starts when the error falls below this multiple of the tolerance
+constexpr double MAX_INTEGRAL_THROTTLE { 0.5 }; //< limit of the integral term in units of motor throttle
+
+AxisServo::AxisServo(MotorDriver* motor, SsiPosEncoder* encoder, double rate_hz)
+    : fMotor { motor }
+    , fEncoder { encoder }
+    , fCycleTimer { std::chrono::nanoseconds(static_cast<long>(1e9 / std::clamp(rate_hz, MIN_SERVO_RATE, MAX_SERVO_RATE))) }
+{
+    if (fMotor == nullptr || fEncoder == nullptr)
+        return;
+    fActiveLoop = true;
+    fThread = std::make_unique<std::thread>([this]() { this->threadLoop(); });
+}
+
+AxisServo::~AxisServo()
+{
+    disable();
+    fActiveLoop = false;
+    if (fThread != nullptr)
+        fThread->join();
+}
+
+// this is the background thread loop
+void AxisServo::threadLoop()
+{
+    fCycleTimer.start();
+    while (fActiveLoop) {
+        fCycleTimer.wait();
+        if (!fEnabled)
+            continue;
+        controlStep(std::chrono::steady_clock::now());
+    }
+}
+
+void AxisServo::controlStep(std::chrono::steady_clock::time_point now)
+{
+    const double position { axisPosition() };
+    const double velocity { axisVelocity() };
+
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (!fEnabled)
+        return;
+    const double dt { std::chrono::duration<double>(now - fLastCycleTime).count() };
+    fLastCycleTime = now;
+    double setpoint { 0. };
+    double targetVelocity { 0. };
+    if (fTrajectoryActive) {
+        const double t { std::chrono::duration<double>(now - fTrajectoryStart).count() };
+        if (t < fTrajectory.duration()) {
+            setpoint = fTrajectory.position(t);
+            targetVelocity = fTrajectory.velocity(t);
+        } else {
+            // end of the profile reached, hold the end position and continue with the end velocity
+            fTrajectoryActive = false;
+            fTargetPosition = fTrajectory.endPosition();
+            fTargetVelocity = fEndVelocity;
+            fTargetTime = fTrajectoryStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(fTrajectory.duration()));
+        }
+    }
+    if (!fTrajectoryActive) {
+        // extrapolate the setpoint from the time of the last update
+        const double elapsed { std::chrono::duration<double>(now - fTargetTime).count() };
+        setpoint = fTargetPosition + fTargetVelocity * elapsed;
+        targetVelocity = fTargetVelocity;
+    }
+    const double error { setpoint - position };
+    const double feedForward { fGains.kff * targetVelocity };
+
+    double throttle { 0. };
+    if (std::abs(error) <= fTolerance) {
+        // inside the tolerance band only the feed-forward term is applied and only if it is able to move the axis at all
+        fIntegral = 0.;
+        throttle = (std::abs(feedForward) >= fMinThrottle) ? feedForward : 0.;
+        if (fSettling) {
+            fStats.settle_time = std::chrono::duration<double>(now - fSettleStart).count();
+            fSettling = false;
+        }
+    } else {
+        if (std::abs(error) < SETTLE_BAND_FACTOR * fTolerance) {
+            if (!fSettling) {
+                fSettleStart = now;
+                fSettling = true;
+            }
+        } else {
+            fSettling = false;
+        }
+        const double pd { feedForward + fGains.kp * error + fGains.kd * (targetVelocity - velocity) };
+        // conditional integration: the integrator is frozen while the output saturates (anti-windup)
+        if (dt > 0. && dt < 1. && std::abs(pd + fGains.ki * fIntegral) < 1.) {
+            fIntegral += error * dt;
+            if (fGains.ki > 0.)
+                fIntegral = std::clamp(fIntegral, -MAX_INTEGRAL_THROTTLE / fGains.ki, MAX_INTEGRAL_THROTTLE / fGains.ki);
+        }
+        throttle = pd + fGains.ki * fIntegral;
+        // overcome the static friction of the drive
+        if (std::abs(throttle) < fMinThrottle)
+            throttle = sgn(error) * fMinThrottle;
+        throttle = std::clamp(throttle, -1., 1.);
+    }
+    fMotor->move(static_cast<float>(throttle));
+
+    fStats.cycles++;
+    fStats.error = error;
+    fStats.sum_sq += error * error;
+    fStats.max = std::max(fStats.max, std::abs(error));
+}
+
+auto AxisServo::axisPosition() -> double
+{
+    const double revolutions { fEncoder->absolutePosition() };
+    std::lock_guard<std::mutex> lock(fMutex);
+    const double position { 360. * revolutions / fScale.ratio + fScale.offset };
+    return (fScale.invert) ? -position : position;
+}
+
+auto AxisServo::axisVelocity() -> double
+{
+    const double speed { fEncoder->currentSpeed() };
+    std::lock_guard<std::mutex> lock(fMutex);
+    const double velocity { speed / fScale.ratio };
+    return (fScale.invert) ? -velocity : velocity;
+}
+
+void AxisServo::setTarget(double position, double velocity)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    const auto now { std::chrono::steady_clock::now() };
+    fTargetPosition = position;
+    fTargetVelocity = velocity;
+    fTargetTime = now;
+    fTrajectoryActive = false;
+    if (!fEnabled) {
+        fIntegral = 0.;
+        fLastCycleTime = now;
+        fSettling = false;
+        fEnabled = true;
+    }
+}
+
+void AxisServo::followTrajectory(const TrapezoidalProfile& profile, double end_velocity)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    const auto now { std::chrono::steady_clock::now() };
+    fTrajectory = profile;
+    fEndVelocity = end_velocity;
+    fTrajectoryStart = now;
+    fTrajectoryActive = true;
+    if (!fEnabled) {
+        fIntegral = 0.;
+        fLastCycleTime = now;
+        fSettling = false;
+        fEnabled = true;
+    }
+}
+
+auto AxisServo::trajectoryActive() -> bool
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    return (fEnabled && fTrajectoryActive);
+}
+
+void AxisServo::disable()
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fTrajectoryActive = false;
+    if (!fEnabled)
+        return;
+    fEnabled = false;
+    fIntegral = 0.;
+    fSettling = false;
+    if (fMotor != nullptr)
+        fMotor->stop();
+}
+
+void AxisServo::setGains(const Gains& gains)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fGains = gains;
+    fIntegral = 0.;
+}
+
+auto AxisServo::gains() -> Gains
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    return fGains;
+}
+
+void AxisServo::setScale(const Scale& scale)
+{
+    if (scale.ratio == 0.)
+        return;
+    std::lock_guard<std::mutex> lock(fMutex);
+    fScale = scale;
+}
+
+void AxisServo::setTolerance(double tolerance)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fTolerance = std::abs(tolerance);
+}
+
+void AxisServo::setMinThrottle(double throttle)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fMinThrottle = std::clamp(throttle, 0., 1.);
+}
+
+void AxisServo::setRate(double rate_hz)
+{
+    rate_hz = std::clamp(rate_hz, MIN_SERVO_RATE, MAX_SERVO_RATE);
+    fCycleTimer.setPeriod(std::chrono::nanoseconds(static_cast<long>(1e9 / rate_hz)));
+}
+
+auto AxisServo::rate() const -> double
+{
+    return 1e9 / fCycleTimer.period().count();
+}
+
+auto AxisServo::statistics() -> Statistics
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    Statistics stats {};
+    stats.cycles = fStats.cycles;
+    stats.error = fStats.error;
+    stats.settleTime = fStats.settle_time;
+    if (fStats.cycles > 0) {
+        stats.rms = std::sqrt(fStats.sum_sq / fStats.cycles);
+        stats.max = fStats.max;
+    }
+    fStats.cycles = 0;
+    fStats.sum_sq = fStats.max = 0.;
+    return stats;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "cycletimer.h"
+#include "trajectory.h"
+
+namespace PiRaTe {
+
+class MotorDriver;
+class SsiPosEncoder;
+
+constexpr double DEFAULT_SERVO_RATE { 100. }; //< default servo loop rate in Hz
+constexpr double MIN_SERVO_RATE { 10. }; //< minimum servo loop rate in Hz
+constexpr double MAX_SERVO_RATE { 1000. }; //< maximum servo loop rate in Hz
+
+/**
+ * @brief Closed-loop position servo for one telescope axis
+ * The servo runs a separate thread loop which cyclically reads the axis position and speed from the pos encoder
+ * and drives the motor with a PID controller plus velocity feed-forward. The setpoint is given as
+ * absolute axis position together with the target velocity at the time of the call. In between two setpoint updates,
+ * the setpoint is extrapolated with the target velocity, so that the servo follows a moving target (e.g. a tracked object)
+ * smoothly even if the setpoint is updated at a much lower rate than the loop rate.
+ * Alternatively the servo follows a pre-planned {@link TrapezoidalProfile}, which is handed over with
+ * {@link AxisServo::followTrajectory}. At the end of the profile, the servo holds the end position and continues with the given
+ * end velocity, as if it was set with {@link AxisServo::setTarget}.
+ * Within the tolerance band around the setpoint the PID part is switched off and the integrator is cleared, in order to
+ * avoid hunting of the axis due to static friction. Outside the band, the output is raised at least to the minimum
+ * throttle at which the motor starts to move.
+ * The servo commands the motor only while enabled. When disabled, the motor is stopped once and then left alone, so that
+ * manual motion commands can be issued directly to the motor driver.
+ */
+class AxisServo {
+public:
+    /// controller gains, output is in units of motor throttle (-1..1)
+    struct Gains {
+        double kp { 0. }; ///<! proportional gain in 1/deg
+        double ki { 0. }; ///<! integral gain in 1/(deg*s)
+        double kd { 0. }; ///<! gain for the velocity error in s/deg
+        double kff { 0. }; ///<! velocity feed-forward gain in s/deg
+    };
+
+    /// conversion from encoder revolutions to absolute axis position: pos = +-(360 * rev / ratio + offset)
+    struct Scale {
+        double ratio { 1. }; ///<! encoder revolutions per axis revolution
+        double offset { 0. }; ///<! axis offset in deg
+        bool invert { false }; ///<! invert the axis direction
+    };
+
+    struct Statistics {
+        unsigned long cycles { 0 }; ///<! nr. of active servo cycles
+        double error { 0. }; ///<! current tracking error in deg
+        double rms { 0. }; ///<! rms tracking error in deg
+        double max { 0. }; ///<! maximum absolute tracking error in deg
+        double settleTime { 0. }; ///<! duration of the last settling into the tolerance band in s
+    };
+
+    AxisServo() = delete;
+    /**
+    * @brief The main constructor.
+    * Launches the servo thread loop. The servo is initially disabled.
+    * @param motor the motor driver of the axis
+    * @param encoder the pos encoder of the axis
+    * @param rate_hz servo loop rate in Hz
+    * @note motor and encoder must outlive the servo object
+    */
+    AxisServo(MotorDriver* motor, SsiPosEncoder* encoder, double rate_hz = DEFAULT_SERVO_RATE);
+    ~AxisServo();
+
+    void setGains(const Gains& gains);
+    [[nodiscard]] auto gains() -> Gains;
+    void setScale(const Scale& scale);
+    void setTolerance(double tolerance);
+    void setMinThrottle(double throttle);
+    void setRate(double rate_hz);
+    [[nodiscard]] auto rate() const -> double;
+
+    /**
+    * @brief set a new setpoint and enable the servo
+    * @param position target axis position in deg (absolute, i.e. in the range of the axis turns)
+    * @param velocity target velocity in deg/s at the time of the call
+    */
+    void setTarget(double position, double velocity = 0.);
+    /**
+    * @brief follow a planned motion profile and enable the servo
+    * @param profile the profile to follow, starting with the time of the call
+    * @param end_velocity the target velocity in deg/s after the end of the profile
+    */
+    void followTrajectory(const TrapezoidalProfile& profile, double end_velocity = 0.);
+    [[nodiscard]] auto trajectoryActive() -> bool;
+    /**
+    * @brief disable the servo and stop the motor
+    */
+    void disable();
+    [[nodiscard]] auto isEnabled() const -> bool { return fEnabled.load(); }
+    /**
+    * @brief tracking error statistics
+    * @return the statistics accumulated since the last call
+    */
+    [[nodiscard]] auto statistics() -> Statistics;
+
+private:
+    void threadLoop();
+    void controlStep(std::chrono::steady_clock::time_point now);
+    [[nodiscard]] auto axisPosition() -> double;
+    [[nodiscard]] auto axisVelocity() -> double;
+
+    MotorDriver* fMotor { nullptr };
+    SsiPosEncoder* fEncoder { nullptr };
+    CycleTimer fCycleTimer;
+    Gains fGains {};
+    Scale fScale {};
+    double fTolerance { 0.05 };
+    double fMinThrottle { 0. };
+
+    double fTargetPosition { 0. };
+    double fTargetVelocity { 0. };
+    std::chrono::steady_clock::time_point fTargetTime {};
+    TrapezoidalProfile fTrajectory {};
+    double fEndVelocity { 0. };
+    std::chrono::steady_clock::time_point fTrajectoryStart {};
+    bool fTrajectoryActive { false };
+    double fIntegral { 0. };
+    std::chrono::steady_clock::time_point fLastCycleTime {};
+    std::chrono::steady_clock::time_point fSettleStart {};
+    bool fSettling { false };
+
+    struct {
+        unsigned long cycles { 0 };
+        double error { 0. };
+        double sum_sq { 0. };
+        double max { 0. };
+        double settle_time { 0. };
+    } fStats {};
+
+    std::atomic<bool> fEnabled { false };
+    std::atomic<bool> fActiveLoop { false };
+    std::unique_ptr<std::thread> fThread { nullptr };
+    std::mutex fMutex;
+};
+
+} // namespace PiRaTe
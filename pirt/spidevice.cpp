@@ -293,6 +293,33 @@ auto spi_device::transfer(std::uint16_t* tx_buffer, std::uint16_t* rx_buffer, st
     return( (ioctl(m_handle, SPI_IOC_MESSAGE(1), &spi) > 0) && (m_transferred_bytes += n_words*2) );
 }
 
+void spi_device::prepare_read_transfer(spi_ioc_transfer& xfer, std::uint8_t* rx_buffer, std::size_t n_bytes) const
+{
+    memset(&xfer, 0, sizeof(xfer));
+
+    xfer.tx_buf        = reinterpret_cast<__u64>( nullptr );
+    xfer.rx_buf        = reinterpret_cast<__u64>( rx_buffer );
+    xfer.len           = n_bytes;
+    xfer.speed_hz      = m_config.clk_rate;
+    xfer.delay_usecs   = 0;
+    xfer.bits_per_word = 8;
+    xfer.cs_change     = 0;
+}
+
+auto spi_device::transfer(spi_ioc_transfer* xfers, std::size_t n_xfers) -> bool
+{
+    if (locked() || !is_open() || n_xfers == 0) {
+        return false;
+    }
+
+    std::size_t n_bytes { 0 };
+    for (std::size_t i = 0; i < n_xfers; i++) {
+        n_bytes += xfers[i].len;
+    }
+
+    return( (ioctl(m_handle, SPI_IOC_MESSAGE(n_xfers), xfers) > 0) && (m_transferred_bytes += n_bytes) );
+}
+
 void spi_device::start_timer()
 {
     m_start = std::chrono::system_clock::now();
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <string>
 
+struct spi_ioc_transfer;
+
 namespace PiRaTe {
 
 /**
@@ -212,6 +214,24 @@ public:
     */
     [[nodiscard]] auto transfer(std::uint16_t* tx_buffer, std::uint16_t* rx_buffer, std::size_t n_words = 1) -> bool;
 
+    /**
+    * @brief fill a transfer descriptor for reading bytes from the spi device
+    * The descriptor may be set up once and executed repeatedly with @link spi_device#transfer(spi_ioc_transfer*, std::size_t)
+    * as long as the buffer stays valid.
+    * @param xfer the transfer descriptor to be filled
+    * @param rx_buffer pointer to the buffer in which the data shall be placed
+    * @param n_bytes number of bytes to read
+    */
+    void prepare_read_transfer(spi_ioc_transfer& xfer, std::uint8_t* rx_buffer, std::size_t n_bytes) const;
+
+    /**
+    * @brief execute an array of pre-built transfer descriptors in one ioctl call
+    * @param xfers pointer to the array of transfer descriptors
+    * @param n_xfers number of descriptors in the array
+    * @return true, if the transfer operation was successfull
+    */
+    [[nodiscard]] auto transfer(spi_ioc_transfer* xfers, std::size_t n_xfers) -> bool;
+
 protected:
     void set_flag(Flags flag);
     void unset_flag(Flags flag);
@@ -0,0 +1,34 @@
+#include <ctime>
+
+#include "timebase.h"
+
+namespace PiRaTe {
+
+constexpr double JD_UNIX_EPOCH { 2440587.5 }; //< Julian Date of 1970-01-01 00:00:00 UTC
+constexpr double SECONDS_PER_DAY { 86400. };
+
+TimeBase::TimeBase()
+{
+    update();
+}
+
+void TimeBase::update()
+{
+    fTime = now();
+    fJulianDay = julianDay(fTime);
+}
+
+auto TimeBase::now() -> time_point
+{
+    struct timespec ts { };
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return time_point { std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)) };
+}
+
+auto TimeBase::julianDay(time_point time) -> double
+{
+    return JD_UNIX_EPOCH + std::chrono::duration<double>(time.time_since_epoch()).count() / SECONDS_PER_DAY;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+
+namespace PiRaTe {
+
+/**
+ * @brief Common high-resolution time base for coordinate conversions and time stamps
+ * The wall clock is sampled with clock_gettime(CLOCK_REALTIME) once per update, usually once per poll cycle
+ * of the driver. The sampled time and the corresponding Julian Date are cached, so that all coordinate
+ * conversions, time displays and data records of one cycle refer to exactly the same, sub-millisecond epoch.
+ * Threads which time stamp their own samples (e.g. ADC loops) should use {@link TimeBase::now},
+ * which reads the same clock.
+ */
+class TimeBase {
+public:
+    using time_point = std::chrono::time_point<std::chrono::system_clock>;
+
+    TimeBase();
+
+    /**
+    * @brief sample the wall clock and set the epoch of the current cycle
+    */
+    void update();
+    /**
+    * @brief the epoch of the current cycle
+    */
+    [[nodiscard]] auto time() const -> time_point { return fTime; }
+    /**
+    * @brief the Julian Date (UTC) of the epoch of the current cycle
+    */
+    [[nodiscard]] auto julianDay() const -> double { return fJulianDay; }
+
+    /**
+    * @brief read the wall clock with full resolution
+    */
+    [[nodiscard]] static auto now() -> time_point;
+    /**
+    * @brief the Julian Date (UTC) of an arbitrary time point
+    */
+    [[nodiscard]] static auto julianDay(time_point time) -> double;
+
+private:
+    time_point fTime {};
+    double fJulianDay { 0. };
+};
+
+} // namespace PiRaTe
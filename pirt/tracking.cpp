@@ -0,0 +1,60 @@
+#include <cmath>
+
+#include "axis.h"
+#include "tracking.h"
+
+namespace PiRaTe {
+
+constexpr double SIDEREAL_ANGULAR_RATE { twopi() * 1.00273790935 / 86400. }; //< rate of the hour angle in rad/s
+constexpr double RAD_TO_DEG { 180. / pi() };
+constexpr double DEG_TO_RAD { pi() / 180. };
+
+void TrackingEngine::setTarget(double ra, double dec, double latitude, double lst, std::chrono::time_point<std::chrono::system_clock> epoch)
+{
+    fRa = ra;
+    fDec = dec;
+    fLatitude = latitude;
+    fHourAngle = twopi() * (lst - ra) / 24.;
+    fEpoch = epoch;
+    fValid = true;
+}
+
+auto TrackingEngine::isExpired(std::chrono::time_point<std::chrono::system_clock> time) const -> bool
+{
+    return (!fValid || (time - fEpoch) > MAX_EXPANSION_AGE || (fEpoch - time) > MAX_EXPANSION_AGE);
+}
+
+auto TrackingEngine::isRefreshDue(std::chrono::time_point<std::chrono::system_clock> time) const -> bool
+{
+    return (!fValid || (time - fEpoch) > REFRESH_AGE || (fEpoch - time) > REFRESH_AGE);
+}
+
+auto TrackingEngine::evaluate(std::chrono::time_point<std::chrono::system_clock> time) const -> State
+{
+    const double dt { std::chrono::duration<double>(time - fEpoch).count() };
+    const double h { fHourAngle + SIDEREAL_ANGULAR_RATE * dt };
+    const double sinH { std::sin(h) }, cosH { std::cos(h) };
+    const double sinDec { std::sin(fDec * DEG_TO_RAD) }, cosDec { std::cos(fDec * DEG_TO_RAD) };
+    const double sinLat { std::sin(fLatitude * DEG_TO_RAD) }, cosLat { std::cos(fLatitude * DEG_TO_RAD) };
+
+    // horizontal vector: x towards North, y towards East, z towards zenith
+    const double x { sinDec * cosLat - cosDec * cosH * sinLat };
+    const double y { -cosDec * sinH };
+    const double z { sinLat * sinDec + cosLat * cosDec * cosH };
+    // and its derivatives with respect to the hour angle
+    const double dx { cosDec * sinH * sinLat };
+    const double dy { -cosDec * cosH };
+    const double dz { -cosLat * cosDec * sinH };
+
+    const double rho2 { x * x + y * y };
+    State state {};
+    state.az = std::fmod(std::atan2(y, x) * RAD_TO_DEG + fAzOffset + 720., 360.);
+    state.alt = std::asin(z) * RAD_TO_DEG;
+    if (rho2 > 0.) {
+        state.azRate = SIDEREAL_ANGULAR_RATE * RAD_TO_DEG * (x * dy - y * dx) / rho2;
+        state.altRate = SIDEREAL_ANGULAR_RATE * RAD_TO_DEG * dz / std::sqrt(rho2);
+    }
+    return state;
+}
+
+} // namespace PiRaTe
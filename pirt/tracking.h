@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+
+namespace PiRaTe {
+
+/**
+ * @brief Closed-form tracking of an equatorial target in horizontal coordinates
+ * The engine is set up once per target with the target's RA/Dec, the site latitude and the local apparent sidereal time
+ * at a reference epoch. Afterwards, the horizontal position of the target and its time derivatives are evaluated
+ * for any time with a few trigonometric functions from the hour angle, which advances linearly at sidereal rate.
+ * This avoids the costly date conversion and full coordinate transformation for every evaluation.
+ * The expansion neglects the slow change of nutation and precession, so it should be refreshed
+ * (i.e. set up again) after {@link TrackingEngine::MAX_EXPANSION_AGE}.
+ * Azimuth values are counted from North through East, an additional constant offset can be
+ * specified to match other conventions.
+ */
+class TrackingEngine {
+public:
+    static constexpr std::chrono::minutes MAX_EXPANSION_AGE { 60 }; //< validity of an expansion keeping the error well below 1 arcsec
+    static constexpr std::chrono::minutes REFRESH_AGE { 48 }; //< age at which an expansion is set up again, ahead of its expiry
+
+    struct State {
+        double az { 0. }; ///<! azimuth in deg
+        double alt { 0. }; ///<! altitude in deg
+        double azRate { 0. }; ///<! azimuth rate in deg/s
+        double altRate { 0. }; ///<! altitude rate in deg/s
+    };
+
+    TrackingEngine() = default;
+
+    /**
+    * @brief set up the expansion for a new target
+    * @param ra right ascension of the target in h
+    * @param dec declination of the target in deg
+    * @param latitude geographic latitude of the site in deg
+    * @param lst local apparent sidereal time at the epoch in h
+    * @param epoch the reference time
+    */
+    void setTarget(double ra, double dec, double latitude, double lst, std::chrono::time_point<std::chrono::system_clock> epoch);
+    void setAzimuthOffset(double offset) { fAzOffset = offset; }
+    void invalidate() { fValid = false; }
+
+    [[nodiscard]] auto isValid() const -> bool { return fValid; }
+    [[nodiscard]] auto ra() const -> double { return fRa; }
+    [[nodiscard]] auto dec() const -> double { return fDec; }
+    [[nodiscard]] auto latitude() const -> double { return fLatitude; }
+    [[nodiscard]] auto isExpired(std::chrono::time_point<std::chrono::system_clock> time) const -> bool;
+    /**
+    * @brief the expansion should be set up again, since it approaches the end of its validity
+    * Refreshing at {@link TrackingEngine::REFRESH_AGE} leaves the users of a copy of the engine, e.g. the control loop,
+    * enough time to take over the new expansion before the old one expires.
+    */
+    [[nodiscard]] auto isRefreshDue(std::chrono::time_point<std::chrono::system_clock> time) const -> bool;
+    /**
+    * @brief horizontal position and rates of the target at the given time
+    */
+    [[nodiscard]] auto evaluate(std::chrono::time_point<std::chrono::system_clock> time) const -> State;
+
+private:
+    bool fValid { false };
+    double fRa { 0. };
+    double fDec { 0. };
+    double fLatitude { 0. };
+    double fHourAngle { 0. }; ///<! hour angle at the epoch in rad
+    double fAzOffset { 0. };
+    std::chrono::time_point<std::chrono::system_clock> fEpoch {};
+};
+
+} // namespace PiRaTe
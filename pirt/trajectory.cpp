@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cmath>
+
+#include "trajectory.h"
+
+namespace PiRaTe {
+
+TrapezoidalProfile::TrapezoidalProfile(double start, double distance, Limits limits)
+    : fStart { start }
+    , fDistance { distance }
+    , fDir { (distance < 0.) ? -1. : 1. }
+{
+    if (limits.velocity <= 0. || limits.acceleration <= 0.)
+        return;
+    fAcceleration = limits.acceleration;
+    const double d { std::abs(distance) };
+    if (d * fAcceleration >= limits.velocity * limits.velocity) {
+        // the velocity limit is reached: trapezoid
+        fPeakVelocity = limits.velocity;
+        fAccTime = fPeakVelocity / fAcceleration;
+        fCruiseTime = (d - fPeakVelocity * fAccTime) / fPeakVelocity;
+    } else {
+        // the velocity limit is not reached: triangle
+        fPeakVelocity = std::sqrt(d * fAcceleration);
+        fAccTime = fPeakVelocity / fAcceleration;
+        fCruiseTime = 0.;
+    }
+}
+
+void TrapezoidalProfile::stretchTo(double duration)
+{
+    if (duration <= this->duration() || fPeakVelocity <= 0.)
+        return;
+    // the distance of a trapezoid with acceleration a, duration T and peak velocity v is d = v*(T - v/a),
+    // the smaller root of this quadratic equation in v is the profile with the requested duration
+    const double d { std::abs(fDistance) };
+    const double aT { fAcceleration * duration };
+    const double discriminant { std::max(aT * aT - 4. * fAcceleration * d, 0.) };
+    fPeakVelocity = 0.5 * (aT - std::sqrt(discriminant));
+    fAccTime = fPeakVelocity / fAcceleration;
+    fCruiseTime = std::max(duration - 2. * fAccTime, 0.);
+}
+
+auto TrapezoidalProfile::position(double t) const -> double
+{
+    if (t <= 0.)
+        return fStart;
+    if (t >= duration())
+        return endPosition();
+    double s { 0. };
+    if (t < fAccTime) {
+        s = 0.5 * fAcceleration * t * t;
+    } else if (t < fAccTime + fCruiseTime) {
+        s = 0.5 * fPeakVelocity * fAccTime + fPeakVelocity * (t - fAccTime);
+    } else {
+        const double tr { duration() - t };
+        s = std::abs(fDistance) - 0.5 * fAcceleration * tr * tr;
+    }
+    return fStart + fDir * s;
+}
+
+auto TrapezoidalProfile::velocity(double t) const -> double
+{
+    if (t <= 0. || t >= duration())
+        return 0.;
+    if (t < fAccTime)
+        return fDir * fAcceleration * t;
+    if (t < fAccTime + fCruiseTime)
+        return fDir * fPeakVelocity;
+    return fDir * fAcceleration * (duration() - t);
+}
+
+auto synchronize(TrapezoidalProfile& profile1, TrapezoidalProfile& profile2) -> double
+{
+    const double duration { std::max(profile1.duration(), profile2.duration()) };
+    profile1.stretchTo(duration);
+    profile2.stretchTo(duration);
+    return duration;
+}
+
+} // namespace PiRaTe
@@ -0,0 +1,62 @@
+#pragma once
+
+namespace PiRaTe {
+
+/**
+ * @brief Trapezoidal velocity profile for a point-to-point move of one axis
+ * The profile starts and ends at rest and consists of a phase of constant acceleration, an optional phase of constant
+ * velocity (cruise) and a phase of constant deceleration. When constructed, the profile is time-optimal for the
+ * given velocity and acceleration limits. Short moves which do not reach the velocity limit result in a triangular profile.
+ * A profile can be stretched to a longer duration by lowering its peak velocity while keeping the acceleration, which
+ * is used to let several axes arrive at the same time.
+ * Times are given in seconds relative to the start of the move, positions in deg.
+ */
+class TrapezoidalProfile {
+public:
+    struct Limits {
+        double velocity { 1. }; ///<! maximum velocity in deg/s
+        double acceleration { 1. }; ///<! maximum acceleration in deg/s^2
+    };
+
+    TrapezoidalProfile() = default;
+    /**
+    * @brief construct the time-optimal profile
+    * @param start start position
+    * @param distance signed distance to move
+    * @param limits velocity and acceleration limits, both must be positive
+    */
+    TrapezoidalProfile(double start, double distance, Limits limits);
+
+    /**
+    * @brief stretch the profile to the given duration
+    * The peak velocity is lowered such that the move takes exactly the given time. Durations shorter than the
+    * time-optimal one are ignored.
+    * @param duration the new duration of the move in s
+    */
+    void stretchTo(double duration);
+
+    [[nodiscard]] auto duration() const -> double { return 2. * fAccTime + fCruiseTime; }
+    [[nodiscard]] auto startPosition() const -> double { return fStart; }
+    [[nodiscard]] auto endPosition() const -> double { return fStart + fDistance; }
+    [[nodiscard]] auto peakVelocity() const -> double { return fDir * fPeakVelocity; }
+    [[nodiscard]] auto position(double t) const -> double;
+    [[nodiscard]] auto velocity(double t) const -> double;
+
+private:
+    double fStart { 0. };
+    double fDistance { 0. };
+    double fDir { 1. };
+    double fAcceleration { 1. };
+    double fPeakVelocity { 0. };
+    double fAccTime { 0. };
+    double fCruiseTime { 0. };
+};
+
+/**
+ * @brief synchronize the profiles of two axes
+ * The faster profile is stretched to the duration of the slower one, so that both axes arrive at the same time.
+ * @return the common duration in s
+ */
+auto synchronize(TrapezoidalProfile& profile1, TrapezoidalProfile& profile2) -> double;
+
+} // namespace PiRaTe
@@ -9,6 +9,7 @@
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace PiRaTe {
@@ -35,6 +36,97 @@ private:
     bool m_full { false };
 };
 
+/**
+ * @brief Double-ended queue of fixed capacity
+ * The storage is allocated once with the capacity given in the constructor,
+ * pushing and popping elements never touches the heap. When the queue is full, push_back() rejects the new element.
+ * Elements are accessed by their index relative to the front.
+ */
+template <typename T>
+class CircularQueue {
+public:
+    CircularQueue() = default;
+    explicit CircularQueue(std::size_t capacity)
+        : m_buffer(capacity)
+    {
+    }
+
+    auto push_back(const T& item) -> bool;
+    void pop_front();
+    void pop_back();
+    void clear() { m_head = m_size = 0; }
+    [[nodiscard]] auto front() const -> const T& { return m_buffer[m_head]; }
+    [[nodiscard]] auto back() const -> const T& { return (*this)[m_size - 1]; }
+    [[nodiscard]] auto operator[](std::size_t index) const -> const T& { return m_buffer[(m_head + index) % m_buffer.size()]; }
+    [[nodiscard]] auto size() const -> std::size_t { return m_size; }
+    [[nodiscard]] auto empty() const -> bool { return (m_size == 0); }
+    [[nodiscard]] auto full() const -> bool { return (m_size >= m_buffer.size()); }
+    [[nodiscard]] auto capacity() const -> std::size_t { return m_buffer.size(); }
+
+private:
+    std::vector<T> m_buffer {};
+    std::size_t m_head { 0 };
+    std::size_t m_size { 0 };
+};
+
+/**
+ * @brief Compensated running sum
+ * Accumulates values with the Kahan-Babuska (Neumaier) compensation of the rounding errors. Values may also be
+ * removed again by subtraction, so that the sum of a sliding window can be maintained over arbitrary many updates
+ * without drifting away from the exact sum of the window.
+ */
+template <typename T>
+class KahanSum {
+public:
+    void add(T val);
+    void subtract(T val) { add(-val); }
+    void reset() { m_sum = m_compensation = T {}; }
+    [[nodiscard]] auto value() const -> T { return m_sum + m_compensation; }
+
+private:
+    T m_sum {};
+    T m_compensation {};
+};
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ * One thread may push items while another thread pops them concurrently without locking.
+ * The capacity N must be a power of two. When the ring is full, push() rejects the new item.
+ */
+template <typename T, std::size_t N>
+class SpscRing {
+    static_assert(N > 1 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    auto push(const T& item) -> bool;
+    auto pop(T& item) -> bool;
+    [[nodiscard]] auto size() const -> std::size_t;
+    [[nodiscard]] constexpr auto capacity() const -> std::size_t { return N; }
+
+private:
+    std::array<T, N> m_buffer {};
+    alignas(64) std::atomic<std::size_t> m_head { 0 }; ///<! write index, modified by the producer only
+    alignas(64) std::atomic<std::size_t> m_tail { 0 }; ///<! read index, modified by the consumer only
+};
+
+/**
+ * @brief Lock-free single-writer snapshot of a trivially copyable value
+ * The writer never blocks. Readers retry their copy until it was not overlapped by a write,
+ * which is detected with a sequence counter that is odd while a write is in progress.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+public:
+    void store(const T& value);
+    [[nodiscard]] auto load() const -> T;
+
+private:
+    T m_value {};
+    std::atomic<unsigned long> m_seq { 0 };
+};
+
 // +++++++++++++++++++++++++++++++
 // implementation part starts here
 // +++++++++++++++++++++++++++++++
@@ -91,4 +183,106 @@ auto Ringbuffer<T, N>::entries() const -> std::size_t
 }
 // -------------------------------
 
+// +++++++++++++++++++++++++++++++
+// class CircularQueue
+template <typename T>
+auto CircularQueue<T>::push_back(const T& item) -> bool
+{
+    if (full())
+        return false;
+    m_buffer[(m_head + m_size) % m_buffer.size()] = item;
+    m_size++;
+    return true;
+}
+
+template <typename T>
+void CircularQueue<T>::pop_front()
+{
+    if (m_size == 0)
+        return;
+    m_head = (m_head + 1) % m_buffer.size();
+    m_size--;
+}
+
+template <typename T>
+void CircularQueue<T>::pop_back()
+{
+    if (m_size > 0)
+        m_size--;
+}
+// -------------------------------
+
+// +++++++++++++++++++++++++++++++
+// class KahanSum
+template <typename T>
+void KahanSum<T>::add(T val)
+{
+    const T sum { m_sum + val };
+    if (std::abs(m_sum) >= std::abs(val))
+        m_compensation += (m_sum - sum) + val;
+    else
+        m_compensation += (val - sum) + m_sum;
+    m_sum = sum;
+}
+// -------------------------------
+
+// +++++++++++++++++++++++++++++++
+// class SpscRing
+template <typename T, std::size_t N>
+auto SpscRing<T, N>::push(const T& item) -> bool
+{
+    const std::size_t head { m_head.load(std::memory_order_relaxed) };
+    if (head - m_tail.load(std::memory_order_acquire) >= N)
+        return false;
+    m_buffer[head & (N - 1)] = item;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, std::size_t N>
+auto SpscRing<T, N>::pop(T& item) -> bool
+{
+    const std::size_t tail { m_tail.load(std::memory_order_relaxed) };
+    if (tail == m_head.load(std::memory_order_acquire))
+        return false;
+    item = m_buffer[tail & (N - 1)];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, std::size_t N>
+auto SpscRing<T, N>::size() const -> std::size_t
+{
+    return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+}
+// -------------------------------
+
+// +++++++++++++++++++++++++++++++
+// class SeqLock
+template <typename T>
+void SeqLock<T>::store(const T& value)
+{
+    const unsigned long seq { m_seq.load(std::memory_order_relaxed) };
+    m_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_value = value;
+    m_seq.store(seq + 2, std::memory_order_release);
+}
+
+template <typename T>
+auto SeqLock<T>::load() const -> T
+{
+    T value {};
+    unsigned long seq1 { 0 };
+    unsigned long seq2 { 0 };
+    do {
+        seq1 = m_seq.load(std::memory_order_acquire);
+        value = m_value;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seq2 = m_seq.load(std::memory_order_relaxed);
+    } while ((seq1 & 1) || seq1 != seq2);
+    return value;
+}
+// -------------------------------
+
 } // namespace PiRaTe
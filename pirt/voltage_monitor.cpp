@@ -62,24 +62,32 @@ void Ads1115VoltageMonitor::threadLoop()
     while (fActiveLoop) {
         auto currentTime = std::chrono::system_clock::now();
 
-        if (hasAdc()) {
+        if (hasAdc() && !fExternalReadout) {
+            double voltage { 0. };
             if ([[maybe_unused]] bool readout_guard = true) {
                 // read current voltage from adc
                 fMutex.lock();
-                fVoltage = fAdc->readVoltage(fAdcChannel) * fDividerRatio;
+                voltage = fAdc->readVoltage(fAdcChannel);
                 fMutex.unlock();
             }
-            fMutex.lock();
-            fBuffer.add(fVoltage);
-            fUpdated = true;
-            fMutex.unlock();
-            if (fVoltageReadyFn)
-                fVoltageReadyFn(fVoltage);
+            processReadout(voltage);
         }
         std::this_thread::sleep_for(loop_delay);
     }
 }
 
+void Ads1115VoltageMonitor::processReadout(double adc_voltage)
+{
+    fMutex.lock();
+    fVoltage = adc_voltage * fDividerRatio;
+    fBuffer.add(fVoltage);
+    fUpdated = true;
+    const double voltage { fVoltage };
+    fMutex.unlock();
+    if (fVoltageReadyFn)
+        fVoltageReadyFn(voltage);
+}
+
 auto Ads1115VoltageMonitor::currentVoltage() -> double
 {
     std::lock_guard<std::mutex> lock(fMutex);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <inttypes.h> // uint8_t, etc
@@ -45,7 +46,17 @@ public:
     [[nodiscard]] auto dividerRatio() const -> double { return fDividerRatio; }
     [[nodiscard]] auto name() const -> std::string { return fName; }
 
+    [[nodiscard]] auto adc() -> std::shared_ptr<ADS1115>& { return fAdc; }
+    [[nodiscard]] auto adcChannel() const -> std::uint8_t { return fAdcChannel; }
+
     void registerVoltageReadyCallback(std::function<void(double)> fn) { fVoltageReadyFn = fn; }
+    /**
+    * @brief hand over the adc readout to an external instance, e.g. {@link AdcScheduler}
+    * When set, the monitor does not access the adc anymore and the external instance must supply
+    * the raw adc voltages with {@link Ads1115VoltageMonitor::processReadout}.
+    */
+    void setExternalReadout(bool external) { fExternalReadout = external; }
+    void processReadout(double adc_voltage);
 
 private:
     void threadLoop();
@@ -54,6 +65,7 @@ private:
     std::shared_ptr<ADS1115> fAdc { nullptr };
     bool fUpdated { false };
     bool fActiveLoop { false };
+    std::atomic<bool> fExternalReadout { false };
     std::uint8_t fAdcChannel { 0 };
 
     std::unique_ptr<std::thread> fThread { nullptr };
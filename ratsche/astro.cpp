@@ -123,6 +123,30 @@ SphereCoords EquToHor(const SphereCoords &Equ,
 
 
 
+SphereCoords SunPosition(const Time& t)
+{
+	SphereCoords Equ;
+
+	long double n, L, g, lambda, epsilon;
+
+	/* days since J2000.0 */
+	n = t.JD() - 2451545.0L;
+
+	/* mean longitude and mean anomaly of the sun */
+	L = DegToRad<long double>( 280.460L + 0.9856474L * n );
+	g = DegToRad<long double>( 357.528L + 0.9856003L * n );
+
+	/* ecliptic longitude and obliquity of the ecliptic */
+	lambda = L + DegToRad<long double>( 1.915L * sin(g) + 0.020L * sin(2. * g) );
+	epsilon = DegToRad<long double>( 23.439L - 0.0000004L * n );
+
+	Equ.Phi() = modpi2 (atan2 (cos (epsilon) * sin (lambda), cos (lambda)));
+	Equ.Theta() = asin (sin (epsilon) * sin (lambda));
+
+	return Equ;
+}
+
+
 ostream& operator<<(ostream& o, const SphereCoords &c)
 {
 	o<<"("<<c[0]<<","<<c[1]<<")";
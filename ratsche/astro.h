@@ -249,6 +249,16 @@ SphereCoords EquToHor(const SphereCoords &Equ,
                       
 
 
+//! apparent position of the sun
+/*! low precision solar coordinates (accuracy ~0.01deg)
+    for the years 1950 to 2050 \n
+    \param t Time
+    \return equatorial coordinates (RA,Dec) of the sun in radians
+    \par Reference:
+    The Astronomical Almanac, section C "Low precision formulas for the sun"
+ */
+SphereCoords SunPosition(const Time& t);
+
 /*!
 * \param JD Julian Day
 * \return TD
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "journal.h"
+
+using namespace std;
+
+constexpr uint32_t JOURNAL_MAGIC { 0x5254534aU }; //< "RTSJ"
+constexpr size_t LEGACY_TASK_SIZE { offsetof(task_t, requested_time) }; //< record size of task files without the requested start time
+
+namespace {
+
+uint32_t crc32(const void* data, size_t size)
+{
+	const uint8_t* bytes { static_cast<const uint8_t*>(data) };
+	uint32_t crc { 0xffffffffU };
+	for ( size_t i = 0; i < size; i++ ) {
+		crc ^= bytes[i];
+		for ( int bit = 0; bit < 8; bit++ ) {
+			crc = ( crc >> 1 ) ^ ( 0xedb88320U & ( 0U - ( crc & 1U ) ) );
+		}
+	}
+	return ~crc;
+}
+
+// write the complete buffer, resuming after interrupts and partial writes
+bool writeAll(int fd, const char* data, size_t size)
+{
+	while ( size > 0 ) {
+		const ssize_t n { write(fd, data, size) };
+		if ( n < 0 ) {
+			if ( errno == EINTR ) continue;
+			return false;
+		}
+		data += n;
+		size -= static_cast<size_t>(n);
+	}
+	return true;
+}
+
+// make a rename persistent by syncing the directory
+void syncDirectory(const string& filename)
+{
+	const size_t pos { filename.rfind('/') };
+	const string dir { ( pos == string::npos ) ? "." : ( pos == 0 ) ? "/" : filename.substr(0, pos) };
+	const int fd { open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC) };
+	if ( fd < 0 ) return;
+	fsync(fd);
+	close(fd);
+}
+
+void upsert(vector<task_t>& tasklist, const task_t& task)
+{
+	auto it = std::find_if(tasklist.begin(), tasklist.end(), [&task](const task_t& t) { return t.id == task.id; });
+	if ( it != tasklist.end() ) *it = task;
+	else tasklist.push_back(task);
+}
+
+} // namespace
+
+
+TaskJournal::TaskJournal(const string& filename, size_t compactRecords)
+	: fSnapshotFile(filename), fJournalFile(filename + ".journal"), fCompactRecords(compactRecords)
+{
+}
+
+TaskJournal::~TaskJournal()
+{
+	if ( fFd >= 0 ) close(fFd);
+}
+
+bool TaskJournal::OpenJournal()
+{
+	if ( fFd >= 0 ) return true;
+	fFd = open(fJournalFile.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if ( fFd < 0 ) {
+		syslog (LOG_ERR, "unable to open task journal %s: %s", fJournalFile.c_str(), strerror(errno));
+		return false;
+	}
+	return true;
+}
+
+bool TaskJournal::Append(RECORDTYPE type, const void* data, uint32_t size)
+{
+	if ( !OpenJournal() ) return false;
+	RecordHeader header { };
+	header.magic = JOURNAL_MAGIC;
+	header.type = type;
+	header.size = size;
+	header.checksum = crc32(data, size);
+	// header and payload go to the file with a single write, so a record is torn at most at the end of the journal
+	vector<char> buffer(sizeof(RecordHeader) + size);
+	memcpy(buffer.data(), &header, sizeof(RecordHeader));
+	if ( size > 0 ) memcpy(buffer.data() + sizeof(RecordHeader), data, size);
+	if ( !writeAll(fFd, buffer.data(), buffer.size()) || fdatasync(fFd) < 0 ) {
+		syslog (LOG_ERR, "error writing to task journal %s: %s", fJournalFile.c_str(), strerror(errno));
+		return false;
+	}
+	fRecords++;
+	return true;
+}
+
+bool TaskJournal::Delete(long id)
+{
+	const int64_t _id { id };
+	return Append(REC_DELETE, &_id, sizeof(_id));
+}
+
+bool TaskJournal::ReadSnapshot(vector<task_t>& tasklist) const
+{
+	uint32_t num_tasks { 0 };
+	std::ifstream file( fSnapshotFile, ios_base::in | ios::binary );
+	if ( file.fail() || !file.good() ) {
+		return false;
+	}
+	file.read( reinterpret_cast<char*>(&num_tasks), sizeof(uint32_t) );
+	if ( !file ) return false;
+	// the record size tells the task file of a previous version
+	file.seekg(0, ios_base::end);
+	const streamoff size { file.tellg() };
+	file.seekg(sizeof(uint32_t), ios_base::beg);
+	const bool legacy { num_tasks > 0 && size == (streamoff)( sizeof(uint32_t) + num_tasks * LEGACY_TASK_SIZE ) };
+	const size_t record_size { legacy ? LEGACY_TASK_SIZE : sizeof(task_t) };
+	for ( uint32_t i = 0; i < num_tasks; i++ ) {
+		task_t task { };
+		file.read( reinterpret_cast<char*>(&task), record_size );
+		if ( !file ) {
+			syslog (LOG_WARNING, "task file %s is truncated, read %u of %u tasks", fSnapshotFile.c_str(), i, num_tasks);
+			break;
+		}
+		if ( legacy ) task.requested_time = task.start_time;
+		tasklist.emplace_back( std::move(task) );
+	}
+	return true;
+}
+
+bool TaskJournal::WriteSnapshot(const vector<task_t>& tasklist) const
+{
+	const string tmpfile { fSnapshotFile + ".tmp" };
+	const int fd { open(tmpfile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) };
+	if ( fd < 0 ) {
+		syslog (LOG_ERR, "unable to open task file %s: %s", tmpfile.c_str(), strerror(errno));
+		return false;
+	}
+	const uint32_t num_tasks = tasklist.size();
+	vector<char> buffer(sizeof(uint32_t) + num_tasks * sizeof(task_t));
+	memcpy(buffer.data(), &num_tasks, sizeof(uint32_t));
+	for ( uint32_t i = 0; i < num_tasks; i++ ) {
+		memcpy(buffer.data() + sizeof(uint32_t) + i * sizeof(task_t), &tasklist[i], sizeof(task_t));
+	}
+	const bool success { writeAll(fd, buffer.data(), buffer.size()) && fsync(fd) == 0 };
+	close(fd);
+	if ( !success || rename(tmpfile.c_str(), fSnapshotFile.c_str()) < 0 ) {
+		syslog (LOG_ERR, "error writing task file %s: %s", fSnapshotFile.c_str(), strerror(errno));
+		unlink(tmpfile.c_str());
+		return false;
+	}
+	syncDirectory(fSnapshotFile);
+	return true;
+}
+
+bool TaskJournal::Replay(vector<task_t>& tasklist)
+{
+	fRecords = 0;
+	std::ifstream file( fJournalFile, ios_base::in | ios::binary );
+	if ( file.fail() || !file.good() ) {
+		return false;
+	}
+	streamoff valid { 0 };
+	vector<char> payload;
+	while ( true ) {
+		RecordHeader header { };
+		file.read( reinterpret_cast<char*>(&header), sizeof(RecordHeader) );
+		if ( !file ) break;
+		if ( header.magic != JOURNAL_MAGIC || header.size > sizeof(task_t) ) break;
+		payload.resize(header.size);
+		if ( header.size > 0 ) file.read( payload.data(), header.size );
+		if ( !file || crc32(payload.data(), header.size) != header.checksum ) break;
+
+		switch ( header.type ) {
+			case REC_ADD:
+			case REC_UPDATE: {
+				if ( header.size != sizeof(task_t) ) break;
+				task_t task { };
+				memcpy(static_cast<void*>(&task), payload.data(), sizeof(task_t));
+				upsert(tasklist, task);
+				break;
+			}
+			case REC_DELETE: {
+				if ( header.size != sizeof(int64_t) ) break;
+				int64_t id;
+				memcpy(&id, payload.data(), sizeof(int64_t));
+				tasklist.erase( std::remove_if(tasklist.begin(), tasklist.end(), [id](const task_t& t) { return t.id == id; }), tasklist.end() );
+				break;
+			}
+			case REC_CLEAR:
+				tasklist.clear();
+				break;
+			default:
+				break;
+		}
+		fRecords++;
+		valid = file.tellg();
+	}
+	file.clear();
+	file.seekg(0, ios_base::end);
+	const streamoff size { file.tellg() };
+	file.close();
+	syslog (LOG_DEBUG, "replayed %zu record(s) from task journal %s", fRecords, fJournalFile.c_str());
+
+	if ( valid < size ) {
+		// cut off the remains of a record which was torn by a crash, so new records are appended behind the valid ones
+		syslog (LOG_WARNING, "discarding %ld byte(s) of incomplete records from task journal %s", (long)(size - valid), fJournalFile.c_str());
+		if ( truncate(fJournalFile.c_str(), valid) < 0 ) {
+			syslog (LOG_ERR, "error truncating task journal %s: %s", fJournalFile.c_str(), strerror(errno));
+		}
+	}
+	return true;
+}
+
+bool TaskJournal::Load(vector<task_t>& tasklist)
+{
+	tasklist.clear();
+	const bool snapshot { ReadSnapshot(tasklist) };
+	const bool journal { Replay(tasklist) };
+	return ( snapshot || journal );
+}
+
+bool TaskJournal::Compact(const vector<task_t>& tasklist)
+{
+	if ( !WriteSnapshot(tasklist) ) return false;
+	// the records of the journal are contained in the new snapshot now
+	if ( !OpenJournal() || ftruncate(fFd, 0) < 0 || fsync(fFd) < 0 ) {
+		syslog (LOG_ERR, "error truncating task journal %s: %s", fJournalFile.c_str(), strerror(errno));
+		return false;
+	}
+	fRecords = 0;
+	return true;
+}
@@ -0,0 +1,75 @@
+#ifndef _JOURNAL_H
+#define _JOURNAL_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "ratsche_message.h"
+
+/** @class TaskJournal
+crash-safe persistent storage of the task list.
+The task list is stored as a snapshot file plus an append-only journal file (snapshot file name + ".journal").
+Every modification of the task list (new task, change of state or schedule time, deletion of a task or of all
+tasks) is appended to the journal as a single record and flushed to the storage device. So each modification
+only writes a few hundred bytes instead of the complete list.
+When the journal grows beyond a limit, it is compacted: the current task list is written to a temporary file
+which is synced and atomically renamed to the snapshot file, then the journal is truncated. A power cut at any
+point leaves either the old or the new snapshot together with a journal that can be replayed on top of it,
+since the replay of each record is idempotent. This requires that the tasks keep their IDs when the list is
+loaded again. Records are protected by a checksum, a torn record at the end of the journal is discarded on replay.
+The snapshot file is an array of task_t records. Task files of previous versions, whose records lack the
+requested start time, are still read.
+*/
+class TaskJournal
+{
+	public:
+		TaskJournal() = delete;
+		TaskJournal(const TaskJournal&) = delete;
+		TaskJournal& operator=(const TaskJournal&) = delete;
+		/*!
+		 \param filename path of the snapshot file
+		 \param compactRecords nr. of journal records after which Compact() is due
+		*/
+		explicit TaskJournal(const std::string& filename, std::size_t compactRecords = 256);
+		~TaskJournal();
+
+		/*! read the snapshot and replay the journal
+		 \return false if neither the snapshot nor the journal could be read
+		*/
+		bool Load(std::vector<task_t>& tasklist);
+		/*! replace the snapshot by the given task list and truncate the journal
+		*/
+		bool Compact(const std::vector<task_t>& tasklist);
+		[[nodiscard]] bool isCompactionDue() const { return fRecords >= fCompactRecords; }
+
+		bool Add(const task_t& task) { return Append(REC_ADD, &task, sizeof(task_t)); }
+		bool Update(const task_t& task) { return Append(REC_UPDATE, &task, sizeof(task_t)); }
+		bool Delete(long id);
+		bool Clear() { return Append(REC_CLEAR, nullptr, 0); }
+
+	private:
+		enum RECORDTYPE : uint8_t { REC_ADD=1, REC_UPDATE, REC_DELETE, REC_CLEAR };
+		struct RecordHeader {
+			uint32_t magic;
+			uint8_t type;
+			uint8_t reserved[3];
+			uint32_t size;		//< size of the payload in bytes
+			uint32_t checksum;	//< crc32 of the payload
+		};
+
+		bool Append(RECORDTYPE type, const void* data, uint32_t size);
+		bool OpenJournal();
+		bool ReadSnapshot(std::vector<task_t>& tasklist) const;
+		bool WriteSnapshot(const std::vector<task_t>& tasklist) const;
+		bool Replay(std::vector<task_t>& tasklist);
+
+		std::string fSnapshotFile;
+		std::string fJournalFile;
+		int fFd { -1 };
+		std::size_t fRecords { 0 };
+		std::size_t fCompactRecords;
+};
+
+#endif // _JOURNAL_H
@@ -0,0 +1,222 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <string.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "journal.h"
+
+using namespace std;
+
+namespace {
+
+task_t makeTask(long id, time_t start)
+{
+	task_t task;
+	memset(static_cast<void*>(&task), 0, sizeof(task_t));
+	task.id = id;
+	task.type = 1;
+	task.start_time = start;
+	task.requested_time = start;
+	task.priority = 3;
+	strcpy(task.user, "test");
+	return task;
+}
+
+string readFile(const string& filename)
+{
+	ifstream file( filename, ios::binary );
+	return string( istreambuf_iterator<char>(file), istreambuf_iterator<char>() );
+}
+
+void writeFile(const string& filename, const string& content)
+{
+	ofstream file( filename, ios::binary | ios::trunc );
+	file.write( content.data(), content.size() );
+}
+
+off_t fileSize(const string& filename)
+{
+	return static_cast<off_t>( readFile(filename).size() );
+}
+
+} // namespace
+
+class TaskJournalTest : public ::testing::Test
+{
+	protected:
+		void SetUp() override
+		{
+			char dir[] { "/tmp/ratsche_journal_XXXXXX" };
+			ASSERT_NE(mkdtemp(dir), nullptr);
+			fDir = dir;
+			fSnapshot = fDir + "/tasks.dat";
+			fJournal = fSnapshot + ".journal";
+		}
+		void TearDown() override
+		{
+			for ( const string& file : { fSnapshot, fJournal, fSnapshot + ".tmp" } ) unlink(file.c_str());
+			rmdir(fDir.c_str());
+		}
+		vector<task_t> Load()
+		{
+			vector<task_t> tasks;
+			TaskJournal journal(fSnapshot);
+			EXPECT_TRUE(journal.Load(tasks));
+			return tasks;
+		}
+
+		string fDir;
+		string fSnapshot;
+		string fJournal;
+};
+
+TEST_F(TaskJournalTest, ReplaysAllRecordTypes)
+{
+	{
+		TaskJournal journal(fSnapshot);
+		EXPECT_TRUE(journal.Add(makeTask(1, 1000)));
+		EXPECT_TRUE(journal.Add(makeTask(2, 2000)));
+		task_t task { makeTask(1, 1500) };
+		task.status = 2;
+		EXPECT_TRUE(journal.Update(task));
+		EXPECT_TRUE(journal.Delete(2));
+		EXPECT_TRUE(journal.Add(makeTask(3, 3000)));
+	}
+	const vector<task_t> tasks { Load() };
+	ASSERT_EQ(tasks.size(), 2u);
+	EXPECT_EQ(tasks[0].id, 1);
+	EXPECT_EQ(tasks[0].start_time, 1500);
+	EXPECT_EQ(tasks[0].status, 2);
+	EXPECT_EQ(tasks[1].id, 3);
+
+	{
+		TaskJournal journal(fSnapshot);
+		EXPECT_TRUE(journal.Clear());
+	}
+	EXPECT_TRUE(Load().empty());
+}
+
+TEST_F(TaskJournalTest, DiscardsTornRecordAtTheEnd)
+{
+	{
+		TaskJournal journal(fSnapshot);
+		EXPECT_TRUE(journal.Add(makeTask(1, 1000)));
+		EXPECT_TRUE(journal.Add(makeTask(2, 2000)));
+	}
+	// a crash while the last record was written leaves only a part of it
+	const off_t complete { fileSize(fJournal) };
+	ASSERT_EQ(truncate(fJournal.c_str(), complete - 10), 0);
+
+	vector<task_t> tasks;
+	TaskJournal journal(fSnapshot);
+	EXPECT_TRUE(journal.Load(tasks));
+	ASSERT_EQ(tasks.size(), 1u);
+	EXPECT_EQ(tasks[0].id, 1);
+	// the remains of the torn record are cut off, so new records follow the valid ones
+	EXPECT_LT(fileSize(fJournal), complete - 10);
+	EXPECT_TRUE(journal.Add(makeTask(3, 3000)));
+
+	tasks = Load();
+	ASSERT_EQ(tasks.size(), 2u);
+	EXPECT_EQ(tasks[1].id, 3);
+}
+
+TEST_F(TaskJournalTest, RejectsCorruptedRecord)
+{
+	{
+		TaskJournal journal(fSnapshot);
+		EXPECT_TRUE(journal.Add(makeTask(1, 1000)));
+		EXPECT_TRUE(journal.Add(makeTask(2, 2000)));
+	}
+	// flip a bit in the payload of the last record
+	string content { readFile(fJournal) };
+	content[content.size() - 20] ^= 0x01;
+	writeFile(fJournal, content);
+
+	const vector<task_t> tasks { Load() };
+	ASSERT_EQ(tasks.size(), 1u);
+	EXPECT_EQ(tasks[0].id, 1);
+}
+
+TEST_F(TaskJournalTest, CompactionReplacesSnapshotAndTruncatesJournal)
+{
+	TaskJournal journal(fSnapshot, 2);
+	EXPECT_TRUE(journal.Add(makeTask(1, 1000)));
+	EXPECT_FALSE(journal.isCompactionDue());
+	EXPECT_TRUE(journal.Add(makeTask(2, 2000)));
+	EXPECT_TRUE(journal.isCompactionDue());
+	EXPECT_TRUE(journal.Compact({ makeTask(1, 1000), makeTask(2, 2000) }));
+	EXPECT_FALSE(journal.isCompactionDue());
+	EXPECT_EQ(fileSize(fJournal), 0);
+	EXPECT_TRUE(journal.Delete(1));
+
+	const vector<task_t> tasks { Load() };
+	ASSERT_EQ(tasks.size(), 1u);
+	EXPECT_EQ(tasks[0].id, 2);
+}
+
+TEST_F(TaskJournalTest, SurvivesCompactionInterruptedBeforeRename)
+{
+	{
+		TaskJournal journal(fSnapshot);
+		EXPECT_TRUE(journal.Compact({ makeTask(1, 1000) }));
+		EXPECT_TRUE(journal.Add(makeTask(2, 2000)));
+	}
+	// the temporary snapshot of the interrupted compaction was not completely written
+	writeFile(fSnapshot + ".tmp", string("\x05\x00\x00\x00garbage", 11));
+
+	const vector<task_t> tasks { Load() };
+	ASSERT_EQ(tasks.size(), 2u);
+	EXPECT_EQ(tasks[0].id, 1);
+	EXPECT_EQ(tasks[1].id, 2);
+}
+
+TEST_F(TaskJournalTest, SurvivesCompactionInterruptedAfterRename)
+{
+	{
+		TaskJournal journal(fSnapshot);
+		EXPECT_TRUE(journal.Add(makeTask(1, 1000)));
+		EXPECT_TRUE(journal.Add(makeTask(2, 2000)));
+		EXPECT_TRUE(journal.Delete(1));
+		task_t task { makeTask(2, 2500) };
+		EXPECT_TRUE(journal.Update(task));
+	}
+	const string records { readFile(fJournal) };
+	{
+		TaskJournal journal(fSnapshot);
+		EXPECT_TRUE(journal.Compact({ makeTask(2, 2500) }));
+	}
+	// the new snapshot is in place, but the journal was not truncated, so its records are replayed once more
+	writeFile(fJournal, records);
+
+	const vector<task_t> tasks { Load() };
+	ASSERT_EQ(tasks.size(), 1u);
+	EXPECT_EQ(tasks[0].id, 2);
+	EXPECT_EQ(tasks[0].start_time, 2500);
+}
+
+TEST_F(TaskJournalTest, ReadsLegacyTaskFile)
+{
+	// task files of previous versions lack the requested start time
+	const size_t legacy_size { offsetof(task_t, requested_time) };
+	const uint32_t num_tasks { 2 };
+	string content( reinterpret_cast<const char*>(&num_tasks), sizeof(uint32_t) );
+	for ( long id : { 1L, 2L } ) {
+		const task_t task { makeTask(id, 1000 * id) };
+		content.append( reinterpret_cast<const char*>(&task), legacy_size );
+	}
+	writeFile(fSnapshot, content);
+
+	const vector<task_t> tasks { Load() };
+	ASSERT_EQ(tasks.size(), 2u);
+	EXPECT_EQ(tasks[1].id, 2);
+	EXPECT_EQ(tasks[1].start_time, 2000);
+	EXPECT_EQ(tasks[1].requested_time, 2000);
+}
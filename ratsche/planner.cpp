@@ -0,0 +1,454 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <sstream>
+
+#include <syslog.h>
+
+#include "planner.h"
+
+using namespace std;
+using namespace hgz;
+
+// weights of the terms of the candidate score
+constexpr double W_ELEVATION { 1. };		//< per unit of the mean sin(elevation) of the target
+constexpr double W_SLEW { 1./60. };			//< per second of slew time
+constexpr double W_DELAY_ASAP { 1. };		//< per hour of delay for priority 3 tasks ("asap when optimal")
+constexpr double W_DELAY_ANYTIME { 0.1 };	//< per hour of delay for priority 4 tasks ("anytime when optimal")
+constexpr double W_DELAY_LOW { 0.02 };		//< per hour of delay for priority 5 tasks ("low priority")
+
+namespace {
+
+// time for a move over the distance d (in deg) on a trapezoidal velocity profile
+double axisTime(double d, double vmax, double amax)
+{
+	if ( d <= 0. || vmax <= 0. ) return 0.;
+	if ( amax <= 0. ) return d / vmax;
+	// the axis does not reach the max. velocity on short moves
+	if ( d < vmax * vmax / amax ) return 2. * sqrt( d / amax );
+	return d / vmax + vmax / amax;
+}
+
+// angular distance of two horizontal positions in deg
+double angularDistance(const SphereCoords& a, const SphereCoords& b)
+{
+	const double cosd { sin( DegToRad(a.Theta()) ) * sin( DegToRad(b.Theta()) )
+		+ cos( DegToRad(a.Theta()) ) * cos( DegToRad(b.Theta()) ) * cos( DegToRad(a.Phi() - b.Phi()) ) };
+	return RadToDeg( acos( std::clamp(cosd, -1., 1.) ) );
+}
+
+// linear interpolation between two coordinate pairs
+SphereCoords interpolate(const SphereCoords& a, const SphereCoords& b, double frac)
+{
+	return SphereCoords( a.Phi() + ( b.Phi() - a.Phi() ) * frac, a.Theta() + ( b.Theta() - a.Theta() ) * frac );
+}
+
+double delayWeight(long priority)
+{
+	if ( priority <= 3 ) return W_DELAY_ASAP;
+	if ( priority == 4 ) return W_DELAY_ANYTIME;
+	return W_DELAY_LOW;
+}
+
+string timeString(long double t)
+{
+	ostringstream ostr;
+	ostr << Time(t);
+	return ostr.str();
+}
+
+} // namespace
+
+
+double SlewModel::SlewTime(const SphereCoords& from, const SphereCoords& to) const
+{
+	const double dAz { fabs( remainder( to.Phi() - from.Phi(), 360. ) ) };
+	const double dAlt { fabs( to.Theta() - from.Theta() ) };
+	if ( dAz < 1e-3 && dAlt < 1e-3 ) return 0.;
+	return std::max( axisTime(dAz, azSpeed, azAcceleration), axisTime(dAlt, altSpeed, altAcceleration) ) + settleTime;
+}
+
+
+SphereCoords Planner::EquToHorDeg(const SphereCoords& equ, long double t) const
+{
+	const SphereCoords site { DegToRad(fConfig.location.Phi()), DegToRad(fConfig.location.Theta()) };
+	const SphereCoords hor { EquToHor(equ, Time(t), site) };
+	// EquToHor counts the azimuth westwards from south, the telescope from north
+	return SphereCoords( fmod( RadToDeg(hor.Phi()) + 180., 360. ), RadToDeg(hor.Theta()) );
+}
+
+bool Planner::Position(const RTTask& task, long double t, double frac, SphereCoords& hor) const
+{
+	switch ( task.type() ) {
+		case RTTask::DRIFT:
+			hor = static_cast<const DriftScanTask&>(task).StartCoords();
+			break;
+		case RTTask::GOTOHOR:
+			hor = static_cast<const GotoHorTask&>(task).GotoCoords();
+			break;
+		case RTTask::HORSCAN: {
+			const HorScanTask& scan { static_cast<const HorScanTask&>(task) };
+			hor = interpolate( scan.StartCoords(), scan.EndCoords(), frac );
+			break;
+		}
+		case RTTask::TRACK: {
+			// equatorial coordinates are (RA,Dec) in (hours,deg)
+			const SphereCoords equ { static_cast<const TrackingTask&>(task).TrackCoords() };
+			hor = EquToHorDeg( SphereCoords( HToRad(equ.Phi()), DegToRad(equ.Theta()) ), t );
+			break;
+		}
+		case RTTask::GOTOEQU: {
+			const SphereCoords equ { static_cast<const GotoEquTask&>(task).GotoCoords() };
+			hor = EquToHorDeg( SphereCoords( HToRad(equ.Phi()), DegToRad(equ.Theta()) ), t );
+			break;
+		}
+		case RTTask::EQUSCAN: {
+			const EquScanTask& scan { static_cast<const EquScanTask&>(task) };
+			const SphereCoords equ { interpolate( scan.StartCoords(), scan.EndCoords(), frac ) };
+			hor = EquToHorDeg( SphereCoords( HToRad(equ.Phi()), DegToRad(equ.Theta()) ), t );
+			break;
+		}
+		default:
+			return false;
+	}
+	return ( std::isfinite(hor.Phi()) && std::isfinite(hor.Theta()) );
+}
+
+bool Planner::isFlexible(const RTTask& task) const
+{
+	if ( task.State() != RTTask::IDLE ) return false;
+	return ( task.Priority() >= 3 && task.AltPeriod() > -1e-4 );
+}
+
+Planner::Slot Planner::MakeSlot(const RTTask& task, long double start) const
+{
+	Slot slot { };
+	slot.id = task.ID();
+	slot.start = start;
+	slot.end = start + std::max(task.MaxRunTime(), 0.) * 3600.;
+	slot.park = ( task.type() == RTTask::PARK );
+	slot.target = Position(task, slot.start, 0., slot.startPos);
+	if ( slot.target ) slot.target = Position(task, slot.end, 1., slot.endPos);
+	return slot;
+}
+
+void Planner::Resolve(size_t first)
+{
+	// tasks without a target leave the telescope where it is
+	SphereCoords pointing { ( first > 0 && first <= fSlots.size() ) ? fSlots[first - 1].after : fPointing };
+	long double reach { ( first > 0 && first <= fSlots.size() ) ? fSlots[first - 1].reach : -HUGE_VALL };
+	for ( size_t i = first; i < fSlots.size(); i++ ) {
+		Slot& slot { fSlots[i] };
+		if ( slot.target ) slot.after = slot.endPos;
+		else if ( slot.park ) slot.after = fConfig.parkPosition;
+		else slot.after = pointing;
+		pointing = slot.after;
+		reach = std::max(reach, slot.end);
+		slot.reach = reach;
+	}
+}
+
+void Planner::AddSlot(const Slot& slot)
+{
+	const auto it { std::upper_bound(fSlots.begin(), fSlots.end(), slot, [](const Slot& a, const Slot& b) { return a.start < b.start; }) };
+	const size_t index { static_cast<size_t>( it - fSlots.begin() ) };
+	fSlots.insert(it, slot);
+	Resolve(index);
+}
+
+void Planner::Occupy(const vector<RTTask*>& tasks, const set<long>& excluded)
+{
+	const long double now { Time::Now().timestamp() };
+	fSlots.clear();
+	for ( const RTTask* task : tasks ) {
+		if ( excluded.count(task->ID()) ) continue;
+		if ( task->State() == RTTask::ACTIVE ) {
+			Slot slot { MakeSlot(*task, now - task->ElapsedTime() * 3600.) };
+			// the telescope will stay at the end position of the running task
+			if ( slot.target ) fPointing = slot.endPos;
+			else if ( slot.park ) fPointing = fConfig.parkPosition;
+			fSlots.push_back(slot);
+		} else if ( task->State() == RTTask::IDLE || task->State() == RTTask::WAITING ) {
+			fSlots.push_back( MakeSlot(*task, task->scheduleTime().timestamp()) );
+		}
+	}
+	std::stable_sort(fSlots.begin(), fSlots.end(), [](const Slot& a, const Slot& b) { return a.start < b.start; });
+	Resolve(0);
+}
+
+void Planner::Sync(const TaskStore& store, vector<Interval>& freed)
+{
+	const long double now { Time::Now().timestamp() };
+	bool moved { false };
+	size_t kept { 0 };
+	for ( size_t i = 0; i < fSlots.size(); i++ ) {
+		Slot& slot { fSlots[i] };
+		const RTTask* task { store.Find(slot.id) };
+		const bool pending { task != nullptr && ( task->State() == RTTask::IDLE || task->State() == RTTask::WAITING ) };
+		const bool active { task != nullptr && task->State() == RTTask::ACTIVE };
+		if ( !pending && !active ) {
+			// the rest of the window of a removed or terminated task is free
+			if ( slot.end > now ) freed.push_back( { std::max(slot.start, now), slot.end } );
+			continue;
+		}
+		if ( active ) {
+			// a task may start earlier or later than scheduled, e.g. when it had to wait for the axes
+			const long double start { now - task->ElapsedTime() * 3600. };
+			if ( fabs(start - slot.start) > 0.5 ) {
+				const long double end { slot.end };
+				slot = MakeSlot(*task, start);
+				moved = true;
+				// only the part of the old window behind the new end becomes free, the rest lies in the past
+				const Interval window { std::max(slot.end, now), end };
+				if ( window.start < window.end ) freed.push_back(window);
+			}
+			// the telescope will stay at the end position of the running task
+			if ( slot.target ) fPointing = slot.endPos;
+			else if ( slot.park ) fPointing = fConfig.parkPosition;
+		}
+		if ( kept != i ) fSlots[kept] = std::move(slot);
+		kept++;
+	}
+	fSlots.resize(kept);
+	if ( moved ) std::stable_sort(fSlots.begin(), fSlots.end(), [](const Slot& a, const Slot& b) { return a.start < b.start; });
+	Resolve(0);
+
+	for ( auto it = fDeferred.begin(); it != fDeferred.end(); ) {
+		const RTTask* task { store.Find(*it) };
+		if ( task == nullptr || !isFlexible(*task) ) it = fDeferred.erase(it);
+		else ++it;
+	}
+	if ( fDeferred.empty() ) fRetry = HUGE_VALL;
+}
+
+bool Planner::SunNear(const RTTask& task, long double t) const
+{
+	if ( fConfig.sunAvoidance <= 0. ) return false;
+	const long double duration { std::max(task.MaxRunTime(), 0.) * 3600. };
+	for ( double frac : { 0., 0.5, 1. } ) {
+		const long double ts { t + frac * duration };
+		SphereCoords hor;
+		if ( !Position(task, ts, frac, hor) ) return false;
+		const SphereCoords sun { EquToHorDeg( SunPosition(Time(ts)), ts ) };
+		if ( angularDistance(hor, sun) < fConfig.sunAvoidance ) return true;
+	}
+	return false;
+}
+
+bool Planner::Score(const RTTask& task, long double t, long double requested, bool solar, double& score) const
+{
+	const long double duration { std::max(task.MaxRunTime(), 0.) * 3600. };
+	const long double end { t + duration };
+
+	// the slots before and behind the candidate
+	SphereCoords before { fPointing };
+	long double prevEnd { -HUGE_VALL };
+	const auto it { std::upper_bound(fSlots.begin(), fSlots.end(), t, [](long double time, const Slot& slot) { return time < slot.start; }) };
+	if ( it != fSlots.begin() ) {
+		const Slot& prev { *std::prev(it) };
+		if ( prev.reach > t ) return false;
+		prevEnd = prev.reach;
+		before = prev.after;
+	}
+	const Slot* next { ( it != fSlots.end() ) ? &*it : nullptr };
+
+	// target constraints at the beginning, middle and end of the task
+	double elevation { 0. };
+	SphereCoords startPos, endPos;
+	const bool target { Position(task, t, 0., startPos) };
+	if ( target ) {
+		for ( double frac : { 0., 0.5, 1. } ) {
+			const long double ts { t + frac * duration };
+			SphereCoords hor;
+			if ( !Position(task, ts, frac, hor) ) return false;
+			if ( hor.Theta() < fConfig.minElevation ) return false;
+			if ( !solar && fConfig.sunAvoidance > 0. ) {
+				const SphereCoords sun { EquToHorDeg( SunPosition(Time(ts)), ts ) };
+				if ( angularDistance(hor, sun) < fConfig.sunAvoidance ) return false;
+			}
+			elevation += sin( DegToRad(hor.Theta()) ) / 3.;
+			if ( frac > 0.99 ) endPos = hor;
+		}
+	}
+
+	// the slews from the preceding and to the following task have to fit into the gap
+	const double slewIn { target ? fConfig.slew.SlewTime(before, startPos) : 0. };
+	if ( t - slewIn < prevEnd ) return false;
+	SphereCoords after { before };
+	if ( target ) after = endPos;
+	else if ( task.type() == RTTask::PARK ) after = fConfig.parkPosition;
+	double slewOut { 0. };
+	if ( next != nullptr ) {
+		if ( next->target ) slewOut = fConfig.slew.SlewTime(after, next->startPos);
+		if ( end + slewOut > next->start ) return false;
+	}
+
+	const double delay { static_cast<double>( std::max(t - requested, 0.L) / 3600. ) };
+	score = W_ELEVATION * elevation - W_SLEW * ( slewIn + slewOut ) - delayWeight(task.Priority()) * delay;
+	return true;
+}
+
+bool Planner::Place(const RTTask& task, long double& start)
+{
+	const long double now { Time::Now().timestamp() };
+	const long double limit { now + fConfig.horizon * 3600. };
+	const long double requested { Requested(task) };
+	const long double earliest { ceil( std::max(requested, now) ) };
+	if ( earliest > limit ) return false;
+
+	// a target close to the sun at the requested time is considered a solar observation
+	const bool solar { SunNear(task, requested) };
+
+	vector<long double> candidates;
+	const long double period { task.AltPeriod() * 3600. };
+	if ( task.AltPeriod() > 1e-4 ) {
+		// the conditions repeat only after multiples of the alt period
+		long double k { std::max( ceil( (now - requested) / period ), 0.L ) };
+		// whole seconds, since the task list stores the schedule times as time_t
+		for ( long double t = requested + k * period; t <= limit; t += period ) candidates.push_back( ceil(t) );
+	} else {
+		candidates.push_back(earliest);
+		// pack the task directly behind the occupied windows
+		const double maxSlew { MaxSlewTime() };
+		for ( const Slot& slot : fSlots ) {
+			if ( slot.end + maxSlew < earliest || slot.end > limit ) continue;
+			SphereCoords pos;
+			const double slew { Position(task, slot.end, 0., pos) ? fConfig.slew.SlewTime(slot.after, pos) : 0. };
+			// whole seconds, since the task list stores the schedule times as time_t
+			const long double t { ceil(slot.end + slew) };
+			if ( t >= earliest ) candidates.push_back(t);
+		}
+		if ( fConfig.timeStep > 0. ) {
+			for ( long double t = earliest + fConfig.timeStep; t <= limit; t += fConfig.timeStep ) candidates.push_back(t);
+		}
+	}
+
+	bool found { false };
+	double best { -HUGE_VAL };
+	for ( long double t : candidates ) {
+		double score;
+		if ( !Score(task, t, requested, solar, score) ) continue;
+		if ( !found || score > best ) {
+			best = score;
+			start = t;
+			found = true;
+		}
+	}
+	if ( !found ) return false;
+
+	AddSlot( MakeSlot(task, start) );
+	return true;
+}
+
+void Planner::Assign(TaskStore& store, RTTask& task)
+{
+	long double start;
+	if ( !Place(task, start) ) {
+		Defer(store, task);
+		return;
+	}
+	if ( fabs(start - task.scheduleTime().timestamp()) > 0.5 ) {
+		store.Reschedule(task.ID(), Time(start));
+		syslog (LOG_INFO, "planner: task id=%ld scheduled at %s", task.ID(), timeString(start).c_str());
+	}
+}
+
+void Planner::Defer(TaskStore& store, const RTTask& task)
+{
+	// an infeasible task must not start before it is placed, so it waits behind the planning horizon
+	const long double now { Time::Now().timestamp() };
+	const long double start { std::max( { ceil( now + fConfig.horizon * 3600. ), ceil( Requested(task) ), task.scheduleTime().timestamp() } ) };
+	fDeferred.insert(task.ID());
+	fRetry = std::min( fRetry, now + ( ( fConfig.timeStep > 0. ) ? fConfig.timeStep : 300. ) );
+	if ( fabs(start - task.scheduleTime().timestamp()) > 0.5 ) {
+		store.Reschedule(task.ID(), Time(start));
+	}
+	syslog (LOG_INFO, "planner: no feasible slot for task id=%ld within the planning horizon, deferred to %s", task.ID(), timeString(start).c_str());
+}
+
+void Planner::Reflow(TaskStore& store, vector<RTTask*>& tasks)
+{
+	if ( tasks.empty() ) return;
+	set<long> ids;
+	for ( const RTTask* task : tasks ) ids.insert(task->ID());
+	fSlots.erase( std::remove_if(fSlots.begin(), fSlots.end(), [&ids](const Slot& slot) { return ids.count(slot.id) > 0; }), fSlots.end() );
+	Resolve(0);
+	std::stable_sort(tasks.begin(), tasks.end(), [this](RTTask* a, RTTask* b) {
+		if ( a->Priority() != b->Priority() ) return a->Priority() < b->Priority();
+		return Requested(*a) < Requested(*b);
+	});
+	for ( RTTask* task : tasks ) {
+		fDeferred.erase(task->ID());
+		Assign(store, *task);
+	}
+}
+
+void Planner::Insert(TaskStore& store, long id)
+{
+	RTTask* task { store.Find(id) };
+	if ( task == nullptr ) return;
+	if ( isFlexible(*task) ) {
+		Assign(store, *task);
+		return;
+	}
+	if ( task->State() != RTTask::IDLE && task->State() != RTTask::WAITING ) return;
+	// a fixed task may collide with planned tasks, so re-place the flexible tasks around its window
+	const Slot slot { MakeSlot(*task, task->scheduleTime().timestamp()) };
+	AddSlot(slot);
+	// the slews to and from the new task may take up to the time of the longest slew
+	const double margin { MaxSlewTime() };
+	vector<RTTask*> affected;
+	for ( const Slot& other : fSlots ) {
+		if ( other.start >= slot.end + margin ) break;
+		if ( other.end + margin <= slot.start ) continue;
+		RTTask* candidate { store.Find(other.id) };
+		if ( candidate != nullptr && isFlexible(*candidate) ) affected.push_back(candidate);
+	}
+	Reflow(store, affected);
+}
+
+void Planner::Update(TaskStore& store)
+{
+	vector<Interval> freed;
+	Sync(store, freed);
+	// the flexible tasks behind a freed window may move into it, if they were requested before its end
+	vector<RTTask*> affected;
+	if ( !freed.empty() ) {
+		for ( const Slot& slot : fSlots ) {
+			RTTask* task { store.Find(slot.id) };
+			if ( task == nullptr || !isFlexible(*task) ) continue;
+			const long double requested { Requested(*task) };
+			if ( std::any_of(freed.begin(), freed.end(), [&slot, requested](const Interval& window) {
+				return ( slot.start >= window.start && requested < window.end ); }) ) {
+				affected.push_back(task);
+			}
+		}
+	}
+	// the deferred tasks are placed again from time to time, since the sky moves on
+	if ( Time::Now().timestamp() >= fRetry ) {
+		for ( long id : fDeferred ) {
+			RTTask* task { store.Find(id) };
+			if ( task != nullptr ) affected.push_back(task);
+		}
+		fDeferred.clear();
+		fRetry = HUGE_VALL;
+	}
+	Reflow(store, affected);
+}
+
+void Planner::Replan(TaskStore& store, long double from)
+{
+	const vector<RTTask*> tasks { store.Tasks() };
+	vector<RTTask*> flexible;
+	set<long> excluded;
+	for ( RTTask* task : tasks ) {
+		if ( !isFlexible(*task) ) continue;
+		if ( task->scheduleTime().timestamp() + std::max(task->MaxRunTime(), 0.) * 3600. <= from ) continue;
+		flexible.push_back(task);
+		excluded.insert(task->ID());
+	}
+	fDeferred.clear();
+	fRetry = HUGE_VALL;
+	Occupy(tasks, excluded);
+	Reflow(store, flexible);
+}
@@ -0,0 +1,136 @@
+#ifndef _PLANNER_H
+#define _PLANNER_H
+
+#include <cmath>
+#include <set>
+#include <vector>
+
+#include "rttask.h"
+#include "taskstore.h"
+#include "time.h"
+#include "astro.h"
+
+/** @class SlewModel
+estimate of the slew time of the telescope mount.
+Each axis moves on a trapezoidal velocity profile with the given limits, the slew time is the time of the
+slower axis plus the settling time of the mount. Horizontal coordinates are (Az,Alt) in degrees.
+*/
+struct SlewModel
+{
+	double azSpeed { 1.8 };			//< max. velocity of the Az axis in deg/s
+	double altSpeed { 1.8 };		//< max. velocity of the Alt axis in deg/s
+	double azAcceleration { 2.4 };	//< max. acceleration of the Az axis in deg/s^2
+	double altAcceleration { 2.4 };	//< max. acceleration of the Alt axis in deg/s^2
+	double settleTime { 5. };		//< time for settling and command overhead in s
+
+	/*! estimated time in s to slew between two horizontal positions
+	*/
+	[[nodiscard]] double SlewTime(const hgz::SphereCoords& from, const hgz::SphereCoords& to) const;
+};
+
+/** @class Planner
+optimising observation planner.
+The planner assigns start times to the flexible tasks, i.e. tasks with priority 3 ("asap when optimal"),
+4 ("anytime when optimal") or 5 ("low priority") and an alt_period >= 0. All other tasks are fixed to their
+schedule time and occupy their time window in the plan.
+Candidate start times of a flexible task are its requested time, the end of each occupied window (so tasks are
+packed back-to-back) and a regular grid. Tasks with alt_period > 0 may only be moved by multiples of the period.
+Each candidate is rejected if the target is below the minimum elevation or closer to the sun than the sun
+avoidance angle at the beginning, middle or end of the task, or if the task and the slews from the preceding and
+to the following task do not fit into the gap. The remaining candidates are scored by the mean elevation of the
+target, the slew times and the delay against the requested time weighted with the priority. The flexible tasks
+are placed one after another in order of priority and requested time within the planning horizon and the
+schedule time of the task is set to the best candidate. Tasks without a feasible candidate are deferred behind the
+planning horizon and placed again on the next replan, they never start without a feasible slot.
+The requested time is stored with the task, so a restart of the server does not move the plan.
+The plan is incremental: the planner keeps the occupied windows sorted by start time between the calls, a new
+flexible task is placed into the gaps of the current plan, a new fixed task re-places only the flexible tasks whose
+windows overlap it and the removal or termination of a task re-places only the flexible tasks which may move into
+the freed window.
+*/
+class Planner
+{
+	public:
+		struct Config {
+			hgz::SphereCoords location { 0., 0. };	//< observer location (longitude east, latitude) in deg
+			double horizon { 24. };				//< planning horizon in hours
+			double minElevation { 5. };			//< min. elevation of the targets in deg
+			double sunAvoidance { 10. };		//< min. angular distance of the targets to the sun in deg
+			double timeStep { 300. };			//< grid spacing of the candidate start times in s
+			hgz::SphereCoords parkPosition { 180., 89.7 };	//< (Az,Alt) park position of the telescope in deg
+			SlewModel slew { };
+		};
+
+		Planner() = delete;
+		explicit Planner(const Config& config) : fConfig(config), fPointing(config.parkPosition) {}
+
+		[[nodiscard]] const Config& config() const { return fConfig; }
+
+		/*! place a new task into the current plan
+		*/
+		void Insert(TaskStore& store, long id);
+		/*! bring the plan up to date after tasks were removed or terminated
+		 and place the deferred tasks again when their retry is due
+		*/
+		void Update(TaskStore& store);
+		/*! build the plan from scratch and place all flexible tasks anew which end after the given time
+		 \param from time stamp in seconds since 01/01/1970
+		*/
+		void Replan(TaskStore& store, long double from);
+		/*! time at which the deferred tasks have to be placed again
+		 \return time stamp in seconds since 01/01/1970, infinite if no task is deferred
+		*/
+		[[nodiscard]] long double NextDeadline() const { return fRetry; }
+
+		/*! horizontal position of the target of a task
+		 \param task the task
+		 \param t time stamp in seconds since 01/01/1970
+		 \param frac progress of the task (0..1), scans move from the start to the end corner of the window
+		 \param hor returns the (Az,Alt) position in deg
+		 \return false if the task has no target
+		*/
+		[[nodiscard]] bool Position(const RTTask& task, long double t, double frac, hgz::SphereCoords& hor) const;
+
+	private:
+		/// a time window occupied by a task
+		struct Slot {
+			long id { 0 };
+			long double start { 0. };
+			long double end { 0. };
+			bool target { false };			//< the task points the telescope
+			bool park { false };			//< the task parks the telescope
+			hgz::SphereCoords startPos { };	//< pointing at the beginning of the task
+			hgz::SphereCoords endPos { };	//< pointing at the end of the task
+			hgz::SphereCoords after { };	//< resolved pointing after the task
+			long double reach { 0. };		//< latest end of this and all preceding slots
+		};
+		/// a time window which became free
+		struct Interval {
+			long double start { 0. };
+			long double end { 0. };
+		};
+
+		[[nodiscard]] bool isFlexible(const RTTask& task) const;
+		[[nodiscard]] long double Requested(const RTTask& task) const { return task.requestedTime().timestamp(); }
+		[[nodiscard]] double MaxSlewTime() const { return fConfig.slew.SlewTime( hgz::SphereCoords(0., 0.), hgz::SphereCoords(180., 90.) ); }
+		[[nodiscard]] Slot MakeSlot(const RTTask& task, long double start) const;
+		void Occupy(const std::vector<RTTask*>& tasks, const std::set<long>& excluded);
+		void Sync(const TaskStore& store, std::vector<Interval>& freed);
+		void Resolve(std::size_t first);
+		void AddSlot(const Slot& slot);
+		void Reflow(TaskStore& store, std::vector<RTTask*>& tasks);
+		void Assign(TaskStore& store, RTTask& task);
+		void Defer(TaskStore& store, const RTTask& task);
+		[[nodiscard]] bool Place(const RTTask& task, long double& start);
+		[[nodiscard]] bool Score(const RTTask& task, long double t, long double requested, bool solar, double& score) const;
+		[[nodiscard]] bool SunNear(const RTTask& task, long double t) const;
+		[[nodiscard]] hgz::SphereCoords EquToHorDeg(const hgz::SphereCoords& equ, long double t) const;
+
+		Config fConfig;
+		hgz::SphereCoords fPointing;	//< last known pointing of the telescope
+		std::vector<Slot> fSlots;		//< occupied windows sorted by start time
+		std::set<long> fDeferred;		//< IDs of the tasks without a feasible slot
+		long double fRetry { HUGE_VALL };	//< time of the next attempt to place the deferred tasks
+};
+
+#endif // _PLANNER_H
@@ -0,0 +1,222 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "planner.h"
+#include "taskstore.h"
+#include "rttask.h"
+#include "time.h"
+#include "astro.h"
+
+using namespace std;
+using namespace hgz;
+
+namespace {
+
+// the planner works on the wall clock, so all times are given relative to the start of the test
+long double wholeSecondsNow()
+{
+	return floor( Time::Now().timestamp() );
+}
+
+RTTask* makeGoto(long id, int priority, long double start, double hours, const SphereCoords& hor, double altPeriod = 0.)
+{
+	RTTask* task { new GotoHorTask(id, priority, Time(start), Time(start), altPeriod, hor) };
+	task->SetMaxRunTime(hours);
+	return task;
+}
+
+RTTask* makeMaintenance(long id, long double start, double hours)
+{
+	RTTask* task { new MaintenanceTask(id, 1, Time(start), Time(start), 0.) };
+	task->SetMaxRunTime(hours);
+	return task;
+}
+
+// horizontal position of the sun in the convention of the planner, (Az,Alt) in deg with Az from north
+SphereCoords sunHorizontal(const SphereCoords& location, long double t)
+{
+	const SphereCoords site { DegToRad(location.Phi()), DegToRad(location.Theta()) };
+	const SphereCoords hor { EquToHor( SunPosition(Time(t)), Time(t), site ) };
+	return SphereCoords( fmod( RadToDeg(hor.Phi()) + 180., 360. ), RadToDeg(hor.Theta()) );
+}
+
+} // namespace
+
+TEST(SlewModelTest, SlewTimeOfShortAndLongMoves)
+{
+	const SlewModel model { };
+	EXPECT_DOUBLE_EQ(model.SlewTime( SphereCoords(10., 45.), SphereCoords(10., 45.) ), 0.);
+	// a short move does not reach the max. velocity: 2*sqrt(d/a) + settling
+	EXPECT_NEAR(model.SlewTime( SphereCoords(10., 45.), SphereCoords(11., 45.) ), 2. * sqrt(1. / 2.4) + 5., 1e-9);
+	// a long move runs at the max. velocity: d/v + v/a + settling
+	EXPECT_NEAR(model.SlewTime( SphereCoords(0., 45.), SphereCoords(90., 45.) ), 90. / 1.8 + 1.8 / 2.4 + 5., 1e-9);
+	// the azimuth takes the short way across north
+	EXPECT_NEAR(model.SlewTime( SphereCoords(359., 45.), SphereCoords(1., 45.) ), 2. / 1.8 + 1.8 / 2.4 + 5., 1e-9);
+	// the slower axis determines the slew time
+	EXPECT_NEAR(model.SlewTime( SphereCoords(0., 10.), SphereCoords(5., 70.) ), 60. / 1.8 + 1.8 / 2.4 + 5., 1e-9);
+}
+
+TEST(PlannerTest, RejectsTargetBelowMinElevation)
+{
+	Planner::Config config { };
+	config.sunAvoidance = 0.;
+	config.horizon = 2.;
+	Planner planner(config);
+	TaskStore store;
+	const long double now { wholeSecondsNow() };
+
+	ASSERT_TRUE(store.Add( makeGoto(1, 3, now + 600., 0.1, SphereCoords(0., 30.)) ));
+	planner.Insert(store, 1);
+	EXPECT_EQ(store.Find(1)->scheduleTime().timestamp(), now + 600.);
+	EXPECT_EQ(planner.NextDeadline(), HUGE_VALL);
+
+	// the target never rises above the min. elevation, so the task is deferred
+	ASSERT_TRUE(store.Add( makeGoto(2, 3, now + 7200., 0.1, SphereCoords(0., 2.)) ));
+	planner.Insert(store, 2);
+	EXPECT_GE(store.Find(2)->scheduleTime().timestamp(), now + config.horizon * 3600.);
+	EXPECT_LT(planner.NextDeadline(), HUGE_VALL);
+}
+
+TEST(PlannerTest, RejectsTargetInsideSunAvoidance)
+{
+	Planner::Config config { };
+	config.minElevation = -90.;
+	config.timeStep = 60.;
+	config.horizon = 8.;
+	const long double now { wholeSecondsNow() };
+	// the fixed target is passed by the sun three hours from now
+	const long double transit { now + 3. * 3600. };
+	const SphereCoords target { sunHorizontal(config.location, transit) };
+	// the window of the fixed task ends 5 minutes before the sun passes the target
+	const long double requested { transit - 3600. };
+
+	for ( double avoidance : { 0., 10. } ) {
+		config.sunAvoidance = avoidance;
+		Planner planner(config);
+		TaskStore store;
+		ASSERT_TRUE(store.Add( makeMaintenance(1, requested - 60., ( 3600. - 240. ) / 3600.) ));
+		planner.Insert(store, 1);
+		ASSERT_TRUE(store.Add( makeGoto(2, 3, requested, 60. / 3600., target) ));
+		planner.Insert(store, 2);
+		const long double start { store.Find(2)->scheduleTime().timestamp() };
+		if ( avoidance > 0. ) {
+			// the sun moves by at most 15 deg/h, so it stays within 10 deg of the target for at least +-40 min
+			EXPECT_GE(start, transit + 30. * 60.);
+		} else {
+			// without sun avoidance the task is packed directly behind the fixed task
+			EXPECT_LT(start, transit);
+		}
+	}
+}
+
+TEST(PlannerTest, WeightsDelayWithPriority)
+{
+	Planner::Config config { };
+	config.sunAvoidance = 0.;
+	const long double now { wholeSecondsNow() };
+	const long double requested { now + 600. };
+	const SphereCoords target { 0., 45. };
+
+	// the task either starts on time after a slew from the park position (~106 s, i.e. a penalty of ~1.8)
+	// or without a slew behind the fixed task on the same target, which ends 3 h after the requested time
+	for ( int priority : { 3, 5 } ) {
+		Planner planner(config);
+		TaskStore store;
+		ASSERT_TRUE(store.Add( makeGoto(1, 1, requested + 3600., 2., target) ));
+		planner.Insert(store, 1);
+		ASSERT_TRUE(store.Add( makeGoto(2, priority, requested, 0.1, target) ));
+		planner.Insert(store, 2);
+		const long double start { store.Find(2)->scheduleTime().timestamp() };
+		if ( priority == 3 ) EXPECT_EQ(start, requested);
+		else EXPECT_EQ(start, requested + 3. * 3600.);
+	}
+}
+
+TEST(PlannerTest, MovesAltPeriodTasksByWholePeriods)
+{
+	Planner::Config config { };
+	config.sunAvoidance = 0.;
+	Planner planner(config);
+	TaskStore store;
+	const long double now { wholeSecondsNow() };
+	const long double requested { now + 600. };
+
+	// the fixed task blocks the first two periods
+	ASSERT_TRUE(store.Add( makeMaintenance(1, requested - 60., 1.5) ));
+	planner.Insert(store, 1);
+	ASSERT_TRUE(store.Add( makeGoto(2, 3, requested, 0.1, SphereCoords(0., 45.), 1.) ));
+	planner.Insert(store, 2);
+	EXPECT_EQ(store.Find(2)->scheduleTime().timestamp(), requested + 2. * 3600.);
+	EXPECT_EQ(store.Find(2)->requestedTime().timestamp(), requested);
+}
+
+TEST(PlannerTest, PacksBehindOccupiedWindow)
+{
+	Planner::Config config { };
+	config.sunAvoidance = 0.;
+	Planner planner(config);
+	TaskStore store;
+	const long double now { wholeSecondsNow() };
+	const long double requested { now + 600. };
+	const SphereCoords fixed { 10., 45. };
+	const SphereCoords target { 0., 45. };
+
+	ASSERT_TRUE(store.Add( makeGoto(1, 1, requested - 60., 1., fixed) ));
+	planner.Insert(store, 1);
+	ASSERT_TRUE(store.Add( makeGoto(2, 3, requested, 0.1, target) ));
+	planner.Insert(store, 2);
+	// the task starts as soon as the slew from the fixed target is done
+	const long double end { requested - 60. + 3600. };
+	EXPECT_EQ(store.Find(2)->scheduleTime().timestamp(), ceil( end + config.slew.SlewTime(fixed, target) ));
+}
+
+TEST(PlannerTest, DefersTaskBeyondHorizon)
+{
+	Planner::Config config { };
+	config.sunAvoidance = 0.;
+	config.horizon = 1.;
+	Planner planner(config);
+	TaskStore store;
+	const long double now { wholeSecondsNow() };
+
+	// the fixed task occupies the whole planning horizon
+	ASSERT_TRUE(store.Add( makeMaintenance(1, now, 2.) ));
+	planner.Insert(store, 1);
+	ASSERT_TRUE(store.Add( makeGoto(2, 3, now + 60., 0.1, SphereCoords(0., 45.)) ));
+	planner.Insert(store, 2);
+	const RTTask* task { store.Find(2) };
+	// the task waits behind the horizon and is placed again after one time step
+	EXPECT_GE(task->scheduleTime().timestamp(), now + config.horizon * 3600.);
+	EXPECT_LE(task->scheduleTime().timestamp(), now + config.horizon * 3600. + 2.);
+	EXPECT_EQ(task->requestedTime().timestamp(), now + 60.);
+	EXPECT_GE(planner.NextDeadline(), now + config.timeStep);
+	EXPECT_LE(planner.NextDeadline(), now + config.timeStep + 2.);
+}
+
+TEST(PlannerTest, UpdateReflowsIntoFreedWindow)
+{
+	Planner::Config config { };
+	config.sunAvoidance = 0.;
+	Planner planner(config);
+	TaskStore store;
+	const long double now { wholeSecondsNow() };
+	const long double requested { now + 600. };
+	const SphereCoords target { 0., 45. };
+
+	ASSERT_TRUE(store.Add( makeMaintenance(1, requested - 60., 1.) ));
+	planner.Insert(store, 1);
+	ASSERT_TRUE(store.Add( makeGoto(2, 3, requested, 0.1, target) ));
+	planner.Insert(store, 2);
+	// a task requested behind the fixed window must not be moved by the update
+	ASSERT_TRUE(store.Add( makeGoto(3, 3, requested + 7200., 0.1, SphereCoords(90., 45.)) ));
+	planner.Insert(store, 3);
+	ASSERT_GT(store.Find(2)->scheduleTime().timestamp(), requested + 3000.);
+	EXPECT_EQ(store.Find(3)->scheduleTime().timestamp(), requested + 7200.);
+
+	// the removal of the fixed task frees its window and the task moves back to its requested time
+	ASSERT_TRUE(store.Delete(1));
+	planner.Update(store);
+	EXPECT_EQ(store.Find(2)->scheduleTime().timestamp(), requested);
+	EXPECT_EQ(store.Find(3)->scheduleTime().timestamp(), requested + 7200.);
+}
@@ -0,0 +1,94 @@
+#include <cmath>
+
+#include <syslog.h>
+#include <sys/wait.h>
+
+#include "preposition.h"
+
+using namespace std;
+using namespace hgz;
+
+constexpr double PREPOSITION_MARGIN { 10. }; //< time reserve in s between the expected end of the slew and the task start
+
+const RTTask* Prepositioner::NextTask(const TaskStore& store) const
+{
+	// the axes are busy as long as a task is active
+	if ( RTTask::isActiveTask() || fParked ) return nullptr;
+	const RTTask* task { store.NextPending() };
+	if ( task == nullptr ) return nullptr;
+	// a due task is started right away by the task store
+	if ( task->scheduleTime().timestamp() <= Time::Now().timestamp() ) return nullptr;
+	if ( task->ID() == fLastId ) return nullptr;
+	SphereCoords coords;
+	bool equatorial;
+	if ( !task->StartPosition(coords, equatorial) ) return nullptr;
+	return task;
+}
+
+long double Prepositioner::IssueTime(const RTTask& task) const
+{
+	const long double start { task.scheduleTime().timestamp() };
+	// worst case: half a turn in Az and a quarter turn in Alt
+	double slewTime { fModel.SlewTime( SphereCoords(0., 0.), SphereCoords(180., 90.) ) };
+	SphereCoords target;
+	if ( fPlanner != nullptr && fPointingKnown && fPlanner->Position(task, start, 0., target) ) {
+		slewTime = fModel.SlewTime(fPointing, target);
+	}
+	return start - slewTime - PREPOSITION_MARGIN;
+}
+
+long double Prepositioner::NextDeadline(const TaskStore& store) const
+{
+	const RTTask* task { NextTask(store) };
+	if ( task == nullptr ) return HUGE_VALL;
+	return IssueTime(*task);
+}
+
+void Prepositioner::Process(const TaskStore& store)
+{
+	for ( auto it = fGotoPids.begin(); it != fGotoPids.end(); ) {
+		int status { 0 };
+		const int pid { waitpid(*it, &status, WNOHANG) };
+		if ( pid == 0 ) {
+			++it;
+			continue;
+		}
+		if ( pid > 0 && ( !WIFEXITED(status) || WEXITSTATUS(status) != 0 ) ) {
+			syslog (LOG_WARNING, "pre-positioning goto command (pid %d) failed with status %d", *it, status);
+		}
+		it = fGotoPids.erase(it);
+	}
+
+	const long double now { Time::Now().timestamp() };
+	for ( const RTTask* task : store.Active() ) {
+		if ( task->ID() == fActiveId ) continue;
+		// keep track of the position the active task leaves the scope at
+		fActiveId = task->ID();
+		SphereCoords coords;
+		bool equatorial;
+		if ( task->type() == RTTask::PARK ) {
+			fParked = true;
+			fPointingKnown = ( fPlanner != nullptr );
+			if ( fPointingKnown ) fPointing = fPlanner->config().parkPosition;
+		} else if ( task->type() == RTTask::UNPARK ) {
+			fParked = false;
+		} else if ( task->StartPosition(coords, equatorial) ) {
+			fParked = false;
+			fPointingKnown = ( fPlanner != nullptr && fPlanner->Position(*task, now + task->Eta() * 3600., 1., fPointing) );
+		}
+	}
+
+	const RTTask* task { NextTask(store) };
+	if ( task == nullptr || now < IssueTime(*task) ) return;
+
+	SphereCoords coords;
+	bool equatorial;
+	task->StartPosition(coords, equatorial);
+	syslog (LOG_INFO, "pre-positioning scope for task id=%ld", task->ID());
+	const int pid { RTTask::SendGoto(coords, equatorial) };
+	if ( pid > 0 ) fGotoPids.push_back(pid);
+	else syslog (LOG_WARNING, "failed to pre-position scope for task id=%ld", task->ID());
+	// the goto is sent only once per task, the task macro takes over in case of failure
+	fLastId = task->ID();
+	fPointingKnown = ( fPlanner != nullptr && fPlanner->Position(*task, task->scheduleTime().timestamp(), 0., fPointing) );
+}
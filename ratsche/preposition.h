@@ -0,0 +1,54 @@
+#ifndef _PREPOSITION_H
+#define _PREPOSITION_H
+
+#include <vector>
+
+#include "rttask.h"
+#include "taskstore.h"
+#include "planner.h"
+
+/** @class Prepositioner
+slew-aware pre-positioning of the telescope.
+The task macros issue their own goto and wait for the scope to become idle before the measurement starts, so
+each task used to lose the full slew time at its start. The prepositioner sends the goto for the next pending task
+as soon as the axes are free, i.e. no task is active, and the slew is due: the goto is issued at the schedule
+time of the next task minus the estimated slew time and a safety margin, or immediately if this time has passed
+already. The macro then finds the scope at its start position and starts the measurement without delay.
+The slew time is estimated with the slew model from the last known pointing, which requires the observer location
+of the planner. Without the planner the worst case slew time is assumed.
+No goto is sent while the scope is parked by a park task.
+The goto command runs as child process, which is reaped in Process() after the server loop was woken by SIGCHLD.
+*/
+class Prepositioner
+{
+	public:
+		Prepositioner() = delete;
+		/*!
+		 \param model slew time model of the mount
+		 \param planner the observation planner for the conversion of target coordinates, may be nullptr
+		*/
+		Prepositioner(const SlewModel& model, const Planner* planner) : fModel(model), fPlanner(planner) {}
+
+		/*! reap terminated goto commands and send the goto for the next task if the axes are free and the slew is due
+		*/
+		void Process(const TaskStore& store);
+		/*! time at which the goto for the next task has to be sent
+		 \return time stamp in seconds since 01/01/1970, infinite if there is none
+		*/
+		[[nodiscard]] long double NextDeadline(const TaskStore& store) const;
+
+	private:
+		[[nodiscard]] const RTTask* NextTask(const TaskStore& store) const;
+		[[nodiscard]] long double IssueTime(const RTTask& task) const;
+
+		SlewModel fModel;
+		const Planner* fPlanner { nullptr };
+		long fLastId { -1 };			//< id of the task the scope was last pre-positioned for
+		long fActiveId { -1 };			//< id of the last seen active task
+		bool fParked { false };
+		bool fPointingKnown { false };
+		hgz::SphereCoords fPointing { };	//< estimated (Az,Alt) position of the scope in deg
+		std::vector<int> fGotoPids;		//< pids of the running goto commands
+};
+
+#endif // _PREPOSITION_H
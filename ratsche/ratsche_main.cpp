@@ -19,16 +19,21 @@
 #include <vector>
 #include <sstream>
 #include <algorithm>
+#include <memory>
 
 #include "ratsche_message.h"
 #include "rttask.h"
+#include "serverloop.h"
+#include "taskstore.h"
+#include "planner.h"
+#include "preposition.h"
+#include "journal.h"
 #include "time.h"
 
 using namespace std;
 using namespace hgz;
 
 constexpr int DEFAULT_MSQ_ID { 99 };
-constexpr unsigned long server_loop_delay_us { 20'000UL };
 constexpr size_t MAX_MSG_LEN { 4*8192UL };
 
 const string defaultTaskFile = "/var/ratsche/ratsche_tasks";
@@ -38,7 +43,7 @@ void Usage(const char* progname)
 	cout<<"RaTSche - The Radiotelescope Task Scheduler"<<endl;
 	cout<<"v1.2 - HG Zaunick 2010-2011,2021-25"<<endl;
 	cout<<endl;
-	cout<<" Usage : "<<string(progname)<<"  [-vlrEdph?] -k <keyID> -e|c|s <taskID> -a <taskfile> -x|o <path>"<<endl;
+	cout<<" Usage : "<<string(progname)<<"  [-vlrEdph?] -k <keyID> -e|c|s <taskID> -a <taskfile> -x|o <path> -L <lon,lat> -P <hours>"<<endl;
 	cout<<"  command line options are:   "<<endl;
 	cout<<"	 -l            list all tasks"<<endl;
 	cout<<"	 -r            reverse sort of data output (with -l)"<<endl;
@@ -53,6 +58,8 @@ void Usage(const char* progname)
 	cout<<"	 -d            run as daemon (scheduling server) and fork to background"<<endl;
 	cout<<"	 -x <path>     path to the executable macros"<<endl;
 	cout<<"	 -o <path>     path to data output"<<endl;
+	cout<<"	 -L <lon,lat>  observer location in deg, enables the observation planner (with -d)"<<endl;
+	cout<<"	 -P <hours>    planning horizon of the observation planner (default 24h)"<<endl;
 	cout<<"	 -v            increase verbosity level for stderr and syslog"<<endl;
 	cout<<"	 -h -?         show this help and exit"<<endl;
 	cout<<endl;
@@ -138,38 +145,6 @@ int receive_message(int msqid, int* fromID, int toID, int* action, int* subactio
 	return result;
 }
 
-bool save_tasks(const std::string& filename, const std::vector<task_t>& tasklist)
-{
-	uint32_t num_tasks = tasklist.size();
-	std::ofstream file( filename, ios_base::out | ios_base::trunc | ios::binary );
-	if ( file.fail() || !file.good() ) {
-		return false;
-	}
-	file.write( reinterpret_cast<char*>(&num_tasks), sizeof(uint32_t) );
-	for ( task_t task : tasklist ) {
-		file.write( reinterpret_cast<char*>(&task), sizeof(task_t) );
-	}
-	return true;
-}
-
-bool load_tasks(const std::string& filename, std::vector<task_t>& tasklist)
-{
-	tasklist.clear();
-	uint32_t num_tasks { 0 };
-	std::ifstream file( filename, ios_base::in | ios::binary );
-	if ( file.fail() || !file.good() ) {
-		return false;
-	}
-	file.read( reinterpret_cast<char*>(&num_tasks), sizeof(uint32_t) );
-	if ( !num_tasks ) return true;
-	for ( int i = 0; i < num_tasks; i++ ) {
-		task_t task { };
-		file.read( reinterpret_cast<char*>(&task), sizeof(task_t) );
-		tasklist.emplace_back( std::move(task) );
-	}
-	return true;
-}
-
 void export_tasks(std::ostream& ostr, const vector<task_t>& tasklist) {
 	ostr<<"# RT TASK"<<endl;
 	ostr<<"# v0.2"<<endl;
@@ -342,6 +317,7 @@ int parseStringForTask( const std::string& str, task_t& task ) {
 		}
 
 		task.submit_time=time(NULL);
+		task.requested_time=0;
 		task.status=0;
 		task.eta=-1.;
 		task.elapsed=0.;
@@ -422,6 +398,7 @@ task_t toMsgTask(RTTask* task)
 	msgtask.type=(int)task->type();
 	msgtask.start_time=task->scheduleTime().timestamp();
 	msgtask.submit_time=task->submitTime().timestamp();
+	msgtask.requested_time=task->requestedTime().timestamp();
 	msgtask.int_time=task->IntTime();
 	msgtask.ref_cycle=task->RefInterval();
 	msgtask.alt_period=task->AltPeriod();
@@ -543,6 +520,7 @@ RTTask* fromMsgTask(const task_t& msgtask)
 	}
 	task->SetMaxRunTime(msgtask.duration);
 	task->SetElapsedTime(msgtask.elapsed);
+	if (msgtask.requested_time>0) task->SetRequestedTime(Time((long double)msgtask.requested_time));
 	task->SetComment(msgtask.comment);
 	task->SetUser(msgtask.user);
 	task->SetState( (RTTask::TASKSTATE)msgtask.status );
@@ -551,40 +529,6 @@ RTTask* fromMsgTask(const task_t& msgtask)
 }
 
 
-// process tasklist
-void processTaskList(vector<RTTask*>& tasklist) {
-	// remove identical tasks
-	for (int first=0; first<(int)tasklist.size()-1; first++) {
-		for (int second=first+1; second<tasklist.size(); second++) {
-			// do we have the same type?
-			if (tasklist[first]->type()!=tasklist[second]->type()) continue;
-			// do the start times differ less than 30s?
-			if (fabs(tasklist[first]->scheduleTime().timestamp()-tasklist[second]->scheduleTime().timestamp())>30.) continue;
-			// do the int times differ by more than 1e-3?
-			if (fabs(tasklist[first]->IntTime()-tasklist[second]->IntTime())>1e-3) continue;
-			// do the ref intervals differ by more than 5?
-			if (abs(tasklist[first]->RefInterval()-tasklist[second]->RefInterval())>5) continue;
-			// when we reach here, the tasks are considered identical, so remove the second one
-			syslog (LOG_WARNING, "task id %d is identical to id %d. removing the latter", (int)tasklist[first]->ID(), (int)tasklist[second]->ID());
-			delete tasklist[second];
-			tasklist.erase(tasklist.begin()+second);
-		}
-	}
-	// sort tasklist for start-time in ascending order
-	for (int first=0; first<(int)tasklist.size()-1; first++) {
-		for (int second=first+1; second<tasklist.size(); second++) {
-			if (tasklist[first]->scheduleTime().timestamp()>tasklist[second]->scheduleTime().timestamp()) {
-				swap(tasklist[first], tasklist[second]);
-			}
-		}
-	}
-	// now process each task by calling the tasks' Process() method
-	for (vector<RTTask*>::iterator it=tasklist.begin(); it!=tasklist.end(); ++it) {
-		(*it)->Process();
-	}
-}
-
-
 void daemonize()
 {
         int i;
@@ -644,8 +588,10 @@ int main() {
     char buf[BUFSIZ];
     bool list_tasks { false };
     bool reverse_sort { false };
+	bool use_planner { false };
+	Planner::Config planner_config { };
 
-	while ((ch = getopt(argc, argv, "vlrpdEe:a:s:c:k:x:o:h?")) != EOF) {
+	while ((ch = getopt(argc, argv, "vlrpdEe:a:s:c:k:x:o:L:P:h?")) != EOF) {
 		switch ((char)ch) {
 			case 'v':
 				// increase verbosity level
@@ -700,6 +646,34 @@ int main() {
 			case 'o':
 				datapath=optarg;
 				break;
+			case 'L': {
+				// longitude east and latitude in deg, separated by a comma
+				char* end { nullptr };
+				const double lon { strtod(optarg, &end) };
+				const bool separated { end != optarg && *end == ',' };
+				const char* latstr { separated ? end + 1 : end };
+				const double lat { strtod(latstr, &end) };
+				if (!separated || end == latstr || *end != '\0'
+					|| !(lon >= -180. && lon <= 360.) || !(lat >= -90. && lat <= 90.)) {
+					cerr<<"invalid observer location: "<<optarg<<endl;
+					Usage(argv[0]);
+					return 1;
+				}
+				planner_config.location = SphereCoords(lon, lat);
+				use_planner = true;
+				break;
+			}
+			case 'P': {
+				char* end { nullptr };
+				const double horizon { strtod(optarg, &end) };
+				if (end == optarg || *end != '\0' || !std::isfinite(horizon) || horizon <= 0.) {
+					cerr<<"invalid planning horizon: "<<optarg<<endl;
+					Usage(argv[0]);
+					return 1;
+				}
+				planner_config.horizon = horizon;
+				break;
+			}
 			case 'h':
 			case '?':  Usage(argv[0]); return 0;
 			default: break;
@@ -779,7 +753,7 @@ int main() {
 		//daemon(NULL, NULL);
 		daemon(0, 0);
 		//daemonize();
-		vector<RTTask*> tasklist;
+		TaskStore tasklist;
 		try
 		{
 			int facility_priority = LOG_NOTICE; // default log priority is LOG_NOTICE
@@ -807,29 +781,77 @@ int main() {
 			if (nrOldMsg) syslog (LOG_WARNING, "found %d zombie message(s) in queue...deleting",nrOldMsg);
 
 			// try to load tasklist from previous session
+			TaskJournal journal(defaultTaskFile);
 			{
 				// add task(s)
 				vector<task_t> msgTaskVector;
 //				if (importTasklistFromFile(defaultTaskFile, msgTaskVector)!=0) {
-				if ( !load_tasks(defaultTaskFile, msgTaskVector) ) {
+				if ( !journal.Load(msgTaskVector) ) {
 					error(argv[0], "reading task file");
 				} else {
 					// submit tasklist
 					// loop over tasks
 					syslog (LOG_NOTICE, "loading tasklist from previous session, adding %d tasks", msgTaskVector.size());
 					for ( task_t task : msgTaskVector ) {
-						task.id=++lastTaskID;
+						// the tasks keep their IDs, so the journal records of an interrupted compaction still refer to the right tasks
+						lastTaskID=std::max(lastTaskID, task.id);
 						syslog (LOG_INFO, "received ADD request, adding new task (id=%d) to list", task.id);
 						RTTask* taskptr { fromMsgTask( task ) };
-						if ( taskptr != nullptr ) tasklist.push_back( taskptr );
+						if ( taskptr != nullptr ) tasklist.Add( taskptr );
 					}
 				}
 			}
+			// the planner assigns the start times of the flexible tasks
+			std::unique_ptr<Planner> planner { nullptr };
+			if (use_planner && planner_config.horizon > 0.) {
+				planner = std::make_unique<Planner>(planner_config);
+				syslog (LOG_NOTICE, "observation planner enabled: location lon=%f lat=%f, horizon %fh", planner_config.location.Phi(), planner_config.location.Theta(), planner_config.horizon);
+				planner->Replan(tasklist, Time::Now().timestamp());
+			}
+			// the scope is moved to the start position of the next task as soon as the axes are free
+			Prepositioner prepositioner(planner ? planner->config().slew : SlewModel { }, planner.get());
+			// write the complete tasklist to file and truncate the journal
+			auto backupTasks = [&tasklist, &journal]() {
+				vector<task_t> msgTaskList;
+				for (auto task : tasklist.Tasks()) {
+					msgTaskList.push_back( toMsgTask(task) );
+				}
+				journal.Compact( msgTaskList );
+			};
+			// run the tasks, a terminated task frees its time slot for the planned tasks
+			auto processTasks = [&tasklist, &planner]() {
+				const bool terminated { tasklist.Process() > 0 };
+				if (planner && (terminated || planner->NextDeadline() <= Time::Now().timestamp())) planner->Update(tasklist);
+			};
+			// start the journal with a fresh snapshot of the loaded tasks
+			(void)tasklist.TakeChanged();
+			backupTasks();
+			// the server sleeps until a message arrives, a task macro terminates or the next task is due
+			ServerLoop serverLoop(msqid, 1);
+			if (!serverLoop.isValid()) {
+				syslog (LOG_WARNING, "event-driven server loop not available, falling back to polling");
+			}
 			// stay in endless loop
 			while (true) {
+				// process all tasks
+				processTasks();
+				prepositioner.Process(tasklist);
+				// record the state changes of the tasks in the journal
+				for (long id : tasklist.TakeChanged()) {
+					RTTask* taskptr { tasklist.Find(id) };
+					if (taskptr != nullptr) journal.Update( toMsgTask(taskptr) );
+				}
+				if (journal.isCompactionDue()) backupTasks();
+				long double deadline { std::min(tasklist.NextDeadline(), prepositioner.NextDeadline(tasklist)) };
+				if (planner) deadline = std::min(deadline, planner->NextDeadline());
+				serverLoop.Wait(deadline);
 				// see if there is a message in the queue
-				task_t task { };
-				if (receive_message(msqid, &fromid, 1, &action, &subaction, &task) >= 0) {
+				message_t msg { };
+				while (serverLoop.NextMessage(msg)) {
+					fromid = msg.msenderID;
+					action = msg.maction;
+					subaction = msg.msubaction;
+					task_t task { msg.mtask };
 					RTTask* taskptr { nullptr };
 					switch (action) {
 						case AC_PING:
@@ -844,101 +866,78 @@ int main() {
 							}
 							break;
 						case AC_LIST:
+							// refresh the elapsed time and eta of the running tasks, they are only updated when the tasks are processed
+							processTasks();
 							// List all tasks
 							//syslog (LOG_DEBUG, "received LIST request, sending back list of %d task(s)", tasklist.size());
-							if (!tasklist.size()) {
+							if (tasklist.empty()) {
 								// send empty list
 								if (send_message(msqid, 1, fromid, AC_LIST, subaction, NULL, 1, 0) < 0) {
 									syslog (LOG_CRIT, "unable to send message to message queue");
 									perror("send_message");
 								}
-							} else
-                            for (size_t i=0; i<tasklist.size(); i++) {
-								const size_t curr_task { (subaction==0)?i:tasklist.size()-i-1 };
-                                task_t _task=toMsgTask(tasklist[curr_task]);
-								if (send_message(msqid, 1, fromid, AC_LIST, subaction, &_task, i+1, tasklist.size()) < 0) {
-									syslog (LOG_CRIT, "unable to send message to message queue");
-									perror("send_message");
+							} else {
+								const vector<RTTask*> tasks { tasklist.Tasks() };
+								for (size_t i=0; i<tasks.size(); i++) {
+									const size_t curr_task { (subaction==0)?i:tasks.size()-i-1 };
+									task_t _task=toMsgTask(tasks[curr_task]);
+									if (send_message(msqid, 1, fromid, AC_LIST, subaction, &_task, i+1, tasks.size()) < 0) {
+										syslog (LOG_CRIT, "unable to send message to message queue");
+										perror("send_message");
+									}
 								}
 							}
-
 							break;
 						case AC_ADD:
 							// add task
 							task.id=++lastTaskID;
+							// the submitted start time is kept as the earliest start time for the planner
+							task.requested_time=task.start_time;
 							syslog (LOG_DEBUG, "received ADD request, adding new task (id=%d) to list", task.id);
 							taskptr=fromMsgTask(task);
-							if (taskptr!=NULL) tasklist.push_back(taskptr);
+							if (taskptr!=NULL && tasklist.Add(taskptr)) {
+								journal.Add( toMsgTask(taskptr) );
+								if (planner) planner->Insert(tasklist, task.id);
+							}
 							break;
 						case AC_DELETE:
 							// delete task
 							syslog (LOG_DEBUG, "received DELETE request, deleting task (id=%d) from list", subaction);
-							for (vector<RTTask*>::iterator it=tasklist.begin(); it!=tasklist.end(); ++it) {
-								if ( (*it != NULL) && ((*it)->ID() == subaction) ) {
-									if ( (*it)->State() == RTTask::ACTIVE ) {
-										(*it)->Cancel();
-									}
-									delete *it;
-									tasklist.erase(it);
-									syslog (LOG_DEBUG," deleted task id=%d, new size=%d", subaction, tasklist.size());
-									break;
-								}
+							if (tasklist.Delete(subaction)) {
+								syslog (LOG_DEBUG," deleted task id=%d, new size=%d", subaction, tasklist.size());
+								journal.Delete(subaction);
+								if (planner) planner->Update(tasklist);
 							}
 							//syslog (LOG_WARNING, "trying to delete task id=%d, which does not exist", subaction);
 							break;
 						case AC_STOP:
 							// stop task
 							syslog (LOG_DEBUG, "received STOP request, stopping task (id=%d)", subaction);
-							for (vector<RTTask*>::iterator it=tasklist.begin(); it!=tasklist.end(); ++it) {
-								if ( (*it != NULL) && ((*it)->ID() == subaction) ) {
-									(*it)->Stop();
-									syslog (LOG_DEBUG," stopped task id=%d", subaction);
-									break;
-								}
+							if (tasklist.Stop(subaction)) {
+								syslog (LOG_DEBUG," stopped task id=%d", subaction);
+								if (planner) planner->Update(tasklist);
 							}
 							break;
 						case AC_CANCEL:
 							// cancel task
 							syslog (LOG_DEBUG, "received CANCEL request, cancelling task (id=%d)", subaction);
-							for (vector<RTTask*>::iterator it=tasklist.begin(); it!=tasklist.end(); ++it) {
-								if ( (*it != NULL) && ((*it)->ID() == subaction) ) {
-									(*it)->Cancel();
-									syslog (LOG_DEBUG," cancelled task id=%d", subaction);
-									break;
-								}
+							if (tasklist.Cancel(subaction)) {
+								syslog (LOG_DEBUG," cancelled task id=%d", subaction);
+								if (planner) planner->Update(tasklist);
 							}
 							break;
 						case AC_CLEAR:
 							// delete all tasks
 							syslog (LOG_INFO, "received CLEAR request, deleting all tasks");
-							while ( !tasklist.empty() ) {
-								auto it = tasklist.begin();
-								long int id = (*it)->ID();
-								if ( (*it)->State() == RTTask::ACTIVE ) {
-									(*it)->Cancel();
-								}
-								delete *it;
-								tasklist.erase(it);
-								syslog (LOG_DEBUG," deleted task id=%d, new size=%d", id, tasklist.size());
-							}
+							syslog (LOG_DEBUG," deleting %d task(s)", (int)tasklist.size());
+							tasklist.Clear();
+							journal.Clear();
+							if (planner) planner->Update(tasklist);
 							break;
 						default: break;
 					}
 					// process all tasks
-					processTaskList(tasklist);
-					// the tasklist has been modified, so back it up to file
-					vector<task_t> msgTaskList;
-					for (auto task : tasklist) {
-						msgTaskList.push_back( toMsgTask(task) );
-					}
-					//ofstream ostr(defaultTaskFile.c_str());
-					//export_tasks(ostr, _tasklist);
-					save_tasks( defaultTaskFile, msgTaskList );
-				} else {
-					// process all tasks
-					processTaskList(tasklist);
-					// sleep for 10ms
-					usleep( server_loop_delay_us );
+					processTasks();
 				}
 			}
 		} // if (server)
@@ -948,10 +947,7 @@ int main() {
 			syslog (LOG_CRIT, "caught unhandled exception");
 			syslog (LOG_CRIT, "stopping server.");
 			// unqueue task list
-			while (tasklist.size()) {
-				if (tasklist[0]!=NULL) delete tasklist[0];
-				tasklist.erase(tasklist.begin());
-			}
+			tasklist.Clear();
 			exit(3);
 		}
 		// Todo: evaluate system signals (SIGTERM, SIGKILL etc.)
@@ -969,6 +965,7 @@ int main() {
 	task.priority=5;
 	task.start_time=time(NULL);
 	task.submit_time=time(NULL);
+	task.requested_time=0;
 	task.type=1;
 	(void) strcpy(task.user, "ratsche");
 	(void) strcpy(task.comment, "dummy task");
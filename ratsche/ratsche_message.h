@@ -22,7 +22,8 @@ typedef struct task_struct {
 		 alt_period(task.alt_period), coords1(task.coords1), coords2(task.coords2),
 		 step1(task.step1), step2(task.step2),
 		 int_time(task.int_time), ref_cycle(task.ref_cycle),
-		 duration(task.duration), elapsed(task.elapsed), eta(task.eta), status(task.status)
+		 duration(task.duration), elapsed(task.elapsed), eta(task.eta), status(task.status),
+		 requested_time(task.requested_time)
 	{
 		(void) strcpy(user, task.user);
 		(void) strcpy(comment, task.comment);
@@ -46,6 +47,7 @@ typedef struct task_struct {
 	double			eta;
 	int				status;
 	char				comment[256];
+	time_t			requested_time;	// earliest start time as submitted, the planner may move start_time behind it (0 = start_time)
 } task_t;
 
 
@@ -150,6 +150,40 @@ double RTTask::Eta() const
 	return fMaxRunTime-fElapsedTime;
 }
 
+long double RTTask::NextDeadline() const
+{
+	const long double now { Time::Now().timestamp() };
+	const long double windowEnd { fScheduleTime.timestamp() + fMaxRunTime * 3600. };
+	switch ( fState ) {
+		case ACTIVE:
+			// the maximum run time is exceeded
+			return fStartTime.timestamp() + fMaxRunTime * 3600.;
+		case IDLE:
+		case WAITING:
+			// the task is due
+			if ( fScheduleTime.timestamp() > now ) return fScheduleTime.timestamp();
+			// a due task waits for the active one to finish, unless its time window ends before
+			if ( fabs(fAltPeriod) > 1e-4 ) return windowEnd;
+			return HUGE_VALL;
+		default:
+			return HUGE_VALL;
+	}
+}
+
+int RTTask::SendGoto(const SphereCoords& coords, bool equatorial)
+{
+	char cmdstr[256];
+	if (equatorial) {
+		sprintf(cmdstr,"indi_setprop %s \"%s.RA;DEC=%f;%f\" >/dev/null", INDI_PORT.c_str(), INDI_PROP_EQU_COORD.c_str(), coords.Phi(), coords.Theta());
+	} else {
+		sprintf(cmdstr,"indi_setprop %s \"%s.AZ;ALT=%f;%f\" >/dev/null", INDI_PORT.c_str(), INDI_PROP_HOR_COORD.c_str(), coords.Phi(), coords.Theta());
+	}
+	// the command is forked off like the task macros, so a slow indi server does not block the scheduler
+	syslog (LOG_DEBUG, "executing command: %s", cmdstr);
+	const int pid = RunShellCommand(cmdstr);
+	return (pid > 0) ? pid : -1;
+}
+
 void RTTask::Print() const
 {
    std::cout<<"RT Task:\n";
@@ -184,7 +218,12 @@ void RTTask::Process()
 	if (fState==ACTIVE) {
 		// Wait till the commands complete
 		int iChildiStatus = 0;
-		int iDeadId = waitpid(-1, &iChildiStatus, WNOHANG);
+		// only the own child processes, other children of the server (e.g. pre-positioning gotos) are reaped elsewhere
+		int iDeadId = (fPIDList.empty()) ? -1 : 0;
+		for (int pid : fPIDList) {
+			iDeadId = waitpid(pid, &iChildiStatus, WNOHANG);
+			if (iDeadId != 0) break;
+		}
 		if (iDeadId < 0)
 		{
 			// Wait id error
@@ -47,7 +47,7 @@ class RTTask
 
 		RTTask() = delete;
 		RTTask(long id, int priority, const hgz::Time& scheduleTime, double intTime, int refInterval, double altPeriod)
-		 : fId(id), fPriority(priority), fScheduleTime(scheduleTime), fSubmitTime(hgz::Time::Now()), fIntTime(intTime), fRefInterval(refInterval), fAltPeriod(altPeriod)
+		 : fId(id), fPriority(priority), fScheduleTime(scheduleTime), fRequestedTime(scheduleTime), fSubmitTime(hgz::Time::Now()), fIntTime(intTime), fRefInterval(refInterval), fAltPeriod(altPeriod)
 		{
 			fNumTasks++;
 			fUser="N/A";
@@ -56,7 +56,7 @@ class RTTask
 		}
 		RTTask(long id, int priority, const hgz::Time& scheduleTime, const hgz::Time& submitTime,
       		 double intTime, int refInterval, double altPeriod)
-		 : fId(id), fPriority(priority), fScheduleTime(scheduleTime), fSubmitTime(submitTime),
+		 : fId(id), fPriority(priority), fScheduleTime(scheduleTime), fRequestedTime(scheduleTime), fSubmitTime(submitTime),
       	  fIntTime(intTime), fRefInterval(refInterval), fAltPeriod(altPeriod)
 		{
 			fNumTasks++;
@@ -66,10 +66,15 @@ class RTTask
 		}
 		virtual ~RTTask();
 
-		inline long ID() { return fId; }
+		inline long ID() const { return fId; }
 		inline void SetID(long a_id) { fId=a_id; }
-		inline long Priority() { return fPriority; }
+		inline long Priority() const { return fPriority; }
 		hgz::Time scheduleTime() const { return fScheduleTime; }
+		inline void SetScheduleTime(const hgz::Time& a_time) { fScheduleTime=a_time; }
+		/*! earliest start time as submitted, the planner moves the schedule time of flexible tasks behind it
+		*/
+		hgz::Time requestedTime() const { return fRequestedTime; }
+		inline void SetRequestedTime(const hgz::Time& a_time) { fRequestedTime=a_time; }
 		hgz::Time submitTime() const { return fSubmitTime; }
 		std::string User() const { return fUser; }
 		inline void SetUser(const std::string& a_user) { fUser=a_user; }
@@ -91,6 +96,9 @@ class RTTask
 		[[nodiscard]] inline auto State() const -> TASKSTATE { return fState; }
 		inline void SetState( TASKSTATE state ) { fState = state; }
 		double Eta() const;
+		/*! time stamp of the next moment at which Process() changes the state of the task by itself,
+		 i.e. apart from commands or the termination of the child process (infinite if there is none) */
+		long double NextDeadline() const;
 		double ElapsedTime() const { return fElapsedTime; }
 		void SetElapsedTime(double elapsed) { fElapsedTime=elapsed; }
 		double MaxRunTime() const { return fMaxRunTime; }
@@ -98,6 +106,19 @@ class RTTask
 		static int NumTasks() { return fNumTasks; }
 		static bool isActiveTask() { return fAnyActive; }
 
+		/*! coordinates the telescope has to point to at the start of the task
+		 \param coords returns (Az,Alt) in (deg,deg) or (RA,Dec) in (hours,deg)
+		 \param equatorial returns true for equatorial coordinates
+		 \return false if the task does not point the telescope
+		*/
+		virtual bool StartPosition(hgz::SphereCoords& coords, bool& equatorial) const { return false; }
+		/*! send a goto command to the telescope without waiting for the command or the slew to complete
+		 \param coords (Az,Alt) in (deg,deg) or (RA,Dec) in (hours,deg)
+		 \param equatorial interpret coords as equatorial coordinates
+		 \return pid of the command process, which has to be reaped by the caller, or -1 on failure
+		*/
+		static int SendGoto(const hgz::SphereCoords& coords, bool equatorial);
+
 		static void SetDataPath(const std::string& path) { fDataPath=path; }
 		static const std::string& DataPath() { return fDataPath; }
 		static void SetExecutablePath(const std::string& path) { fExecutablePath=path; }
@@ -114,6 +135,7 @@ class RTTask
 		long fId;
 		int fPriority;
 		hgz::Time fScheduleTime;
+		hgz::Time fRequestedTime;
 		hgz::Time fSubmitTime;
 		hgz::Time fStartTime;
 		double fIntTime;
@@ -134,7 +156,7 @@ class RTTask
 		std::vector<int> fPIDList;
 		int fVerbose { 4 };
 
-		int RunShellCommand(const char *strCommand);
+		static int RunShellCommand(const char *strCommand);
 		virtual auto WriteHeader( const std::string& datafile ) -> bool;
 };
 
@@ -155,6 +177,7 @@ class DriftScanTask : public RTTask
 		virtual ~DriftScanTask() {}
 
 		hgz::SphereCoords StartCoords() const { return fStartCoords; }
+		bool StartPosition(hgz::SphereCoords& coords, bool& equatorial) const override { coords=fStartCoords; equatorial=false; return true; }
 
 		virtual int Start();
 		virtual int Stop();
@@ -185,6 +208,7 @@ class TrackingTask : public RTTask
 		virtual ~TrackingTask() {}
 
 		hgz::SphereCoords TrackCoords() const { return fTrackCoords; }
+		bool StartPosition(hgz::SphereCoords& coords, bool& equatorial) const override { coords=fTrackCoords; equatorial=true; return true; }
 
 		virtual int Start();
 		virtual int Stop();
@@ -218,6 +242,7 @@ class HorScanTask : public RTTask
 		hgz::SphereCoords EndCoords() const { return fEndCoords; }
 		double StepAz() const { return fStepAz; }
 		double StepAlt() const { return fStepAlt; }
+		bool StartPosition(hgz::SphereCoords& coords, bool& equatorial) const override { coords=fStartCoords; equatorial=false; return true; }
 
 		virtual int Start();
 		virtual int Stop();
@@ -254,6 +279,7 @@ class EquScanTask : public RTTask
 		hgz::SphereCoords EndCoords() const { return fEndCoords; }
 		double StepRa() const { return fStepRa; }
 		double StepDec() const { return fStepDec; }
+		bool StartPosition(hgz::SphereCoords& coords, bool& equatorial) const override { coords=fStartCoords; equatorial=true; return true; }
 
 		virtual int Start();
 		virtual int Stop();
@@ -285,6 +311,7 @@ class GotoHorTask : public RTTask
 		virtual ~GotoHorTask() {}
 
 		hgz::SphereCoords GotoCoords() const { return fGotoCoords; }
+		bool StartPosition(hgz::SphereCoords& coords, bool& equatorial) const override { coords=fGotoCoords; equatorial=false; return true; }
 
 		virtual int Start();
 		virtual int Stop();
@@ -312,6 +339,7 @@ class GotoEquTask : public RTTask
 		virtual ~GotoEquTask() {}
 
 		hgz::SphereCoords GotoCoords() const { return fGotoCoords; }
+		bool StartPosition(hgz::SphereCoords& coords, bool& equatorial) const override { coords=fGotoCoords; equatorial=true; return true; }
 
 		virtual int Start();
 		virtual int Stop();
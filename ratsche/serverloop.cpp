@@ -0,0 +1,166 @@
+#include <cmath>
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ipc.h>
+#include <sys/msg.h>
+#include <sys/timerfd.h>
+
+#include "serverloop.h"
+
+constexpr int WAKEUP_SIGNAL { SIGUSR2 }; //< interrupts the receiver thread, if the queue has no room for the wake-up message
+
+int ServerLoop::fChildFd = -1;
+
+ServerLoop::ServerLoop(int msqid, long msgType)
+	: fMsqId(msqid), fMsgType(msgType)
+{
+	fTimerFd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+	fMessageFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	fChildFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	int epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if ( fTimerFd < 0 || fMessageFd < 0 || fChildFd < 0 || epollFd < 0 ) {
+		syslog (LOG_CRIT, "failed to create event descriptors: %s", strerror(errno));
+		if ( epollFd >= 0 ) close(epollFd);
+		return;
+	}
+	for ( int fd : { fTimerFd, fMessageFd, fChildFd } ) {
+		struct epoll_event ev { };
+		ev.events = EPOLLIN;
+		ev.data.fd = fd;
+		if ( epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0 ) {
+			syslog (LOG_CRIT, "failed to register event descriptor: %s", strerror(errno));
+			close(epollFd);
+			return;
+		}
+	}
+	fEpollFd = epollFd;
+
+	// the handler only signals the termination, the child is reaped in RTTask::Process()
+	struct sigaction sa { };
+	sa.sa_handler = &ServerLoop::ChildHandler;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+	sigaction(SIGCHLD, &sa, NULL);
+	// without SA_RESTART, so the signal interrupts the msgrcv() of the receiver thread
+	struct sigaction wakeup { };
+	wakeup.sa_handler = &ServerLoop::WakeUpHandler;
+	sigemptyset(&wakeup.sa_mask);
+	sigaction(WAKEUP_SIGNAL, &wakeup, NULL);
+
+	fActive = true;
+	fThread = std::thread( [this]() { this->ReceiveLoop(); } );
+}
+
+ServerLoop::~ServerLoop()
+{
+	if ( fThread.joinable() ) {
+		fActive = false;
+		// wake up the receiver thread with an empty message to itself
+		message_t msg { };
+		msg.mtype = fMsgType;
+		msg.maction = AC_NONE;
+		if ( msgsnd(fMsqId, &msg, sizeof(message_t) - sizeof(long), IPC_NOWAIT) < 0 ) {
+			syslog (LOG_WARNING, "unable to wake up the receiver thread with a message: %s", strerror(errno));
+			// interrupt msgrcv() with a signal, repeatedly since the thread may just be entering the call
+			while ( !fStopped ) {
+				pthread_kill(fThread.native_handle(), WAKEUP_SIGNAL);
+				usleep(10000);
+			}
+		}
+		fThread.join();
+	}
+	signal(SIGCHLD, SIG_DFL);
+	signal(WAKEUP_SIGNAL, SIG_DFL);
+	for ( int fd : { fEpollFd, fTimerFd, fMessageFd, fChildFd } ) {
+		if ( fd >= 0 ) close(fd);
+	}
+	fChildFd = -1;
+}
+
+void ServerLoop::ChildHandler(int)
+{
+	const int saved_errno = errno;
+	const uint64_t one { 1 };
+	if ( fChildFd >= 0 ) (void) !write(fChildFd, &one, sizeof(one));
+	errno = saved_errno;
+}
+
+void ServerLoop::WakeUpHandler(int)
+{
+}
+
+// this is the receiver thread loop
+void ServerLoop::ReceiveLoop()
+{
+	// signals are handled by the main thread only, apart from the wake-up signal
+	sigset_t mask;
+	sigfillset(&mask);
+	sigdelset(&mask, WAKEUP_SIGNAL);
+	pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+	while ( fActive ) {
+		message_t msg { };
+		// the clients send the full struct size as payload, so allow for truncation of the excess bytes
+		if ( msgrcv(fMsqId, &msg, sizeof(message_t) - sizeof(long), fMsgType, MSG_NOERROR) < 0 ) {
+			if ( errno == EINTR ) continue;
+			syslog (LOG_CRIT, "error in msgrcv: unable to access message queue");
+			// wait 100ms and hope that access to the queue will work in a new iteration
+			usleep(100000);
+			continue;
+		}
+		if ( !fActive ) break;
+		{
+			std::lock_guard<std::mutex> lock(fMutex);
+			fMessages.push_back(msg);
+		}
+		const uint64_t one { 1 };
+		(void) !write(fMessageFd, &one, sizeof(one));
+	}
+	fStopped = true;
+}
+
+void ServerLoop::Wait(long double deadline)
+{
+	if ( !isValid() ) {
+		// no event descriptors, fall back to a short sleep
+		usleep(20000);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(fMutex);
+		if ( !fMessages.empty() ) return;
+	}
+	struct itimerspec spec { };
+	if ( std::isfinite(deadline) ) {
+		// a deadline in the past expires immediately, a zero time would disarm the timer though
+		const long double t { std::max(deadline, 1e-9L) };
+		spec.it_value.tv_sec = static_cast<time_t>(t);
+		spec.it_value.tv_nsec = static_cast<long>( (t - spec.it_value.tv_sec) * 1e9L );
+		if ( spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0 ) spec.it_value.tv_nsec = 1;
+	}
+	timerfd_settime(fTimerFd, TFD_TIMER_ABSTIME, &spec, NULL);
+
+	struct epoll_event events[3];
+	const int n = epoll_wait(fEpollFd, events, 3, -1);
+	// EINTR (e.g. a SIGCHLD caught by this thread) is just another wake-up
+	for ( int i = 0; i < n; i++ ) {
+		uint64_t count;
+		(void) !read(events[i].data.fd, &count, sizeof(count));
+	}
+}
+
+bool ServerLoop::NextMessage(message_t& msg)
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	if ( fMessages.empty() ) return false;
+	msg = fMessages.front();
+	fMessages.pop_front();
+	return true;
+}
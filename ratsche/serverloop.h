@@ -0,0 +1,65 @@
+#ifndef _SERVERLOOP_H
+#define _SERVERLOOP_H
+
+#include <string.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "ratsche_message.h"
+
+/** @class ServerLoop
+event-driven core of the scheduling server.
+The server sleeps until one of the following events occurs:
+ - a message addressed to the server arrives in the message queue
+ - a child process (i.e. the macro of an active task) terminates
+ - the deadline given to Wait() is due, e.g. the schedule time of the next task
+Since SysV message queues can not be polled, a receiver thread blocks in msgrcv() and hands the
+messages over to the main thread through an eventfd. Child terminations are signalled through a second
+eventfd written by the SIGCHLD handler and the deadline is armed as absolute CLOCK_REALTIME timerfd,
+so it follows adjustments of the system clock. All three descriptors are waited for with epoll.
+On shutdown the receiver thread is woken by a message to itself, or by SIGUSR2 if the queue is full.
+*/
+class ServerLoop
+{
+	public:
+		ServerLoop() = delete;
+		/*! set up the event descriptors and start the receiver thread
+		 \param msqid id of the message queue
+		 \param msgType message type addressed to the server
+		*/
+		ServerLoop(int msqid, long msgType);
+		~ServerLoop();
+
+		[[nodiscard]] bool isValid() const { return fEpollFd >= 0; }
+		/*! block until a message is pending, a child process terminated or the deadline is due
+		 \param deadline time stamp in seconds since 01/01/1970, an infinite value waits without timeout
+		*/
+		void Wait(long double deadline);
+		/*! fetch the next received message
+		 \return false if no message is pending
+		*/
+		bool NextMessage(message_t& msg);
+
+	private:
+		void ReceiveLoop();
+		static void ChildHandler(int);
+		static void WakeUpHandler(int);
+
+		int fMsqId;
+		long fMsgType;
+		int fEpollFd { -1 };
+		int fTimerFd { -1 };
+		int fMessageFd { -1 };
+		static int fChildFd;
+
+		std::deque<message_t> fMessages;
+		std::mutex fMutex;
+		std::atomic<bool> fActive { false };
+		std::atomic<bool> fStopped { false };	//< the receiver thread left its loop
+		std::thread fThread;
+};
+
+#endif // _SERVERLOOP_H
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cmath>
+
+#include <syslog.h>
+
+#include "taskstore.h"
+
+using namespace std;
+using namespace hgz;
+
+constexpr long double DUPLICATE_TIME_WINDOW { 30. }; //< tasks with start times closer than this (in s) may be identical
+
+TaskStore::~TaskStore()
+{
+	Clear();
+}
+
+void TaskStore::File(Entry& entry)
+{
+	RTTask* task { entry.task.get() };
+	switch ( task->State() ) {
+		case RTTask::IDLE:
+		case RTTask::WAITING:
+			entry.slot = Slot::PENDING;
+			entry.it = fPending.emplace(task->scheduleTime().timestamp(), task);
+			break;
+		case RTTask::ACTIVE:
+			entry.slot = Slot::ACTIVE;
+			fActive.push_back(task);
+			break;
+		default:
+			entry.slot = Slot::DONE;
+			entry.it = fDone.emplace(task->scheduleTime().timestamp(), task);
+			break;
+	}
+}
+
+void TaskStore::Unfile(Entry& entry)
+{
+	switch ( entry.slot ) {
+		case Slot::PENDING:
+			fPending.erase(entry.it);
+			break;
+		case Slot::ACTIVE:
+			fActive.erase(std::remove(fActive.begin(), fActive.end(), entry.task.get()), fActive.end());
+			break;
+		case Slot::DONE:
+			fDone.erase(entry.it);
+			break;
+		default:
+			break;
+	}
+	entry.slot = Slot::NONE;
+}
+
+RTTask* TaskStore::FindDuplicate(const RTTask& task) const
+{
+	const long double t { task.scheduleTime().timestamp() };
+	for ( const TimeIndex* index : { &fPending, &fDone } ) {
+		for ( auto it = index->lower_bound(t - DUPLICATE_TIME_WINDOW); it != index->end() && it->first <= t + DUPLICATE_TIME_WINDOW; ++it ) {
+			const RTTask* other { it->second };
+			// do we have the same type?
+			if ( other->type() != task.type() ) continue;
+			// do the int times differ by more than 1e-3?
+			if ( fabs(other->IntTime() - task.IntTime()) > 1e-3 ) continue;
+			// do the ref intervals differ by more than 5?
+			if ( abs(other->RefInterval() - task.RefInterval()) > 5 ) continue;
+			return it->second;
+		}
+	}
+	for ( RTTask* other : fActive ) {
+		if ( other->type() == task.type()
+			&& fabs(other->scheduleTime().timestamp() - t) <= DUPLICATE_TIME_WINDOW
+			&& fabs(other->IntTime() - task.IntTime()) <= 1e-3
+			&& abs(other->RefInterval() - task.RefInterval()) <= 5 ) {
+			return other;
+		}
+	}
+	return nullptr;
+}
+
+bool TaskStore::Add(RTTask* task)
+{
+	if ( task == nullptr ) return false;
+	if ( fTasks.count(task->ID()) ) {
+		syslog (LOG_WARNING, "task id %ld already exists. discarding the new task", task->ID());
+		delete task;
+		return false;
+	}
+	const RTTask* duplicate { FindDuplicate(*task) };
+	if ( duplicate != nullptr ) {
+		// the tasks are considered identical, so drop the new one
+		syslog (LOG_WARNING, "task id %ld is identical to id %ld. removing the latter", task->ID(), duplicate->ID());
+		delete task;
+		return false;
+	}
+	Entry& entry { fTasks[task->ID()] };
+	entry.task.reset(task);
+	File(entry);
+	return true;
+}
+
+RTTask* TaskStore::Find(long id) const
+{
+	auto it = fTasks.find(id);
+	if ( it == fTasks.end() ) return nullptr;
+	return it->second.task.get();
+}
+
+bool TaskStore::Stop(long id)
+{
+	auto it = fTasks.find(id);
+	if ( it == fTasks.end() ) return false;
+	Entry& entry { it->second };
+	Unfile(entry);
+	entry.task->Stop();
+	File(entry);
+	fChanged.insert(id);
+	return true;
+}
+
+bool TaskStore::Cancel(long id)
+{
+	auto it = fTasks.find(id);
+	if ( it == fTasks.end() ) return false;
+	Entry& entry { it->second };
+	Unfile(entry);
+	entry.task->Cancel();
+	File(entry);
+	fChanged.insert(id);
+	return true;
+}
+
+bool TaskStore::Delete(long id)
+{
+	auto it = fTasks.find(id);
+	if ( it == fTasks.end() ) return false;
+	Entry& entry { it->second };
+	Unfile(entry);
+	if ( entry.task->State() == RTTask::ACTIVE ) {
+		entry.task->Cancel();
+	}
+	fTasks.erase(it);
+	fChanged.erase(id);
+	return true;
+}
+
+void TaskStore::Clear()
+{
+	for ( auto& [ id, entry ] : fTasks ) {
+		if ( entry.task->State() == RTTask::ACTIVE ) {
+			entry.task->Cancel();
+		}
+	}
+	fPending.clear();
+	fDone.clear();
+	fActive.clear();
+	fTasks.clear();
+	fChanged.clear();
+}
+
+bool TaskStore::Reschedule(long id, const Time& time)
+{
+	auto it = fTasks.find(id);
+	if ( it == fTasks.end() ) return false;
+	Entry& entry { it->second };
+	if ( entry.slot != Slot::PENDING ) return false;
+	Unfile(entry);
+	entry.task->SetScheduleTime(time);
+	File(entry);
+	fChanged.insert(id);
+	return true;
+}
+
+size_t TaskStore::Process()
+{
+	// the active tasks go first, so that a terminated task frees the slot for a due task in the same cycle
+	// afterwards the due tasks in order of their schedule time
+	vector<RTTask*> tasks { fActive };
+	const long double now { Time::Now().timestamp() };
+	for ( auto it = fPending.begin(); it != fPending.end() && it->first <= now; ++it ) {
+		tasks.push_back(it->second);
+	}
+	size_t terminated { 0 };
+	for ( RTTask* task : tasks ) {
+		Entry& entry { fTasks.at(task->ID()) };
+		const RTTask::TASKSTATE state { task->State() };
+		const long double scheduleTime { task->scheduleTime().timestamp() };
+		Unfile(entry);
+		task->Process();
+		File(entry);
+		if ( task->State() != state || task->scheduleTime().timestamp() != scheduleTime ) fChanged.insert(task->ID());
+		if ( entry.slot == Slot::DONE ) terminated++;
+	}
+	return terminated;
+}
+
+long double TaskStore::NextDeadline() const
+{
+	long double deadline { HUGE_VALL };
+	for ( RTTask* task : fActive ) {
+		deadline = std::min(deadline, task->NextDeadline());
+	}
+	// the due tasks have individual deadlines, for all others it is their schedule time
+	const long double now { Time::Now().timestamp() };
+	for ( auto it = fPending.begin(); it != fPending.end(); ++it ) {
+		deadline = std::min(deadline, it->second->NextDeadline());
+		if ( it->first > now ) break;
+	}
+	return deadline;
+}
+
+vector<long> TaskStore::TakeChanged()
+{
+	vector<long> ids(fChanged.begin(), fChanged.end());
+	fChanged.clear();
+	return ids;
+}
+
+vector<RTTask*> TaskStore::Tasks() const
+{
+	vector<RTTask*> tasks;
+	tasks.reserve(fTasks.size());
+	for ( const auto& [ id, entry ] : fTasks ) {
+		tasks.push_back(entry.task.get());
+	}
+	std::sort(tasks.begin(), tasks.end(), [](const RTTask* a, const RTTask* b) {
+		if ( a->scheduleTime().timestamp() != b->scheduleTime().timestamp() ) {
+			return a->scheduleTime().timestamp() < b->scheduleTime().timestamp();
+		}
+		return a->ID() < b->ID();
+	});
+	return tasks;
+}
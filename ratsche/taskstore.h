@@ -0,0 +1,89 @@
+#ifndef _TASKSTORE_H
+#define _TASKSTORE_H
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "rttask.h"
+
+/** @class TaskStore
+indexed container of the scheduled tasks.
+The store owns the tasks and files each of them according to its state:
+ - pending tasks (idle or waiting) in an index ordered by schedule time
+ - active tasks in a short separate list
+ - terminated tasks (finished, stopped, cancelled, error) in a second index ordered by schedule time
+Tasks are looked up by ID through a hash index. Process() only touches the active tasks and the pending tasks
+which are due, so the cost of a server cycle does not grow with the number of tasks in the list.
+Identical tasks are rejected on insertion.
+*/
+class TaskStore
+{
+	public:
+		TaskStore() = default;
+		TaskStore(const TaskStore&) = delete;
+		TaskStore& operator=(const TaskStore&) = delete;
+		~TaskStore();
+
+		/*! insert a task and take its ownership
+		 \return false if an identical task is already scheduled, the new task is deleted in this case
+		*/
+		bool Add(RTTask* task);
+		[[nodiscard]] RTTask* Find(long id) const;
+		bool Stop(long id);
+		bool Cancel(long id);
+		bool Delete(long id);
+		void Clear();
+		/*! move a pending task to a new schedule time
+		 \return false if the task does not exist or is not pending
+		*/
+		bool Reschedule(long id, const hgz::Time& time);
+
+		/*! run the state machine of all active and all due pending tasks
+		 \return number of tasks which terminated in this cycle
+		*/
+		std::size_t Process();
+		/*! earliest time at which any of the tasks changes its state by itself
+		 \return time stamp in seconds since 01/01/1970, infinite if there is none
+		*/
+		[[nodiscard]] long double NextDeadline() const;
+		/*! all tasks sorted by schedule time in ascending order
+		*/
+		[[nodiscard]] std::vector<RTTask*> Tasks() const;
+		/*! the active tasks
+		*/
+		[[nodiscard]] const std::vector<RTTask*>& Active() const { return fActive; }
+		/*! the pending task with the earliest schedule time
+		 \return nullptr if there is no pending task
+		*/
+		[[nodiscard]] RTTask* NextPending() const { return fPending.empty() ? nullptr : fPending.begin()->second; }
+		/*! IDs of the tasks whose state or schedule time changed since the last call
+		 (apart from insertion and deletion)
+		*/
+		[[nodiscard]] std::vector<long> TakeChanged();
+		[[nodiscard]] std::size_t size() const { return fTasks.size(); }
+		[[nodiscard]] bool empty() const { return fTasks.empty(); }
+
+	private:
+		typedef std::multimap<long double, RTTask*> TimeIndex;
+		enum class Slot { NONE, PENDING, ACTIVE, DONE };
+		struct Entry {
+			std::unique_ptr<RTTask> task;
+			Slot slot { Slot::NONE };
+			TimeIndex::iterator it;
+		};
+
+		void File(Entry& entry);
+		void Unfile(Entry& entry);
+		[[nodiscard]] RTTask* FindDuplicate(const RTTask& task) const;
+
+		std::unordered_map<long, Entry> fTasks;
+		TimeIndex fPending;
+		TimeIndex fDone;
+		std::vector<RTTask*> fActive;
+		std::unordered_set<long> fChanged;
+};
+
+#endif // _TASKSTORE_H